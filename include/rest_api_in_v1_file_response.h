@@ -0,0 +1,176 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::FileResponse class.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_FILE_RESPONSE_H
+#define REST_API_IN_V1_FILE_RESPONSE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+
+#include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_response.h"
+
+namespace RestApiInV1 {
+    /**
+     * Class you can use to send all or part of a file.  The file is sent directly from the file system so the
+     * contents never pass through the application's memory.  Instances can not be copied as they own the open file.
+     */
+    class FileResponse:public Response {
+        public:
+            /**
+             * The default content type this class will report.
+             */
+            static const QByteArray defaultContentType;
+
+            /**
+             * Constructor
+             *
+             * \param[in] filename    The name of the file to be sent.
+             *
+             * \param[in] contentType The content type to report.
+             */
+            FileResponse(const QString& filename, const QByteArray& contentType = defaultContentType);
+
+            /**
+             * Constructor
+             *
+             * \param[in] filename    The name of the file to be sent.
+             *
+             * \param[in] offset      The offset to the first byte to be sent.
+             *
+             * \param[in] length      The number of bytes to be sent.  The range is clipped to the end of the file.
+             *
+             * \param[in] contentType The content type to report.
+             */
+            FileResponse(
+                const QString&     filename,
+                unsigned long long offset,
+                unsigned long long length,
+                const QByteArray&  contentType = defaultContentType
+            );
+
+            /**
+             * Constructor
+             *
+             * \param[in] fileDescriptor The open file descriptor of the file to be sent.  The descriptor is closed
+             *                           when this instance is destroyed.
+             *
+             * \param[in] offset         The offset to the first byte to be sent.
+             *
+             * \param[in] length         The number of bytes to be sent.  The range is clipped to the end of the
+             *                           file.
+             *
+             * \param[in] contentType    The content type to report.
+             */
+            FileResponse(
+                int                fileDescriptor,
+                unsigned long long offset,
+                unsigned long long length,
+                const QByteArray&  contentType = defaultContentType
+            );
+
+            FileResponse(const FileResponse& other) = delete;
+
+            ~FileResponse() override;
+
+            /**
+             * Method you can use to determine if this is a binary or JSON response.
+             *
+             * \return Returns true if this is a binary response.  Returns false if this is a JSON response.
+             */
+            bool isBinaryResponse() const final;
+
+            /**
+             * Method you can use to determine if this response is sent from a file.
+             *
+             * \return Returns true.
+             */
+            bool isFileResponse() const final;
+
+            /**
+             * Method you can use to obtain a strict binary representation of the data.  The file range is read
+             * into memory, defeating the purpose of this class, so this method should be avoided.
+             *
+             * \return Returns a QByteArray holding the result.  An empty array is returned if the file could not
+             *         be read.
+             */
+            QByteArray asByteArray() const final;
+
+            /**
+             * Method you can use to determine if the file was opened successfully.
+             *
+             * \return Returns true if the file is open.  Returns false if the file could not be opened.
+             */
+            bool isOpen() const;
+
+            /**
+             * Method you can use to obtain the file descriptor of the file to be sent.
+             *
+             * \return Returns the file descriptor.  A value of -1 is returned if the file is not open.
+             */
+            int fileDescriptor() const;
+
+            /**
+             * Method you can use to obtain the offset to the first byte to be sent.
+             *
+             * \return Returns the offset, in bytes.
+             */
+            unsigned long long offset() const;
+
+            /**
+             * Method you can use to obtain the number of bytes to be sent.
+             *
+             * \return Returns the length, in bytes.
+             */
+            unsigned long long length() const;
+
+            FileResponse& operator=(const FileResponse& other) = delete;
+
+        private:
+            /**
+             * Method that clips the requested range to the file.
+             *
+             * \param[in] offset The requested offset.
+             *
+             * \param[in] length The requested length.
+             */
+            void setRange(unsigned long long offset, unsigned long long length);
+
+            /**
+             * The file to be sent.
+             */
+            mutable QFile currentFile;
+
+            /**
+             * The offset to the first byte to be sent.
+             */
+            unsigned long long currentOffset;
+
+            /**
+             * The number of bytes to be sent.
+             */
+            unsigned long long currentLength;
+    };
+};
+
+#endif
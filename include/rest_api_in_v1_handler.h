@@ -481,6 +481,82 @@ namespace RestApiInV1 {
              */
             static const QByteArray connectionCloseString;
 
+            /**
+             * The connection "keep-alive" string encoded as a QByteArray.
+             */
+            static const QByteArray connectionKeepAliveString;
+
+            /**
+             * The "Transfer-Encoding" string encoded as a QByteArray.
+             */
+            static const QByteArray transferEncodingString;
+
+            /**
+             * The transfer encoding "chunked" string encoded as a QByteArray.
+             */
+            static const QByteArray transferEncodingChunkedString;
+
+            /**
+             * The "Expect" string encoded as a QByteArray.
+             */
+            static const QByteArray expectString;
+
+            /**
+             * The expect "100-continue" string encoded as a QByteArray.
+             */
+            static const QByteArray expectContinueString;
+
+            /**
+             * The "range" string encoded as a QByteArray.
+             */
+            static const QByteArray rangeString;
+
+            /**
+             * The "if-range" string encoded as a QByteArray.
+             */
+            static const QByteArray ifRangeString;
+
+            /**
+             * The "accept-ranges" string encoded as a QByteArray.  Complete responses carry "accept-ranges: bytes"
+             * and are trimmed to the ranges the client asked for unless the handler supplies another value.
+             */
+            static const QByteArray acceptRangesString;
+
+            /**
+             * The accept-ranges "bytes" string encoded as a QByteArray.
+             */
+            static const QByteArray acceptRangesBytesString;
+
+            /**
+             * The "content-range" string encoded as a QByteArray.
+             */
+            static const QByteArray contentRangeString;
+
+            /**
+             * The "etag" string encoded as a QByteArray.
+             */
+            static const QByteArray etagString;
+
+            /**
+             * The "last-modified" string encoded as a QByteArray.
+             */
+            static const QByteArray lastModifiedString;
+
+            /**
+             * The "accept-encoding" string encoded as a QByteArray.
+             */
+            static const QByteArray acceptEncodingString;
+
+            /**
+             * The "content-encoding" string encoded as a QByteArray.
+             */
+            static const QByteArray contentEncodingString;
+
+            /**
+             * The "vary" string encoded as a QByteArray.
+             */
+            static const QByteArray varyString;
+
             /**
              * The "server" string encoded as a QByteArray.
              */
@@ -491,6 +567,12 @@ namespace RestApiInV1 {
              */
             static const QByteArray inesonicBotString;
 
+            /**
+             * The "x-inesonic-window" string encoded as a QByteArray.  Clients can use this header to report the
+             * time window used to calculate the hash.
+             */
+            static const QByteArray xInesonicWindowString;
+
             /**
              * The "User-Agent" string encoded as a QByteArray.
              */
@@ -548,6 +630,41 @@ namespace RestApiInV1 {
              * \param[in] session A reference to the session object tied to this session.
              */
             virtual void session(Session& session) = 0;
+
+            /**
+             * Method you can overload to limit the size of request bodies sent to this endpoint.  Requests that
+             * announce a larger body are answered with \ref StatusCode::REQUEST_ENTITY_TOO_LARGE without calling
+             * \ref session.  The limit is also applied by \ref Session::readBody.
+             *
+             * \return Returns the maximum request body size, in bytes.  A value of 0 indicates no limit.  The
+             *         default implementation imposes no limit.
+             */
+            virtual unsigned long long maximumBodySize() const;
+
+            /**
+             * Method you can overload to vet a request using only the request line and headers.  This method is
+             * called before \ref session and before any of the request body is read.  Clients that sent
+             * "Expect: 100-continue" are only told to send the body if this method accepts the request.  Keep the
+             * checks inexpensive, for example the content type or credentials carried in a header.
+             *
+             * \param[in] session A reference to the session object tied to this session.  Only the request
+             *                    accessors should be used.
+             *
+             * \return Returns \ref StatusCode::OK to accept the request.  Any other value is sent to the client as a
+             *         failed response without calling \ref session.  The default implementation accepts all
+             *         requests.
+             */
+            virtual StatusCode checkRequestHead(const Session& session) const;
+
+            /**
+             * Method you can overload to let complete responses from this endpoint be compressed.  Responses are
+             * only compressed if the client's "Accept-Encoding" header allows it and the body is at least as large
+             * as \ref Server::responseCompressionThreshold.  Responses that already carry a "Content-Encoding" or
+             * that the handler marked with "Accept-Ranges: bytes" are sent as is.
+             *
+             * \return Returns true to allow compression.  The default implementation returns false.
+             */
+            virtual bool compressResponses() const;
     };
 
     /**
@@ -70,7 +70,9 @@ namespace RestApiInV1 {
              * \param[in] threadId The ID used to uniquely identify this thread while in flight.
              *
              * \return The response to return.  You can use either \ref BinaryResponse or \ref JsonResponse to encode
-             *         the data in your favorite format.  The response will be deleted automatically.
+             *         the data in your favorite format.  Use \ref StreamingResponse for large bodies so that the
+             *         body is sent as it is generated or \ref FileResponse to send the contents of a file.  The
+             *         response will be deleted automatically.
              */
             virtual Response* processAuthenticatedRequest(
                 const QString&    path,
@@ -99,6 +101,25 @@ namespace RestApiInV1 {
              * \param[in] session A reference to the session object tied to this session.
              */
             void session(Session& session) final;
+
+            /**
+             * Method that checks the request headers before the request body is read.  The body must be labeled
+             * "application/octet-stream" and any "x-inesonic-window" hint must be a valid time window.
+             *
+             * \param[in] session A reference to the session object tied to this session.
+             *
+             * \return Returns \ref StatusCode::OK if the headers are acceptable.  Returns
+             *         \ref StatusCode::PRECONDITION_FAILED if the content type is wrong.  Returns
+             *         \ref StatusCode::BAD_REQUEST if the window hint is malformed.
+             */
+            StatusCode checkRequestHead(const Session& session) const final;
+
+            /**
+             * Method that reports the request body limit for this endpoint.
+             *
+             * \return Returns the value reported by \ref maximumPayloadSize.
+             */
+            unsigned long long maximumBodySize() const final;
     };
 };
 
@@ -29,6 +29,7 @@
 #include <QJsonDocument>
 
 #include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_mac_algorithm.h"
 #include "rest_api_in_v1_customer_data.h"
 #include "rest_api_in_v1_binary_response.h"
 #include "rest_api_in_v1_handler.h"
@@ -44,6 +45,11 @@ namespace RestApiInV1 {
         friend class Server;
 
         public:
+            /**
+             * Value holding the default maximum payload size.
+             */
+            static constexpr unsigned long defaultMaximumPayloadSize = 1048576;
+
             /**
              * Constructor
              *
@@ -55,6 +61,15 @@ namespace RestApiInV1 {
             ~InesonicCustomerBinaryRestHandler() override;
 
         protected:
+            /**
+             * Method you can overload to select the message authentication code clients must use with this
+             * endpoint.  Every algorithm uses the same secret, time index, and message format.
+             *
+             * \return Returns the message authentication code.  The default implementation returns
+             *         \ref MacAlgorithm::HMAC_SHA256 so existing clients keep working.
+             */
+            virtual MacAlgorithm macAlgorithm() const;
+
             /**
              * Method you can overload to receive a request and send a return response.  This method will only be
              * triggered if the message meets the authentication requirements.
@@ -76,6 +91,14 @@ namespace RestApiInV1 {
                 unsigned             threadId
             ) = 0;
 
+            /**
+             * Method you can overload to set the maximum allowed payload size.
+             *
+             * \return Returns the maximum allowed payload size.  The default implementation will impose the default
+             *         maximum payload size.
+             */
+            unsigned long long maximumBodySize() const override;
+
         private:
             /**
              * Method you can overload to handle a session for this endpoint.  Note that this method will be called
@@ -90,6 +113,17 @@ namespace RestApiInV1 {
              */
             void session(Session& session) final;
 
+            /**
+             * Method that checks the "Content-Type" header before the request body is read.  The JSON envelope must
+             * be labeled "application/json".
+             *
+             * \param[in] session A reference to the session object tied to this session.
+             *
+             * \return Returns \ref StatusCode::OK if the content type is acceptable.  Returns
+             *         \ref StatusCode::PRECONDITION_FAILED otherwise.
+             */
+            StatusCode checkRequestHead(const Session& session) const final;
+
             /**
              * The private implementation.
              */
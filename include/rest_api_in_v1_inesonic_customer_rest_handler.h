@@ -29,6 +29,7 @@
 #include <QJsonDocument>
 
 #include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_mac_algorithm.h"
 #include "rest_api_in_v1_customer_data.h"
 #include "rest_api_in_v1_json_response.h"
 #include "rest_api_in_v1_rest_handler.h"
@@ -54,6 +55,15 @@ namespace RestApiInV1 {
             ~InesonicCustomerRestHandler() override;
 
         protected:
+            /**
+             * Method you can overload to select the message authentication code clients must use with this
+             * endpoint.  Every algorithm uses the same secret, time index, and message format.
+             *
+             * \return Returns the message authentication code.  The default implementation returns
+             *         \ref MacAlgorithm::HMAC_SHA256 so existing clients keep working.
+             */
+            virtual MacAlgorithm macAlgorithm() const;
+
             /**
              * Method you can overload to receive a request and send a return response.  This method will only be
              * triggered if the message meets the authentication requirements.
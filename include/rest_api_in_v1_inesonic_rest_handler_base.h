@@ -29,6 +29,7 @@
 #include <QJsonDocument>
 
 #include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_mac_algorithm.h"
 
 namespace RestApiInV1 {
     class REST_API_V1_PUBLIC_API InesonicRestHandler;
@@ -57,7 +58,7 @@ namespace RestApiInV1 {
              */
             InesonicRestHandlerBase(const QByteArray& secret = QByteArray());
 
-            ~InesonicRestHandlerBase();
+            virtual ~InesonicRestHandlerBase();
 
             /**
              * Method you can use to set the Inesonic authentication secret.
@@ -67,6 +68,16 @@ namespace RestApiInV1 {
              */
             void setSecret(const QByteArray& newSecret);
 
+        protected:
+            /**
+             * Method you can overload to select the message authentication code clients must use with this
+             * endpoint.  Every algorithm uses the same secret, time index, and message format.
+             *
+             * \return Returns the message authentication code.  The default implementation returns
+             *         \ref MacAlgorithm::HMAC_SHA256 so existing clients keep working.
+             */
+            virtual MacAlgorithm macAlgorithm() const;
+
         private:
             /**
              * The private implementation.
@@ -0,0 +1,48 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file defines the \ref RestApiInV1::MacAlgorithm enumeration.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_MAC_ALGORITHM_H
+#define REST_API_IN_V1_MAC_ALGORITHM_H
+
+#include "rest_api_in_v1_common.h"
+
+namespace RestApiInV1 {
+    /**
+     * Enumeration of the message authentication codes used to authenticate Inesonic requests.  Every algorithm is
+     * keyed with the 56-byte secret followed by the 8-byte little-endian time index and produces a 32-byte hash so
+     * the message formats do not change.
+     */
+    enum class MacAlgorithm {
+        /**
+         * HMAC using SHA-256.  This is the algorithm existing clients use.
+         */
+        HMAC_SHA256,
+
+        /**
+         * BLAKE2b in keyed mode with a 32-byte digest, as described in RFC 7693.  Faster than HMAC-SHA256 on
+         * 64-bit processors without SHA extensions.
+         */
+        BLAKE2B_256
+    };
+};
+
+#endif
@@ -86,6 +86,22 @@ namespace RestApiInV1 {
                 return !isBinaryResponse();
             }
 
+            /**
+             * Method you can use to determine if the body of this response is generated while it is sent.  Streaming
+             * responses are sent using \ref Session::sendStreamedResponse rather than \ref asByteArray.
+             *
+             * \return Returns true if this is a \ref StreamingResponse.  Returns false otherwise.
+             */
+            virtual bool isStreamingResponse() const;
+
+            /**
+             * Method you can use to determine if this response is sent from a file.  File responses are sent using
+             * \ref Session::sendFileResponse rather than \ref asByteArray.
+             *
+             * \return Returns true if this is a \ref FileResponse.  Returns false otherwise.
+             */
+            virtual bool isFileResponse() const;
+
             /**
              * Method you can use to obtain a strict binary representation of the data.
              *
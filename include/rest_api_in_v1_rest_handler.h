@@ -38,6 +38,11 @@ namespace RestApiInV1 {
      */
     class REST_API_V1_PUBLIC_API RestHandler:public Handler {
         public:
+            /**
+             * Value holding the default maximum payload size.
+             */
+            static constexpr unsigned long defaultMaximumPayloadSize = 1048576;
+
             /**
              * Constructor
              */
@@ -63,6 +68,14 @@ namespace RestApiInV1 {
                 unsigned             threadId
             ) = 0;
 
+            /**
+             * Method you can overload to set the maximum allowed payload size.
+             *
+             * \return Returns the maximum allowed payload size.  The default implementation will impose the default
+             *         maximum payload size.
+             */
+            unsigned long long maximumBodySize() const override;
+
         private:
             /**
              * Method you can overload to handle a session for this endpoint.  Note that this method will be called
@@ -76,6 +89,17 @@ namespace RestApiInV1 {
              * \param[in] session A reference to the session object tied to this session.
              */
             void session(Session& session) final;
+
+            /**
+             * Method that checks the "Content-Type" header before the request body is read.  JSON requests may be
+             * labeled either "application/json" or "text/plain".
+             *
+             * \param[in] session A reference to the session object tied to this session.
+             *
+             * \return Returns \ref StatusCode::OK if the content type is acceptable.  Returns
+             *         \ref StatusCode::PRECONDITION_FAILED otherwise.
+             */
+            StatusCode checkRequestHead(const Session& session) const final;
     };
 };
 
@@ -41,6 +41,10 @@
 namespace RestApiInV1 {
     class REST_API_V1_PUBLIC_API TcpServer;
     class REST_API_V1_PUBLIC_API Connection;
+    class REST_API_V1_PUBLIC_API ConnectionPool;
+    class REST_API_V1_PUBLIC_API EventThread;
+    class REST_API_V1_PUBLIC_API EventEngine;
+    class REST_API_V1_PUBLIC_API ListenerThread;
 
     /**
      * Class that implements a simple inbound REST API.
@@ -50,6 +54,10 @@ namespace RestApiInV1 {
 
         friend class TcpServer;
         friend class Connection;
+        friend class ConnectionPool;
+        friend class EventThread;
+        friend class EventEngine;
+        friend class ListenerThread;
 
         public:
             /**
@@ -63,10 +71,70 @@ namespace RestApiInV1 {
             static const unsigned short defaultPort;
 
             /**
-             * The default maximum number of simultaneous connections.
+             * The default maximum number of simultaneous connections.  Maps to the number of hardware threads
+             * reported by the system, with a floor of 4.  Each connection is serviced by a persistent worker thread
+             * so this value also sets the size of the worker pool.
              */
             static const unsigned defaultMaximumSimultaneousConnections;
 
+            /**
+             * The default number of I/O threads.  A value of 0 indicates that sockets are handed directly to worker
+             * threads.
+             */
+            static const unsigned defaultNumberIoThreads;
+
+            /**
+             * The default number of listener threads.  A value of 0 indicates that connections are accepted by a
+             * single listener on the Qt event loop.
+             */
+            static const unsigned defaultNumberListenerThreads;
+
+            /**
+             * The default time an idle persistent connection is held open waiting for the next request, in
+             * milliseconds.
+             */
+            static const unsigned defaultKeepAliveTimeout;
+
+            /**
+             * The default maximum number of requests serviced on a single persistent connection.
+             */
+            static const unsigned defaultMaximumRequestsPerConnection;
+
+            /**
+             * The default time a client is given to send a complete request head, in milliseconds.
+             */
+            static const unsigned defaultRequestHeadTimeout;
+
+            /**
+             * The default time a client is given to send a request body, in milliseconds.
+             */
+            static const unsigned defaultRequestBodyTimeout;
+
+            /**
+             * The default time allowed to receive a request and deliver its response, in milliseconds.
+             */
+            static const unsigned defaultRequestTimeout;
+
+            /**
+             * The default maximum amount of response data buffered for a single connection, in bytes.
+             */
+            static const unsigned defaultMaximumOutboundBufferSize;
+
+            /**
+             * The default smallest response body we compress, in bytes.
+             */
+            static const unsigned defaultResponseCompressionThreshold;
+
+            /**
+             * The default number of compressed response bodies kept for reuse.
+             */
+            static const unsigned defaultCompressionCacheSize;
+
+            /**
+             * The default largest decoded request body we accept, in bytes.
+             */
+            static const unsigned defaultMaximumDecodedBodySize;
+
             /**
              * Type for functions used to log events.  Note that the function must be fully reentrant and thread safe.
              *
@@ -122,6 +190,216 @@ namespace RestApiInV1 {
              */
             unsigned maximumSimultaneousConnections() const;
 
+            /**
+             * Method you can use to set the number of I/O threads.  I/O threads use epoll to watch many sockets at
+             * once and only hand a socket to a worker thread once a complete request head has arrived.  This allows
+             * the server to hold far more idle or slow connections than there are worker threads.
+             *
+             * The I/O threads are only supported on Linux.  This setting is ignored on other platforms.
+             *
+             * \param[in] newNumberIoThreads The new number of I/O threads.  A value of 0 disables the I/O threads so
+             *                               that each socket is handed directly to a worker thread.
+             */
+            void setNumberIoThreads(unsigned newNumberIoThreads);
+
+            /**
+             * Method you can use to determine the current number of I/O threads.
+             *
+             * \return Returns the current number of I/O threads.
+             */
+            unsigned numberIoThreads() const;
+
+            /**
+             * Method you can use to set the number of listener threads.  When non-zero, \ref reconfigure opens one
+             * listening socket per listener thread on the same port using SO_REUSEPORT.  Each listener thread runs
+             * its own accept loop and owns an equal share of the worker and I/O threads, so the kernel spreads new
+             * connections across the shards rather than funnelling them through the Qt event loop.
+             *
+             * The new value takes effect on the next call to \ref reconfigure.  No more listener threads are started
+             * than \ref maximumSimultaneousConnections allows so that every shard owns at least one worker.  Listener
+             * threads are only supported on Linux.  This setting is ignored on other platforms.
+             *
+             * \param[in] newNumberListenerThreads The new number of listener threads.  A value of 0 disables the
+             *                                     listener threads.
+             */
+            void setNumberListenerThreads(unsigned newNumberListenerThreads);
+
+            /**
+             * Method you can use to determine the number of listener threads.
+             *
+             * \return Returns the number of listener threads.
+             */
+            unsigned numberListenerThreads() const;
+
+            /**
+             * Method you can use to ask each listener thread to favor connections arriving on its own CPU.  When
+             * enabled, each listening socket is tagged using SO_INCOMING_CPU and each accept loop is pinned to the
+             * matching CPU.  The new value takes effect on the next call to \ref reconfigure.
+             *
+             * \param[in] nowEnabled If true, CPU affinity will be used.  If false, CPU affinity will not be used.
+             */
+            void setIncomingCpuAffinityEnabled(bool nowEnabled = true);
+
+            /**
+             * Method you can use to determine if listener threads favor connections arriving on their own CPU.
+             *
+             * \return Returns true if CPU affinity is enabled.  Returns false if CPU affinity is disabled.
+             */
+            bool incomingCpuAffinityEnabled() const;
+
+            /**
+             * Method you can use to set how long an idle persistent connection is held open waiting for the next
+             * request.  HTTP/1.1 connections are kept open unless the client sends "Connection: close".  HTTP/1.0
+             * connections are only kept open if the client sends "Connection: keep-alive".
+             *
+             * \param[in] newKeepAliveTimeout The new keep-alive timeout, in milliseconds.  A value of 0 disables
+             *                                persistent connections so every connection is closed after a single
+             *                                request.
+             */
+            void setKeepAliveTimeout(unsigned newKeepAliveTimeout);
+
+            /**
+             * Method you can use to determine how long an idle persistent connection is held open.
+             *
+             * \return Returns the keep-alive timeout, in milliseconds.
+             */
+            unsigned keepAliveTimeout() const;
+
+            /**
+             * Method you can use to set the maximum number of requests serviced on a single persistent connection.
+             * The connection is closed after the response to the last allowed request.
+             *
+             * \param[in] newMaximumRequestsPerConnection The new maximum number of requests.  A value of 0 indicates
+             *                                            no limit.
+             */
+            void setMaximumRequestsPerConnection(unsigned newMaximumRequestsPerConnection);
+
+            /**
+             * Method you can use to determine the maximum number of requests serviced on a single persistent
+             * connection.
+             *
+             * \return Returns the maximum number of requests.  A value of 0 indicates no limit.
+             */
+            unsigned maximumRequestsPerConnection() const;
+
+            /**
+             * Method you can use to set how long a client is given to send a complete request head.  Clients that
+             * have sent part of a head when the time runs out receive a request timeout response.  Clients that have
+             * sent nothing are disconnected.
+             *
+             * \param[in] newRequestHeadTimeout The new request head timeout, in milliseconds.  A value of 0 indicates
+             *                                  no limit.
+             */
+            void setRequestHeadTimeout(unsigned newRequestHeadTimeout);
+
+            /**
+             * Method you can use to determine how long a client is given to send a complete request head.
+             *
+             * \return Returns the request head timeout, in milliseconds.  A value of 0 indicates no limit.
+             */
+            unsigned requestHeadTimeout() const;
+
+            /**
+             * Method you can use to set how long a client is given to send a request body, measured from the end of
+             * the request head.  If no response has been sent when the time runs out, the client receives a request
+             * timeout response.  The connection is then closed.
+             *
+             * \param[in] newRequestBodyTimeout The new request body timeout, in milliseconds.  A value of 0 indicates
+             *                                  no limit.
+             */
+            void setRequestBodyTimeout(unsigned newRequestBodyTimeout);
+
+            /**
+             * Method you can use to determine how long a client is given to send a request body.
+             *
+             * \return Returns the request body timeout, in milliseconds.  A value of 0 indicates no limit.
+             */
+            unsigned requestBodyTimeout() const;
+
+            /**
+             * Method you can use to set the total time allowed to receive a request and deliver its response.  The
+             * limit bounds every wait on the client, including waits for the client to accept response data.  If no
+             * response has been sent when the time runs out, the client receives a request timeout response.
+             * Otherwise the connection is dropped.  Time spent inside a handler that is not waiting on the client is
+             * counted but can not be interrupted.
+             *
+             * \param[in] newRequestTimeout The new request timeout, in milliseconds.  A value of 0 indicates no
+             *                              limit.
+             */
+            void setRequestTimeout(unsigned newRequestTimeout);
+
+            /**
+             * Method you can use to determine the total time allowed to receive a request and deliver its response.
+             *
+             * \return Returns the request timeout, in milliseconds.  A value of 0 indicates no limit.
+             */
+            unsigned requestTimeout() const;
+
+            /**
+             * Method you can use to set the most response data buffered for a single connection.  Once a slow
+             * client lets this much data accumulate, the handler sending the response blocks until the client
+             * catches up.  Waits are bounded by the request timeout.
+             *
+             * \param[in] newMaximumOutboundBufferSize The new limit, in bytes.  A value of 0 indicates no limit.
+             */
+            void setMaximumOutboundBufferSize(unsigned newMaximumOutboundBufferSize);
+
+            /**
+             * Method you can use to determine the most response data buffered for a single connection.
+             *
+             * \return Returns the limit, in bytes.  A value of 0 indicates no limit.
+             */
+            unsigned maximumOutboundBufferSize() const;
+
+            /**
+             * Method you can use to set the smallest response body we compress.  Only handlers that opt in through
+             * \ref Handler::compressResponses have their responses compressed.  Smaller bodies gain little and are
+             * sent as is.
+             *
+             * \param[in] newResponseCompressionThreshold The new threshold, in bytes.
+             */
+            void setResponseCompressionThreshold(unsigned newResponseCompressionThreshold);
+
+            /**
+             * Method you can use to determine the smallest response body we compress.
+             *
+             * \return Returns the threshold, in bytes.
+             */
+            unsigned responseCompressionThreshold() const;
+
+            /**
+             * Method you can use to set the number of compressed response bodies kept for reuse.  A response whose
+             * body matches a cached body is sent without being compressed again.
+             *
+             * \param[in] newCompressionCacheSize The new number of cached bodies.  A value of 0 disables the cache.
+             */
+            void setCompressionCacheSize(unsigned newCompressionCacheSize);
+
+            /**
+             * Method you can use to determine the number of compressed response bodies kept for reuse.
+             *
+             * \return Returns the number of cached bodies.
+             */
+            unsigned compressionCacheSize() const;
+
+            /**
+             * Method you can use to set the largest request body we accept once a "Content-Encoding" is removed.
+             * The limit applies in addition to any limit imposed by the handler and protects against small bodies
+             * that decode to very large ones.
+             *
+             * \param[in] newMaximumDecodedBodySize The new limit, in bytes.  A value of 0 leaves only the handler's
+             *                                      limit.
+             */
+            void setMaximumDecodedBodySize(unsigned newMaximumDecodedBodySize);
+
+            /**
+             * Method you can use to determine the largest request body we accept once a "Content-Encoding" is
+             * removed.
+             *
+             * \return Returns the limit, in bytes.  A value of 0 indicates only the handler's limit applies.
+             */
+            unsigned maximumDecodedBodySize() const;
+
             /**
              * Method you can use to reconfigure this server instance.
              *
@@ -141,6 +419,14 @@ namespace RestApiInV1 {
              * Method you can use to register an handler with this server.  If a handler for the path already exists,
              * it will be replaced.
              *
+             * The path may contain parameter segments, written as "{name}", that match any single segment.  The last
+             * segment may be a "*" wildcard that matches the remainder of the path.  Literal segments take precedence
+             * over parameters and parameters over wildcards.  Captured values are available through
+             * \ref Session::pathParameter.  Malformed paths are reported through the \ref sessionError signal.
+             *
+             * Handlers may be registered while the server is running.  A replaced handler may still be servicing
+             * requests when this method returns.  Call \ref synchronizeHandlers before destroying it.
+             *
              * \param[in] handler A pointer the REST API handler.  Not that this class will *not* take ownership.
              *
              * \param[in] method  The method required to trigger this handler.
@@ -149,6 +435,25 @@ namespace RestApiInV1 {
              */
             void registerHandler(Handler* handler, Handler::Method method, const QString& path);
 
+            /**
+             * Method you can use to remove a handler from this server.  Handlers may be removed while the server is
+             * running.  Requests already routed to the handler may still be running when this method returns.  Call
+             * \ref synchronizeHandlers before destroying the handler.
+             *
+             * \param[in] method The method that triggers the handler.
+             *
+             * \param[in] path   The path the handler was registered under.
+             */
+            void unregisterHandler(Handler::Method method, const QString& path);
+
+            /**
+             * Method you can use to wait until every request routed to a handler that was removed or replaced before
+             * this call has finished.  Once this method returns, those handlers can be safely destroyed.
+             *
+             * This method blocks while requests are being serviced.  Calling it from within a handler will deadlock.
+             */
+            void synchronizeHandlers();
+
             /**
              * Method that gets the handler for a given path.
              *
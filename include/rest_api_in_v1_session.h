@@ -43,6 +43,76 @@ namespace RestApiInV1 {
      */
     class REST_API_V1_PUBLIC_API Session {
         public:
+            /**
+             * Pure virtual class you can overload to receive the request body in pieces as it arrives.  See
+             * \ref Session::readBody.
+             */
+            class BodyReceiver {
+                public:
+                    virtual ~BodyReceiver() = default;
+
+                    /**
+                     * Method that is called with each piece of the request body, in order.  The data is only valid
+                     * for the duration of the call.
+                     *
+                     * \param[in] data   Pointer to the received data.
+                     *
+                     * \param[in] length The number of bytes received.
+                     *
+                     * \return Returns true to continue receiving the body.  Returns false to stop.
+                     */
+                    virtual bool receiveBodyData(const char* data, unsigned long length) = 0;
+            };
+
+            /**
+             * Pure virtual class used to write a response body in pieces.  See \ref Session::sendStreamedResponse.
+             */
+            class BodyWriter {
+                public:
+                    virtual ~BodyWriter() = default;
+
+                    /**
+                     * Method you can use to write the next piece of the response body.  This method may block until
+                     * the client has taken earlier data.
+                     *
+                     * \param[in] data   Pointer to the data to be written.
+                     *
+                     * \param[in] length The number of bytes to be written.
+                     *
+                     * \return Returns true on success.  Returns false on error.
+                     */
+                    virtual bool writeBodyData(const char* data, unsigned long length) = 0;
+
+                    /**
+                     * Method you can use to write the next piece of the response body.
+                     *
+                     * \param[in] data The data to be written.
+                     *
+                     * \return Returns true on success.  Returns false on error.
+                     */
+                    inline bool writeBodyData(const QByteArray& data) {
+                        return writeBodyData(data.constData(), static_cast<unsigned long>(data.size()));
+                    }
+            };
+
+            /**
+             * Pure virtual class you can overload to generate a response body while it is being sent.  See
+             * \ref Session::sendStreamedResponse.
+             */
+            class BodyGenerator {
+                public:
+                    virtual ~BodyGenerator() = default;
+
+                    /**
+                     * Method that is called to generate the response body.
+                     *
+                     * \param[in] writer The writer used to send the body.
+                     *
+                     * \return Returns true if the entire body was generated.  Returns false if generation failed.
+                     */
+                    virtual bool generateBody(BodyWriter& writer) = 0;
+            };
+
             virtual ~Session() = default;
 
             /**
@@ -54,17 +124,67 @@ namespace RestApiInV1 {
 
             /**
              * Method you can use to get the next bolus of available data.  This method will block until there is at
-             * least some data available.
+             * least some data available.  Reads never extend past the end of the request body.
              *
              * \param[in,out] buffer      The buffer to hold the current receive data.
              *
              * \param[in]     maximumSize The maximum number of bytes of data to obtain.  A value of 0 indicates that
              *                            the current default maximum value should be used.
              *
-             * \return Returns true on success or false on error.
+             * \return Returns true on success or false on error or if the request body has been fully read.
              */
             virtual bool readData(QByteArray& buffer, unsigned long maximumSize = 0) = 0;
 
+            /**
+             * Method you can use to read request body data directly into memory you supply.  This method will block
+             * until there is at least some data available.  Reads never extend past the end of the request body.
+             *
+             * \param[in]  buffer     The memory to receive the data.
+             *
+             * \param[in]  bufferSize The number of bytes the buffer can hold.
+             *
+             * \param[out] bytesRead  Receives the number of bytes placed in the buffer.
+             *
+             * \return Returns true on success or false on error or if the request body has been fully read.
+             */
+            virtual bool readData(char* buffer, unsigned long long bufferSize, unsigned long long& bytesRead) = 0;
+
+            /**
+             * Method you can use to read the entire request body.  When the client supplies a "Content-Length"
+             * header, the buffer is sized once up front and filled in place.  Bodies larger than the limit are
+             * answered with \ref Handler::StatusCode::REQUEST_ENTITY_TOO_LARGE.
+             *
+             * Bodies sent with a "Content-Encoding" of gzip or deflate are decoded as they arrive.  The limit applies
+             * to both the encoded and the decoded body.  Note that \ref readData and \ref readLine return the body
+             * as sent.
+             *
+             * \param[out] body        The buffer to receive the request body.
+             *
+             * \param[in]  maximumSize The largest body to accept, in bytes.  A value of 0 indicates that the limit
+             *                         reported by the handler should be used.
+             *
+             * \return Returns true on success.  Returns false on error.  The session answers the client on error so
+             *         no further response should be sent.
+             */
+            virtual bool readBody(QByteArray& body, unsigned long long maximumSize = 0) = 0;
+
+            /**
+             * Method you can use to process the request body as it arrives rather than holding all of it in memory.
+             * Each piece of the body is handed to the receiver as soon as it is read from the client.  Bodies larger
+             * than the limit are answered with \ref Handler::StatusCode::REQUEST_ENTITY_TOO_LARGE.  Encoded bodies
+             * are decoded before they reach the receiver, as described for \ref readBody.
+             *
+             * \param[in] receiver    The receiver to be handed the request body.
+             *
+             * \param[in] maximumSize The largest body to accept, in bytes.  A value of 0 indicates that the limit
+             *                        reported by the handler should be used.
+             *
+             * \return Returns true once the entire body has been handed to the receiver.  Returns false on error or
+             *         if the receiver stopped early.  The session answers the client on error, but not if the
+             *         receiver stopped early.
+             */
+            virtual bool readBody(BodyReceiver& receiver, unsigned long long maximumSize = 0) = 0;
+
             /**
              * Method you can use to get a single line of data.  This method will block until a full line is read.
              *
@@ -80,6 +200,8 @@ namespace RestApiInV1 {
 
             /**
              * Method you can use to send response status.  Always call this method before sending any response data.
+             * The "Connection" header is managed by the session.  Include a "Content-Length" header so that the
+             * connection can be reused for later requests.
              *
              * \param[in] statusCode      The response status code.
              *
@@ -102,14 +224,96 @@ namespace RestApiInV1 {
             virtual bool sendFailedResponse(Handler::StatusCode statusCode) = 0;
 
             /**
-             * Method you can use to send response data.
+             * Method you can use to send a complete response.  The "Content-Length" header is set from the body so
+             * the connection can be reused.  Small bodies are sent in the same write as the status line and headers.
              *
-             * \param[in] data The raw data to be sent.
+             * Successful responses to GET and HEAD requests advertise "Accept-Ranges: bytes" and a successful
+             * response to a GET request is trimmed to the byte ranges named in the request's "Range" header.  A
+             * single range is sent as is with status 206.  Multiple ranges are sent as a "multipart/byteranges"
+             * body.  Requests whose ranges can not be satisfied receive status 416.  Supply your own
+             * "Accept-Ranges" header, such as "Accept-Ranges: none", to turn this off.  Compressed responses never
+             * advertise or honor ranges.
+             *
+             * \param[in] statusCode      The response status code.
+             *
+             * \param[in] responseHeaders The response headers.
+             *
+             * \param[in] body            The response body.
              *
              * \return Returns true on success.  Returns false on error.
              */
+            virtual bool sendResponse(
+                Handler::StatusCode     statusCode,
+                const Handler::Headers& responseHeaders,
+                const QByteArray&       body
+            ) = 0;
+
+            /**
+             * Method you can use to send response data.  If the client is slow to accept data, this method blocks
+             * once the connection's outbound buffer reaches the server's limit.
+             *
+             * \param[in] data The raw data to be sent.
+             *
+             * \return Returns true on success.  Returns false on error or timeout.
+             */
             virtual bool sendData(const QByteArray& data) = 0;
 
+            /**
+             * Method you can use to determine how much response data is buffered waiting for the client.
+             *
+             * \return Returns the number of buffered bytes.
+             */
+            virtual unsigned long long bufferedOutboundBytes() const = 0;
+
+            /**
+             * Method you can use to send a response whose length is not known when the response starts.  The status
+             * line and headers go out immediately and the body is sent as the generator produces it, using
+             * "Transfer-Encoding: chunked" so the connection can be reused.  Clients that do not support chunked
+             * encoding receive the body as is and the connection is closed once it is sent.
+             *
+             * \param[in] statusCode      The response status code.
+             *
+             * \param[in] responseHeaders The response headers.  Any "Content-Length" or "Transfer-Encoding"
+             *                            header is replaced.
+             *
+             * \param[in] generator       The generator that produces the response body.
+             *
+             * \return Returns true on success.  Returns false on error or if the generator failed.  As the status
+             *         has already been sent, a failed generator leaves the client with a truncated response and the
+             *         connection is closed.
+             */
+            virtual bool sendStreamedResponse(
+                Handler::StatusCode     statusCode,
+                const Handler::Headers& responseHeaders,
+                BodyGenerator&          generator
+            ) = 0;
+
+            /**
+             * Method you can use to send a response whose body is a range of an open file.  Where the platform
+             * allows, the file is handed to the kernel so the contents are never copied into the application.  Byte
+             * range requests are honored as described for \ref sendResponse.
+             *
+             * \param[in] statusCode      The response status code.
+             *
+             * \param[in] responseHeaders The response headers.  The "Content-Length" header is set from the range.
+             *
+             * \param[in] fileDescriptor  The descriptor of the file to be sent.  The descriptor is not closed.
+             *
+             * \param[in] offset          The offset to the first byte to be sent.
+             *
+             * \param[in] length          The number of bytes to be sent.
+             *
+             * \return Returns true on success.  Returns false on error.  If the file can not be read in full, the
+             *         connection is closed so the client can tell the body is incomplete.
+             */
+            virtual bool sendFileResponse(
+                Handler::StatusCode     statusCode,
+                const Handler::Headers& responseHeaders,
+                int                     fileDescriptor,
+                unsigned long long      offset,
+                unsigned long long      length
+            ) = 0;
+
             /**
              * Method you can use to obtain the current request URI.
              *
@@ -117,6 +321,25 @@ namespace RestApiInV1 {
              */
             virtual const QUrl& requestUri() const = 0;
 
+            /**
+             * Method you can use to obtain the path portion of the request URI.  This is less expensive than
+             * calling \ref requestUri when only the path is needed.
+             *
+             * \return Returns the decoded request path.
+             */
+            virtual const QString& path() const = 0;
+
+            /**
+             * Method you can use to obtain a value captured from the request path by the pattern the handler was
+             * registered under.  Given the pattern "/users/{id}/files", the request path "/users/42/files" yields
+             * "42" for "id".  A trailing wildcard segment reports the unmatched remainder of the path under "*".
+             *
+             * \param[in] name The parameter name, without braces.  Use "*" for the trailing wildcard.
+             *
+             * \return Returns the parameter value.  An empty string is returned if the parameter is not present.
+             */
+            virtual QString pathParameter(const QString& name) const = 0;
+
             /**
              * Method you can use to obtain the current access method.
              *
@@ -132,11 +355,23 @@ namespace RestApiInV1 {
             virtual const QString& httpVersion() const = 0;
 
             /**
-             * Method you can use to obtain the current HTTP headers.
+             * Method you can use to obtain the current HTTP headers.  Trailers sent after a chunked request body are
+             * included once the body has been read.
              *
              * \return Returns the current HTTP headers.
              */
             virtual const Handler::Headers& headers() const = 0;
+
+            /**
+             * Method you can use to obtain a single request header.  This is less expensive than calling
+             * \ref headers when only a few headers are needed.  Trailers sent after a chunked request body are
+             * included once the body has been read.
+             *
+             * \param[in] name The lower case header name.
+             *
+             * \return Returns the header value.  An empty value is returned if the header is not present.
+             */
+            virtual QByteArray header(const QByteArray& name) const = 0;
     };
 };
 
@@ -0,0 +1,94 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::StreamingResponse class.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_STREAMING_RESPONSE_H
+#define REST_API_IN_V1_STREAMING_RESPONSE_H
+
+#include <QString>
+#include <QByteArray>
+
+#include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_session.h"
+#include "rest_api_in_v1_response.h"
+
+namespace RestApiInV1 {
+    /**
+     * Pure virtual class you can overload to send a response that is generated while it is being sent.  The status
+     * line and headers go out before any of the body is generated so the body never needs to be held in memory.
+     * Overload \ref generateBody to produce the body.
+     */
+    class StreamingResponse:public Response, public Session::BodyGenerator {
+        public:
+            /**
+             * The default content type this class will report.
+             */
+            static const QByteArray defaultContentType;
+
+            /**
+             * Constructor
+             *
+             * \param[in] statusCode  The status code to be sent.
+             *
+             * \param[in] contentType The content type to report.
+             */
+            StreamingResponse(
+                StatusCode        statusCode = StatusCode::OK,
+                const QByteArray& contentType = defaultContentType
+            );
+
+            ~StreamingResponse() override;
+
+            /**
+             * Method you can use to determine if this is a binary or JSON response.
+             *
+             * \return Returns true if this is a binary response.  Returns false if this is a JSON response.
+             */
+            bool isBinaryResponse() const final;
+
+            /**
+             * Method you can use to determine if the body of this response is generated while it is sent.
+             *
+             * \return Returns true.
+             */
+            bool isStreamingResponse() const final;
+
+            /**
+             * Method you can use to obtain a strict binary representation of the data.  The body is generated into
+             * memory, defeating the purpose of this class, so this method should be avoided.
+             *
+             * \return Returns a QByteArray holding the result.  An empty array is returned if generation failed.
+             */
+            QByteArray asByteArray() const final;
+
+            /**
+             * Method you can overload to generate the response body.  This method is called once, after the status
+             * line and headers have been sent.
+             *
+             * \param[in] writer The writer used to send the body.
+             *
+             * \return Returns true if the entire body was generated.  Returns false if generation failed.
+             */
+            bool generateBody(Session::BodyWriter& writer) override = 0;
+    };
+};
+
+#endif
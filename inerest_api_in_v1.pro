@@ -38,10 +38,13 @@ API_HEADERS = include/rest_api_in_v1_common.h \
               include/rest_api_in_v1_handler.h \
               include/rest_api_in_v1_rest_handler.h \
               include/rest_api_in_v1_inesonic_rest_handler_base.h \
+              include/rest_api_in_v1_mac_algorithm.h \
               include/rest_api_in_v1_time_delta_handler.h \
               include/rest_api_in_v1_response.h \
               include/rest_api_in_v1_json_response.h \
               include/rest_api_in_v1_binary_response.h \
+              include/rest_api_in_v1_streaming_response.h \
+              include/rest_api_in_v1_file_response.h \
               include/rest_api_in_v1_customer_data.h \
               include/rest_api_in_v1_inesonic_rest_handler.h \
               include/rest_api_in_v1_inesonic_binary_rest_handler.h \
@@ -54,8 +57,23 @@ API_HEADERS = include/rest_api_in_v1_common.h \
 
 SOURCES = source/rest_api_in_v1_server.cpp \
           source/rest_api_in_v1_connection.cpp \
+          source/rest_api_in_v1_connection_pool.cpp \
+          source/rest_api_in_v1_buffer_pool.cpp \
+          source/rest_api_in_v1_request_parser.cpp \
+          source/rest_api_in_v1_router.cpp \
+          source/rest_api_in_v1_route_table.cpp \
+          source/rest_api_in_v1_event_thread.cpp \
+          source/rest_api_in_v1_timer_wheel.cpp \
+          source/rest_api_in_v1_event_engine.cpp \
+          source/rest_api_in_v1_listener_thread.cpp \
           source/rest_api_in_v1_server_private.cpp \
           source/rest_api_in_v1_authentication_helpers.cpp \
+          source/rest_api_in_v1_content_coding.cpp \
+          source/rest_api_in_v1_sha256.cpp \
+          source/rest_api_in_v1_sha256_lanes.cpp \
+          source/rest_api_in_v1_blake2b.cpp \
+          source/rest_api_in_v1_base64.cpp \
+          source/rest_api_in_v1_compression_cache.cpp \
           source/rest_api_in_v1_handler.cpp \
           source/rest_api_in_v1_rest_handler.cpp \
           source/rest_api_in_v1_inesonic_rest_handler_base.cpp \
@@ -64,6 +82,8 @@ SOURCES = source/rest_api_in_v1_server.cpp \
           source/rest_api_in_v1_response.cpp \
           source/rest_api_in_v1_json_response.cpp \
           source/rest_api_in_v1_binary_response.cpp \
+          source/rest_api_in_v1_streaming_response.cpp \
+          source/rest_api_in_v1_file_response.cpp \
           source/rest_api_in_v1_customer_data.cpp \
           source/rest_api_in_v1_inesonic_rest_handler.cpp \
           source/rest_api_in_v1_inesonic_binary_rest_handler.cpp \
@@ -76,8 +96,24 @@ SOURCES = source/rest_api_in_v1_server.cpp \
 
 INCLUDEPATH += source
 PRIVATE_HEADERS = source/rest_api_in_v1_connection.h \
+                  source/rest_api_in_v1_connection_pool.h \
+                  source/rest_api_in_v1_lock_free_queue.h \
+                  source/rest_api_in_v1_buffer_pool.h \
+                  source/rest_api_in_v1_request_parser.h \
+                  source/rest_api_in_v1_router.h \
+                  source/rest_api_in_v1_route_table.h \
+                  source/rest_api_in_v1_event_thread.h \
+                  source/rest_api_in_v1_timer_wheel.h \
+                  source/rest_api_in_v1_event_engine.h \
+                  source/rest_api_in_v1_listener_thread.h \
                   source/rest_api_in_v1_server_private.h \
                   source/rest_api_in_v1_authentication_helpers.h \
+                  source/rest_api_in_v1_content_coding.h \
+                  source/rest_api_in_v1_sha256.h \
+                  source/rest_api_in_v1_sha256_lanes.h \
+                  source/rest_api_in_v1_blake2b.h \
+                  source/rest_api_in_v1_base64.h \
+                  source/rest_api_in_v1_compression_cache.h \
                   source/rest_api_in_v1_inesonic_rest_handler_base_private.h \
                   source/rest_api_in_v1_inesonic_customer_rest_handler_private.h \
                   source/rest_api_in_v1_inesonic_customer_binary_rest_handler_private.h \
@@ -94,6 +130,14 @@ HEADERS = $${API_HEADERS} $${PRIVATE_HEADERS}
 
 INCLUDEPATH += $${INECRYPTO_INCLUDE}
 
+LIBS += -lz
+
+# Add "CONFIG += zstd" to offer zstd response compression.
+zstd {
+    DEFINES += REST_API_IN_V1_ZSTD
+    LIBS += -lzstd
+}
+
 ########################################################################################################################
 # Locate build intermediate and output products
 #
@@ -23,31 +23,34 @@
 #include <QString>
 #include <QByteArray>
 #include <QDateTime>
+#include <QList>
+#include <QJsonValue>
 
+#include <algorithm>
 #include <cstring>
 #include <cstdint>
+#include <ctime>
 
-#include <crypto_hmac.h>
-
+#include "rest_api_in_v1_sha256.h"
+#include "rest_api_in_v1_sha256_lanes.h"
 #include "rest_api_in_v1_authentication_helpers.h"
 
 namespace RestApiInV1 {
-    static const Crypto::Hmac::Algorithm hashAlgorithm       = Crypto::Hmac::Algorithm::Sha256;
-    static const unsigned                hmacBlockSize       = Crypto::Hmac::blockSize(hashAlgorithm);
-    static const unsigned                hmacDigestSize      = Crypto::Hmac::digestSize(hashAlgorithm);
-    static const unsigned                hmacDigestChunkSize = hmacDigestSize / sizeof(std::uint64_t);
-    static const unsigned                timestampLength     = 8;
+    // The message format fixes the key and hash lengths.  Every MacAlgorithm is keyed and sized to match.
+    static const unsigned macKeyLength       = Sha256::blockLength;
+    static const unsigned macDigestLength    = Sha256::digestLength;
+    static const unsigned macDigestChunkSize = macDigestLength / sizeof(std::uint64_t);
+    static const unsigned timestampLength    = 8;
 
-    const unsigned inesonicSecretLength       = hmacBlockSize - timestampLength;
-    const unsigned inesonicSecretPaddedLength = hmacBlockSize;
-    const unsigned inesonicHashLength         = hmacDigestSize;
+    const unsigned inesonicSecretLength       = macKeyLength - timestampLength;
+    const unsigned inesonicSecretPaddedLength = macKeyLength;
+    const unsigned inesonicHashLength         = macDigestLength;
 
-    static bool compareHash(const QByteArray& receivedHash, const QByteArray& expectedHash) {
+    static bool compareHash(const QByteArray& receivedHash, const std::uint64_t* expectedHashData) {
         // Implementation below is designed to be fast and constant time.
-        const std::uint64_t* expectedHashData = reinterpret_cast<const std::uint64_t*>(expectedHash.constData());
         const std::uint64_t* receivedHashData = reinterpret_cast<const std::uint64_t*>(receivedHash.constData());
         std::uint64_t        result           = 0;
-        for (unsigned i=0 ; i<hmacDigestChunkSize ; ++i) {
+        for (unsigned i=0 ; i<macDigestChunkSize ; ++i) {
             result |= (expectedHashData[i] - receivedHashData[i]);
         }
 
@@ -55,47 +58,437 @@ namespace RestApiInV1 {
     }
 
 
+    /**
+     * Number of time windows we accept.
+     */
+    static constexpr unsigned numberWindows = 3;
+
+    /**
+     * Offsets of the accepted time windows, in the order they are tried.
+     */
+    static const long long windowOffsets[numberWindows] = { 0, 1, -1 };
+
+    /**
+     * Method that builds the key for a time window, the secret followed by the little-endian time index.
+     *
+     * \param[in]  secret The padded secret.
+     *
+     * \param[in]  window The time window.
+     *
+     * \param[out] key    Receives the \ref inesonicSecretPaddedLength byte key.
+     */
+    static void windowKey(const QByteArray& secret, unsigned long long window, unsigned char* key) {
+        unsigned secretLength = std::min(static_cast<unsigned>(secret.size()), inesonicSecretLength);
+
+        std::memset(key, 0, inesonicSecretPaddedLength);
+        std::memcpy(key, secret.constData(), secretLength);
+        for (unsigned i=0 ; i<timestampLength ; ++i) {
+            key[inesonicSecretLength + i] = static_cast<unsigned char>(window >> (8 * i));
+        }
+    }
+
+
+    /**
+     * Per-thread cache of key schedules, keyed by secret.
+     */
+    class KeyScheduleCache {
+        public:
+            /**
+             * The maximum number of secrets held by each thread.
+             */
+            static constexpr unsigned maximumEntries = 16;
+
+            ~KeyScheduleCache() {
+                for (QList<Entry>::iterator it=entries.begin(),end=entries.end() ; it!=end ; ++it) {
+                    std::memset(it->schedules, 0, sizeof(it->schedules));
+                }
+            }
+
+            /**
+             * Method that obtains the schedules for a secret and time window.
+             *
+             * \param[in] secret The padded secret.
+             *
+             * \param[in] window The current time window.
+             *
+             * \return Returns the schedules ordered as \ref windowOffsets.
+             */
+            const HmacKeySchedule* schedules(const QByteArray& secret, unsigned long long window) {
+                unsigned numberEntries = static_cast<unsigned>(entries.size());
+                unsigned index         = 0;
+                while (index < numberEntries && entries.at(index).secret != secret) {
+                    ++index;
+                }
+
+                if (index >= numberEntries) {
+                    if (numberEntries >= maximumEntries) {
+                        std::memset(entries.last().schedules, 0, sizeof(Entry::schedules));
+                        entries.removeLast();
+                    }
+
+                    Entry entry;
+                    entry.secret = secret;
+                    entry.window = window;
+                    for (unsigned i=0 ; i<numberWindows ; ++i) {
+                        entry.schedules[i] = calculateSchedule(secret, window + windowOffsets[i]);
+                    }
+
+                    entries.prepend(entry);
+                } else {
+                    if (index != 0) {
+                        entries.move(static_cast<int>(index), 0);
+                    }
+
+                    Entry& entry = entries.first();
+                    if (entry.window != window) {
+                        rollSchedules(entry, window);
+                    }
+                }
+
+                return entries.first().schedules;
+            }
+
+        private:
+            /**
+             * A cached secret.
+             */
+            struct Entry {
+                /**
+                 * The secret.
+                 */
+                QByteArray secret;
+
+                /**
+                 * The time window the schedules were calculated for.
+                 */
+                unsigned long long window;
+
+                /**
+                 * The schedules, ordered as \ref windowOffsets.
+                 */
+                HmacKeySchedule schedules[numberWindows];
+            };
+
+            /**
+             * Method that moves an entry to a new time window, keeping schedules for windows that are still accepted.
+             *
+             * \param[in,out] entry  The entry to be updated.
+             *
+             * \param[in]     window The new time window.
+             */
+            static void rollSchedules(Entry& entry, unsigned long long window) {
+                HmacKeySchedule newSchedules[numberWindows];
+
+                for (unsigned i=0 ; i<numberWindows ; ++i) {
+                    unsigned long long target = window + windowOffsets[i];
+                    unsigned           j      = 0;
+                    while (j < numberWindows && entry.window + windowOffsets[j] != target) {
+                        ++j;
+                    }
+
+                    if (j < numberWindows) {
+                        newSchedules[i] = entry.schedules[j];
+                    } else {
+                        newSchedules[i] = calculateSchedule(entry.secret, target);
+                    }
+                }
+
+                std::memcpy(entry.schedules, newSchedules, sizeof(newSchedules));
+                std::memset(newSchedules, 0, sizeof(newSchedules));
+                entry.window = window;
+            }
+
+            /**
+             * Method that calculates the schedule for a secret and time window.
+             *
+             * \param[in] secret The padded secret.
+             *
+             * \param[in] window The time window.
+             *
+             * \return Returns the calculated schedule.
+             */
+            static HmacKeySchedule calculateSchedule(const QByteArray& secret, unsigned long long window) {
+                HmacKeySchedule schedule;
+                unsigned char   key[Sha256::blockLength];
+                unsigned char   paddedKey[Sha256::blockLength];
+
+                windowKey(secret, window, key);
+
+                for (unsigned i=0 ; i<Sha256::blockLength ; ++i) {
+                    paddedKey[i] = key[i] ^ 0x36;
+                }
+
+                schedule.inner = Sha256::initialState;
+                Sha256::compress(schedule.inner, paddedKey, 1);
+
+                for (unsigned i=0 ; i<Sha256::blockLength ; ++i) {
+                    paddedKey[i] = key[i] ^ 0x5C;
+                }
+
+                schedule.outer = Sha256::initialState;
+                Sha256::compress(schedule.outer, paddedKey, 1);
+
+                std::memset(key, 0, sizeof(key));
+                std::memset(paddedKey, 0, sizeof(paddedKey));
+
+                return schedule;
+            }
+
+            /**
+             * The cached secrets, most recently used first.
+             */
+            QList<Entry> entries;
+    };
+
+    /**
+     * Method that obtains the key schedules for a secret and time window from this thread's cache.
+     *
+     * \param[in] secret The padded secret.
+     *
+     * \param[in] window The current time window.
+     *
+     * \return Returns the schedules ordered as \ref windowOffsets.
+     */
+    static const HmacKeySchedule* keySchedules(const QByteArray& secret, unsigned long long window) {
+        static thread_local KeyScheduleCache cache;
+        return cache.schedules(secret, window);
+    }
+
+
+    /**
+     * Method that completes the HMAC calculation for every time window and compares each against the received hash.
+     * Every window is compared so the time taken does not depend on which window matched.
+     *
+     * \param[in] innerHashes    The inner hash calculation, with all data added.
+     *
+     * \param[in] outerStates    The outer hash state for each time window.
+     *
+     * \param[in] checkedWindows The number of time windows being checked.
+     *
+     * \param[in] receivedHash   The received hash to be checked.
+     *
+     * \return Returns true if the hash is correct for any time window.
+     */
+    static bool checkWindows(
+            const Sha256Lanes&   innerHashes,
+            const Sha256::State* outerStates,
+            unsigned             checkedWindows,
+            const QByteArray&    receivedHash
+        ) {
+        bool          success = false;
+        unsigned char innerDigests[numberWindows * Sha256::digestLength];
+
+        innerHashes.result(innerDigests);
+        for (unsigned i=0 ; i<checkedWindows ; ++i) {
+            std::uint64_t expectedHash[Sha256::digestLength / sizeof(std::uint64_t)];
+
+            const char* innerDigest = reinterpret_cast<const char*>(innerDigests + i * Sha256::digestLength);
+
+            Sha256 outerHash(outerStates[i], Sha256::blockLength);
+            outerHash.addData(innerDigest, Sha256::digestLength);
+            outerHash.result(reinterpret_cast<unsigned char*>(expectedHash));
+
+            success |= compareHash(receivedHash, expectedHash);
+        }
+
+        return success;
+    }
+
+
+    /**
+     * Method that locates a client supplied time window among the windows we accept.
+     *
+     * \param[in] timeWindow    The time window used by the client.
+     *
+     * \param[in] currentWindow The current time window.
+     *
+     * \return Returns the index into \ref windowOffsets.  Returns \ref numberWindows if the window is not accepted.
+     */
+    static unsigned windowIndex(unsigned long long timeWindow, unsigned long long currentWindow) {
+        unsigned index = 0;
+        while (index < numberWindows && currentWindow + windowOffsets[index] != timeWindow) {
+            ++index;
+        }
+
+        return index;
+    }
+
+
+    unsigned long long currentTimeWindow() {
+        unsigned long long currentTimestamp;
+
+        // The coarse clock is read from the page the kernel updates on each tick so no system call is needed per
+        // request.
+#if (defined(Q_OS_LINUX))
+        struct timespec now;
+        if (clock_gettime(CLOCK_REALTIME_COARSE, &now) == 0) {
+            currentTimestamp = static_cast<unsigned long long>(now.tv_sec);
+        } else {
+            currentTimestamp = QDateTime::currentSecsSinceEpoch();
+        }
+#else
+        currentTimestamp = QDateTime::currentSecsSinceEpoch();
+#endif
+
+        return currentTimestamp / 30;
+    }
+
+
+    bool parseTimeWindow(const QJsonValue& value, unsigned long long& window) {
+        bool success = false;
+
+        if (value.isDouble()) {
+            // Values past 2^53 can not be represented exactly.
+            double windowAsDouble = value.toDouble();
+            if (windowAsDouble >= 0 && windowAsDouble < 9007199254740992.0) {
+                window  = static_cast<unsigned long long>(windowAsDouble);
+                success = (static_cast<double>(window) == windowAsDouble);
+            }
+        }
+
+        return success;
+    }
+
+
+    bool parseTimeWindow(const QByteArray& value, unsigned long long& window) {
+        bool success;
+        window = value.trimmed().toULongLong(&success, 10);
+
+        return success;
+    }
+
+
+    const HmacKeySchedule* hmacKeySchedules(const QByteArray& secret) {
+        return keySchedules(secret, currentTimeWindow());
+    }
+
+
     bool checkHash(
             const QByteArray& receivedData,
             const QByteArray& receivedHash,
-            const QByteArray& secret
+            const QByteArray& secret,
+            MacAlgorithm      algorithm
         ) {
-        bool success;
+        HashVerifier verifier(secret, algorithm);
+        verifier.addData(receivedData.constData(), static_cast<unsigned long>(receivedData.size()));
 
-        unsigned long long currentTimestamp = QDateTime::currentSecsSinceEpoch();
-        QByteArray         fullSecret       = secret;
-        std::uint64_t*     rawSecret        = reinterpret_cast<std::uint64_t*>(fullSecret.data());
+        return verifier.checkHash(receivedHash);
+    }
 
-        // Round 1: No time offset
-        unsigned long long hashSuffix       = (currentTimestamp / 30) + 0;
-        rawSecret[inesonicSecretLength / 8] = hashSuffix;
 
-        Crypto::Hmac hmac(fullSecret, receivedData, hashAlgorithm);
-        QByteArray   expectedHash     = hmac.digest();
+    bool checkHash(
+            const QByteArray&  receivedData,
+            const QByteArray&  receivedHash,
+            const QByteArray&  secret,
+            unsigned long long timeWindow,
+            MacAlgorithm       algorithm
+        ) {
+        HashVerifier verifier(secret, timeWindow, algorithm);
+        verifier.addData(receivedData.constData(), static_cast<unsigned long>(receivedData.size()));
 
-        if (compareHash(receivedHash, expectedHash)) {
-            success = true;
-        } else {
-            // Round 2: +1
-            unsigned long long hashSuffix       = (currentTimestamp / 30) + 1;
-            rawSecret[inesonicSecretLength / 8] = hashSuffix;
-
-            Crypto::Hmac hmac(fullSecret, receivedData, hashAlgorithm);
-            QByteArray   expectedHash     = hmac.digest();
-            if (compareHash(receivedHash, expectedHash)) {
-                success = true;
+        return verifier.checkHash(receivedHash);
+    }
+
+
+    HashVerifier::HashVerifier(
+            const QByteArray& secret,
+            MacAlgorithm      algorithm
+        ):currentAlgorithm(
+            algorithm
+        ),currentNumberWindows(
+            0
+        ) {
+        startWindows(secret, currentTimeWindow(), 0, numberWindows);
+    }
+
+
+    HashVerifier::HashVerifier(
+            const QByteArray&  secret,
+            unsigned long long timeWindow,
+            MacAlgorithm       algorithm
+        ):currentAlgorithm(
+            algorithm
+        ),currentNumberWindows(
+            0
+        ) {
+        unsigned long long currentWindow = currentTimeWindow();
+        unsigned           index         = windowIndex(timeWindow, currentWindow);
+
+        // A window we do not accept leaves nothing to calculate so every check fails without hashing the data.
+        if (index < numberWindows) {
+            startWindows(secret, currentWindow, index, 1);
+        }
+    }
+
+
+    HashVerifier::~HashVerifier() {
+        std::memset(windowOuterStates, 0, sizeof(windowOuterStates));
+    }
+
+
+    void HashVerifier::addData(const char* data, unsigned long length) {
+        if (currentNumberWindows > 0) {
+            if (currentAlgorithm == MacAlgorithm::HMAC_SHA256) {
+                innerHashes.addData(data, length);
+            } else {
+                for (unsigned i=0 ; i<currentNumberWindows ; ++i) {
+                    windowBlake2bs[i].addData(data, length);
+                }
+            }
+        }
+    }
+
+
+    bool HashVerifier::checkHash(const QByteArray& receivedHash) {
+        bool success = false;
+
+        if (static_cast<unsigned>(receivedHash.size()) == inesonicHashLength) {
+            if (currentAlgorithm == MacAlgorithm::HMAC_SHA256) {
+                success = checkWindows(innerHashes, windowOuterStates, currentNumberWindows, receivedHash);
             } else {
-                // Round 3: -1
-                unsigned long long hashSuffix       = (currentTimestamp / 30) - 1;
-                rawSecret[inesonicSecretLength / 8] = hashSuffix;
+                for (unsigned i=0 ; i<currentNumberWindows ; ++i) {
+                    std::uint64_t expectedHash[Sha256::digestLength / sizeof(std::uint64_t)];
 
-                Crypto::Hmac hmac(fullSecret, receivedData, hashAlgorithm);
-                QByteArray   expectedHash     = hmac.digest();
+                    // Completing the calculation on a copy leaves this verifier usable for further checks.
+                    Blake2b mac = windowBlake2bs[i];
+                    mac.result(reinterpret_cast<unsigned char*>(expectedHash));
 
-                success = compareHash(receivedHash, expectedHash);
+                    success |= compareHash(receivedHash, expectedHash);
+                }
             }
         }
 
         return success;
     }
+
+
+    void HashVerifier::startWindows(
+            const QByteArray&  secret,
+            unsigned long long currentWindow,
+            unsigned           firstWindow,
+            unsigned           count
+        ) {
+        if (currentAlgorithm == MacAlgorithm::HMAC_SHA256) {
+            const HmacKeySchedule* schedules = keySchedules(secret, currentWindow) + firstWindow;
+            Sha256::State          innerStates[numberWindows];
+
+            for (unsigned i=0 ; i<count ; ++i) {
+                innerStates[i]       = schedules[i].inner;
+                windowOuterStates[i] = schedules[i].outer;
+            }
+
+            innerHashes = Sha256Lanes(innerStates, count, Sha256::blockLength);
+        } else {
+            unsigned char key[Blake2b::maximumKeyLength];
+
+            for (unsigned i=0 ; i<count ; ++i) {
+                windowKey(secret, currentWindow + windowOffsets[firstWindow + i], key);
+                windowBlake2bs[i] = Blake2b(key, inesonicSecretPaddedLength, inesonicHashLength);
+            }
+
+            std::memset(key, 0, sizeof(key));
+        }
+
+        currentNumberWindows = count;
+    }
 }
@@ -27,8 +27,13 @@
 #include <QByteArray>
 #include <QHash>
 #include <QJsonDocument>
+#include <QJsonValue>
 
 #include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_mac_algorithm.h"
+#include "rest_api_in_v1_sha256.h"
+#include "rest_api_in_v1_sha256_lanes.h"
+#include "rest_api_in_v1_blake2b.h"
 
 namespace RestApiInV1 {
     /**
@@ -46,6 +51,63 @@ namespace RestApiInV1 {
      */
     extern const unsigned inesonicHashLength;
 
+    /**
+     * The HMAC key schedule for one secret and time window.  Holds the SHA-256 states after hashing the inner and
+     * outer padded keys so each message only pays for hashing its own data.
+     */
+    struct HmacKeySchedule {
+        /**
+         * The state after hashing the key combined with the inner pad.
+         */
+        Sha256::State inner;
+
+        /**
+         * The state after hashing the key combined with the outer pad.
+         */
+        Sha256::State outer;
+    };
+
+    /**
+     * Method that obtains the key schedules for the accepted time windows.  Schedules are cached per thread and per
+     * secret.  When the time window advances, only the schedule for the newly accepted window is calculated.
+     *
+     * \param[in] secret The secret to apply to this calculation.  The secret should be padded to a length of
+     *                   \ref inesonicSecretPaddedLength.
+     *
+     * \return Returns a pointer to the schedules for the current, next, and previous time windows, in that order.
+     *         The pointer is valid until the next call from the same thread.
+     */
+    const HmacKeySchedule* hmacKeySchedules(const QByteArray& secret);
+
+    /**
+     * Method that obtains the current time window.  Clients hash against the window \f$ t_{unix} / 30 \f$.
+     *
+     * \return Returns the current time window.
+     */
+    unsigned long long currentTimeWindow();
+
+    /**
+     * Method that reads a time window supplied by the client as a hint.
+     *
+     * \param[in]  value  The JSON value holding the hint.
+     *
+     * \param[out] window Receives the time window.
+     *
+     * \return Returns true if the value holds a valid time window.  Returns false if the value is invalid.
+     */
+    bool parseTimeWindow(const QJsonValue& value, unsigned long long& window);
+
+    /**
+     * Method that reads a time window supplied by the client as a hint.
+     *
+     * \param[in]  value  The header value holding the hint.
+     *
+     * \param[out] window Receives the time window.
+     *
+     * \return Returns true if the value holds a valid time window.  Returns false if the value is invalid.
+     */
+    bool parseTimeWindow(const QByteArray& value, unsigned long long& window);
+
     /**
      * Method that checks our hash.
      *
@@ -56,13 +118,147 @@ namespace RestApiInV1 {
      * \param[in] secret       The secret to apply to this calculation.  The secret should be padded to a length of
      *                         length of \ref inesonicSecretPaddedLength.
      *
+     * \param[in] algorithm    The message authentication code used by the client.
+     *
      * \return Returns true if the hash is correct.  Returns false if the hash is incorrect.
      */
     bool checkHash(
         const QByteArray& receivedData,
         const QByteArray& receivedHash,
-        const QByteArray& secret
+        const QByteArray& secret,
+        MacAlgorithm      algorithm = MacAlgorithm::HMAC_SHA256
     );
+
+    /**
+     * Method that checks our hash against the single time window the client says it used.  Only one hash is
+     * calculated.
+     *
+     * \param[in] receivedData The raw data to be checked.
+     *
+     * \param[in] receivedHash The received hash to be checked.
+     *
+     * \param[in] secret       The secret to apply to this calculation.  The secret should be padded to a length of
+     *                         length of \ref inesonicSecretPaddedLength.
+     *
+     * \param[in] timeWindow   The time window used by the client.
+     *
+     * \param[in] algorithm    The message authentication code used by the client.
+     *
+     * \return Returns true if the hash is correct.  Returns false if the hash is incorrect or if the time window is
+     *         not one of the windows we accept.
+     */
+    bool checkHash(
+        const QByteArray&  receivedData,
+        const QByteArray&  receivedHash,
+        const QByteArray&  secret,
+        unsigned long long timeWindow,
+        MacAlgorithm       algorithm = MacAlgorithm::HMAC_SHA256
+    );
+
+    /**
+     * Class that checks our hash as the data arrives.  The hash for every accepted time window is computed in
+     * parallel so the result is known as soon as the last byte has been added.  HMAC-SHA256 windows share one pass
+     * over the data using the cached key schedules from \ref hmacKeySchedules.  The time windows are fixed when the
+     * instance is constructed.
+     */
+    class HashVerifier {
+        public:
+            /**
+             * Constructor
+             *
+             * \param[in] secret    The secret to apply to this calculation.  The secret should be padded to a length
+             *                      of \ref inesonicSecretPaddedLength.
+             *
+             * \param[in] algorithm The message authentication code used by the client.
+             */
+            HashVerifier(const QByteArray& secret, MacAlgorithm algorithm = MacAlgorithm::HMAC_SHA256);
+
+            /**
+             * Constructor.  Only the time window the client says it used is checked.
+             *
+             * \param[in] secret     The secret to apply to this calculation.  The secret should be padded to a
+             *                       length of \ref inesonicSecretPaddedLength.
+             *
+             * \param[in] timeWindow The time window used by the client.  Every check fails if this is not one of
+             *                       the windows we accept.
+             *
+             * \param[in] algorithm  The message authentication code used by the client.
+             */
+            HashVerifier(
+                const QByteArray&  secret,
+                unsigned long long timeWindow,
+                MacAlgorithm       algorithm = MacAlgorithm::HMAC_SHA256
+            );
+
+            ~HashVerifier();
+
+            /**
+             * Method you can use to add data to the hash calculation.
+             *
+             * \param[in] data   Pointer to the data to be added.
+             *
+             * \param[in] length The number of bytes to be added.
+             */
+            void addData(const char* data, unsigned long length);
+
+            /**
+             * Method you can use to check the received hash against the data added so far.
+             *
+             * \param[in] receivedHash The received hash to be checked.
+             *
+             * \return Returns true if the hash is correct.  Returns false if the hash is incorrect.
+             */
+            bool checkHash(const QByteArray& receivedHash);
+
+        private:
+            /**
+             * The number of time windows we accept.
+             */
+            static constexpr unsigned numberWindows = 3;
+
+            /**
+             * Method that starts the calculation for a run of time windows.
+             *
+             * \param[in] secret        The padded secret.
+             *
+             * \param[in] currentWindow The current time window.
+             *
+             * \param[in] firstWindow   Index of the first window, in the order the windows are tried.
+             *
+             * \param[in] count         The number of windows to be checked.
+             */
+            void startWindows(
+                const QByteArray&  secret,
+                unsigned long long currentWindow,
+                unsigned           firstWindow,
+                unsigned           count
+            );
+
+            /**
+             * The message authentication code in use.
+             */
+            MacAlgorithm currentAlgorithm;
+
+            /**
+             * The inner hash calculation, one lane per time window.  Used for \ref MacAlgorithm::HMAC_SHA256.
+             */
+            Sha256Lanes innerHashes;
+
+            /**
+             * The outer hash state for each time window.
+             */
+            Sha256::State windowOuterStates[numberWindows];
+
+            /**
+             * The keyed hash calculation for each time window.  Used for \ref MacAlgorithm::BLAKE2B_256.
+             */
+            Blake2b windowBlake2bs[numberWindows];
+
+            /**
+             * The number of time windows being checked.
+             */
+            unsigned currentNumberWindows;
+    };
 };
 
 #endif
@@ -0,0 +1,227 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements base 64 decoding functions.
+***********************************************************************************************************************/
+
+#include <QString>
+#include <QByteArray>
+
+#include <cstdint>
+
+#if (defined(__x86_64__) && defined(__GNUC__))
+#include <immintrin.h>
+#endif
+
+#include "rest_api_in_v1_base64.h"
+
+namespace RestApiInV1 {
+    /**
+     * Value used in \ref base64Values to mark characters that are not part of the alphabet.
+     */
+    static constexpr unsigned char invalidBase64Value = 0xFF;
+
+    static const unsigned char base64Values[128] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,   62, 0xFF, 0xFF, 0xFF,   63,
+          52,   53,   54,   55,   56,   57,   58,   59,   60,   61, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF,    0,    1,    2,    3,    4,    5,    6,    7,    8,    9,   10,   11,   12,   13,   14,
+          15,   16,   17,   18,   19,   20,   21,   22,   23,   24,   25, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF,   26,   27,   28,   29,   30,   31,   32,   33,   34,   35,   36,   37,   38,   39,   40,
+          41,   42,   43,   44,   45,   46,   47,   48,   49,   50,   51, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+    };
+
+    /**
+     * Method that looks up the value of one base 64 character.
+     *
+     * \param[in] character The character to be looked up.
+     *
+     * \return Returns the 6-bit value.  Returns \ref invalidBase64Value if the character is not in the alphabet.
+     */
+    static inline unsigned char base64Value(ushort character) {
+        return character < 128 ? base64Values[character] : invalidBase64Value;
+    }
+
+#if (defined(__x86_64__) && defined(__GNUC__))
+
+    /**
+     * AVX2 decoder.  Each iteration translates and validates 32 characters with byte shuffles, then packs the 6-bit
+     * values into 24 bytes.  The caller must leave at least 8 bytes of output beyond each group of 24.
+     *
+     * \param[in]     input        The encoded characters.
+     *
+     * \param[in]     numberGroups The number of 32 character groups to be decoded.
+     *
+     * \param[out]    output       Receives the decoded data.
+     *
+     * \return Returns true on success.  Returns false if an invalid character was found.
+     */
+    __attribute__((target("avx2")))
+    static bool decodeBase64Avx2(const ushort* input, unsigned long numberGroups, unsigned char* output) {
+        // Tables are indexed by nibble.  A character is valid when the bits selected by its low and high nibbles do
+        // not intersect.  The roll table holds the offset that maps each character range onto its 6-bit value.
+        const __m256i lowNibbleTable = _mm256_setr_epi8(
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A
+        );
+        const __m256i highNibbleTable = _mm256_setr_epi8(
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+        );
+        const __m256i rollTable = _mm256_setr_epi8(
+            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
+        );
+        const __m256i nibbleMask   = _mm256_set1_epi8(0x0F);
+        const __m256i slash        = _mm256_set1_epi8(0x2F);
+        const __m256i mergePairs   = _mm256_set1_epi32(0x01400140);
+        const __m256i mergeQuads   = _mm256_set1_epi32(0x00011000);
+        const __m256i byteOrder    = _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+        );
+        const __m256i compactLanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+
+        bool          success = true;
+        unsigned long group   = 0;
+
+        while (success && group < numberGroups) {
+            const __m256i* groupInput = reinterpret_cast<const __m256i*>(input + 32 * group);
+
+            // Characters past 0xFF saturate to 0xFF, and past 0x7FFF to 0, both of which are rejected below.
+            __m256i characters = _mm256_permute4x64_epi64(
+                _mm256_packus_epi16(_mm256_loadu_si256(groupInput), _mm256_loadu_si256(groupInput + 1)),
+                0xD8
+            );
+
+            __m256i highNibbles = _mm256_and_si256(_mm256_srli_epi32(characters, 4), nibbleMask);
+            __m256i lowNibbles  = _mm256_and_si256(characters, nibbleMask);
+            __m256i lowBits     = _mm256_shuffle_epi8(lowNibbleTable, lowNibbles);
+            __m256i highBits    = _mm256_shuffle_epi8(highNibbleTable, highNibbles);
+
+            success = _mm256_testz_si256(lowBits, highBits);
+
+            __m256i roll   = _mm256_shuffle_epi8(
+                rollTable,
+                _mm256_add_epi8(_mm256_cmpeq_epi8(characters, slash), highNibbles)
+            );
+            __m256i values = _mm256_add_epi8(characters, roll);
+
+            __m256i merged = _mm256_madd_epi16(_mm256_maddubs_epi16(values, mergePairs), mergeQuads);
+            merged = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(merged, byteOrder), compactLanes);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + 24 * group), merged);
+            ++group;
+        }
+
+        return success;
+    }
+
+#endif
+
+    bool base64DecoderSupported(Base64Decoder decoder) {
+        bool result;
+
+#if (defined(__x86_64__) && defined(__GNUC__))
+        static const bool useAvx2 = __builtin_cpu_supports("avx2");
+
+        if (decoder == Base64Decoder::AVX2) {
+            result = useAvx2;
+        } else {
+            result = true;
+        }
+#else
+        result = (decoder == Base64Decoder::PORTABLE);
+#endif
+
+        return result;
+    }
+
+
+    bool decodeBase64(const QString& encoded, QByteArray& decoded) {
+        Base64Decoder decoder = Base64Decoder::PORTABLE;
+        if (base64DecoderSupported(Base64Decoder::AVX2)) {
+            decoder = Base64Decoder::AVX2;
+        }
+
+        return decodeBase64(encoded, decoded, decoder);
+    }
+
+
+    bool decodeBase64(const QString& encoded, QByteArray& decoded, Base64Decoder decoder) {
+        const ushort* input       = reinterpret_cast<const ushort*>(encoded.utf16());
+        unsigned long inputLength = static_cast<unsigned long>(encoded.size());
+
+        // One or two padding characters are allowed only at the end of input whose length is a multiple of 4.  Any
+        // other padding is rejected as an invalid character below.
+        if (inputLength > 0 && (inputLength % 4) == 0 && input[inputLength - 1] == '=') {
+            --inputLength;
+            if (input[inputLength - 1] == '=') {
+                --inputLength;
+            }
+        }
+
+        unsigned long outputLength = (inputLength * 3) / 4;
+        decoded.resize(static_cast<int>(outputLength));
+
+        unsigned char* output  = reinterpret_cast<unsigned char*>(decoded.data());
+        unsigned long  in      = 0;
+        unsigned long  out     = 0;
+        bool           success = true;
+
+#if (defined(__x86_64__) && defined(__GNUC__))
+        // Each group writes 32 bytes for 24 decoded so stop while that still fits.
+        if (decoder == Base64Decoder::AVX2 && inputLength >= 44) {
+            unsigned long numberGroups = (inputLength - 44) / 32 + 1;
+            success = decodeBase64Avx2(input, numberGroups, output);
+
+            in  = 32 * numberGroups;
+            out = 24 * numberGroups;
+        }
+#else
+        (void) decoder;
+#endif
+
+        std::uint32_t accumulator = 0;
+        unsigned      bits        = 0;
+        while (success && in < inputLength) {
+            unsigned char value = base64Value(input[in]);
+            if (value != invalidBase64Value) {
+                accumulator = (accumulator << 6) | value;
+                bits += 6;
+                if (bits >= 8) {
+                    bits -= 8;
+                    output[out++] = static_cast<unsigned char>(accumulator >> bits);
+                    accumulator &= (1U << bits) - 1;
+                }
+
+                ++in;
+            } else {
+                success = false;
+            }
+        }
+
+        if (!success) {
+            decoded.clear();
+        }
+
+        return success;
+    }
+}
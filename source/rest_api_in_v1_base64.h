@@ -0,0 +1,85 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements base 64 decoding functions.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_BASE64_H
+#define REST_API_IN_V1_BASE64_H
+
+#include <QString>
+#include <QByteArray>
+
+#include "rest_api_in_v1_common.h"
+
+namespace RestApiInV1 {
+    /**
+     * Enumeration of the base 64 decoders.  \ref decodeBase64 normally picks the decoder itself.  The decoders are
+     * named so each can be checked against the portable decoder.
+     */
+    enum class Base64Decoder {
+        /**
+         * Plain C++, available everywhere.
+         */
+        PORTABLE,
+
+        /**
+         * AVX2, 32 characters at a time.  Short inputs and the tail of longer inputs are decoded by the portable
+         * decoder.
+         */
+        AVX2
+    };
+
+    /**
+     * Method you can use to determine if the processor supports a base 64 decoder.
+     *
+     * \param[in] decoder The decoder to check.
+     *
+     * \return Returns true if the decoder can be used.
+     */
+    bool base64DecoderSupported(Base64Decoder decoder);
+
+    /**
+     * Method that decodes base 64 encoded data held in a string.  The string's UTF-16 data is decoded directly so no
+     * intermediate UTF-8 copy is made.  The rules match QByteArray::fromBase64Encoding with the options
+     * QByteArray::Base64Encoding and QByteArray::AbortOnBase64DecodingErrors.
+     *
+     * \param[in]  encoded The base 64 encoded string.
+     *
+     * \param[out] decoded Receives the decoded data.
+     *
+     * \return Returns true on success.  Returns false if the string holds an invalid character or invalid padding.
+     */
+    bool decodeBase64(const QString& encoded, QByteArray& decoded);
+
+    /**
+     * Method that decodes base 64 encoded data held in a string using a specific decoder.
+     *
+     * \param[in]  encoded The base 64 encoded string.
+     *
+     * \param[out] decoded Receives the decoded data.
+     *
+     * \param[in]  decoder The decoder to use.  The decoder must be supported by the processor.
+     *
+     * \return Returns true on success.  Returns false if the string holds an invalid character or invalid padding.
+     */
+    bool decodeBase64(const QString& encoded, QByteArray& decoded, Base64Decoder decoder);
+};
+
+#endif
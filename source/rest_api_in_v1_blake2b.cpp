@@ -0,0 +1,209 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::Blake2b class.
+***********************************************************************************************************************/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "rest_api_in_v1_blake2b.h"
+
+namespace RestApiInV1 {
+    constexpr unsigned Blake2b::blockLength;
+    constexpr unsigned Blake2b::maximumKeyLength;
+    constexpr unsigned Blake2b::maximumDigestLength;
+
+    static const std::uint64_t initializationVector[8] = {
+        0x6A09E667F3BCC908ULL, 0xBB67AE8584CAA73BULL, 0x3C6EF372FE94F82BULL, 0xA54FF53A5F1D36F1ULL,
+        0x510E527FADE682D1ULL, 0x9B05688C2B3E6C1FULL, 0x1F83D9ABFB41BD6BULL, 0x5BE0CD19137E2179ULL
+    };
+
+    static const unsigned char messageSchedule[12][16] = {
+        {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+        { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+        { 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
+        {  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
+        {  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
+        {  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
+        { 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
+        { 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
+        {  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
+        { 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 },
+        {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+        { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 }
+    };
+
+    static inline std::uint64_t rotateRight(std::uint64_t value, unsigned count) {
+        return (value >> count) | (value << (64 - count));
+    }
+
+
+    static inline std::uint64_t loadLittleEndian(const unsigned char* data) {
+        std::uint64_t result = 0;
+        for (unsigned i=0 ; i<8 ; ++i) {
+            result |= static_cast<std::uint64_t>(data[i]) << (8 * i);
+        }
+
+        return result;
+    }
+
+
+    static inline void mix(
+            std::uint64_t* v,
+            unsigned       a,
+            unsigned       b,
+            unsigned       c,
+            unsigned       d,
+            std::uint64_t  x,
+            std::uint64_t  y
+        ) {
+        v[a] = v[a] + v[b] + x;
+        v[d] = rotateRight(v[d] ^ v[a], 32);
+        v[c] = v[c] + v[d];
+        v[b] = rotateRight(v[b] ^ v[c], 24);
+        v[a] = v[a] + v[b] + y;
+        v[d] = rotateRight(v[d] ^ v[a], 16);
+        v[c] = v[c] + v[d];
+        v[b] = rotateRight(v[b] ^ v[c], 63);
+    }
+
+
+    Blake2b::Blake2b():pendingLength(0),currentDigestLength(0) {
+        std::memcpy(currentState, initializationVector, sizeof(currentState));
+        currentLength[0] = 0;
+        currentLength[1] = 0;
+    }
+
+
+    Blake2b::Blake2b(
+            const unsigned char* key,
+            unsigned             keyLength,
+            unsigned             digestLength
+        ):pendingLength(
+            0
+        ),currentDigestLength(
+            std::min(digestLength, maximumDigestLength)
+        ) {
+        keyLength = std::min(keyLength, maximumKeyLength);
+
+        // The parameter block only differs from zero in the digest length, key length, fanout, and depth.
+        std::memcpy(currentState, initializationVector, sizeof(currentState));
+        currentState[0] ^= 0x01010000ULL ^ (static_cast<std::uint64_t>(keyLength) << 8) ^ currentDigestLength;
+
+        currentLength[0] = 0;
+        currentLength[1] = 0;
+
+        if (keyLength > 0) {
+            std::memset(pendingData, 0, blockLength);
+            std::memcpy(pendingData, key, keyLength);
+            pendingLength = blockLength;
+        }
+    }
+
+
+    Blake2b::~Blake2b() {
+        std::memset(pendingData, 0, sizeof(pendingData));
+        std::memset(currentState, 0, sizeof(currentState));
+    }
+
+
+    void Blake2b::addData(const char* data, unsigned long length) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+
+        while (length > 0) {
+            if (pendingLength == blockLength) {
+                compress(pendingData, false);
+                pendingLength = 0;
+            }
+
+            if (pendingLength == 0 && length > blockLength) {
+                // Whole blocks are hashed in place, keeping at least one byte back for the final block.
+                compress(bytes, false);
+
+                bytes  += blockLength;
+                length -= blockLength;
+            } else {
+                unsigned long count = std::min(static_cast<unsigned long>(blockLength - pendingLength), length);
+                std::memcpy(pendingData + pendingLength, bytes, count);
+
+                pendingLength += static_cast<unsigned>(count);
+                bytes         += count;
+                length        -= count;
+            }
+        }
+    }
+
+
+    void Blake2b::result(unsigned char* digest) {
+        std::memset(pendingData + pendingLength, 0, blockLength - pendingLength);
+        compress(pendingData, true);
+        pendingLength = 0;
+
+        for (unsigned i=0 ; i<currentDigestLength ; ++i) {
+            digest[i] = static_cast<unsigned char>(currentState[i / 8] >> (8 * (i % 8)));
+        }
+    }
+
+
+    void Blake2b::compress(const unsigned char* block, bool lastBlock) {
+        std::uint64_t message[16];
+        std::uint64_t v[16];
+
+        // The length counter covers the bytes in this block.  The final block counts only the data it holds.
+        std::uint64_t blockBytes = lastBlock ? pendingLength : blockLength;
+        currentLength[0] += blockBytes;
+        if (currentLength[0] < blockBytes) {
+            ++currentLength[1];
+        }
+
+        for (unsigned i=0 ; i<16 ; ++i) {
+            message[i] = loadLittleEndian(block + 8 * i);
+        }
+
+        for (unsigned i=0 ; i<8 ; ++i) {
+            v[i]     = currentState[i];
+            v[i + 8] = initializationVector[i];
+        }
+
+        v[12] ^= currentLength[0];
+        v[13] ^= currentLength[1];
+        if (lastBlock) {
+            v[14] = ~v[14];
+        }
+
+        for (unsigned round=0 ; round<12 ; ++round) {
+            const unsigned char* s = messageSchedule[round];
+
+            mix(v, 0, 4,  8, 12, message[s[ 0]], message[s[ 1]]);
+            mix(v, 1, 5,  9, 13, message[s[ 2]], message[s[ 3]]);
+            mix(v, 2, 6, 10, 14, message[s[ 4]], message[s[ 5]]);
+            mix(v, 3, 7, 11, 15, message[s[ 6]], message[s[ 7]]);
+            mix(v, 0, 5, 10, 15, message[s[ 8]], message[s[ 9]]);
+            mix(v, 1, 6, 11, 12, message[s[10]], message[s[11]]);
+            mix(v, 2, 7,  8, 13, message[s[12]], message[s[13]]);
+            mix(v, 3, 4,  9, 14, message[s[14]], message[s[15]]);
+        }
+
+        for (unsigned i=0 ; i<8 ; ++i) {
+            currentState[i] ^= v[i] ^ v[i + 8];
+        }
+    }
+}
@@ -0,0 +1,122 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::Blake2b class.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_BLAKE2B_H
+#define REST_API_IN_V1_BLAKE2B_H
+
+#include <cstdint>
+
+#include "rest_api_in_v1_common.h"
+
+namespace RestApiInV1 {
+    /**
+     * BLAKE2b implementation, as described in RFC 7693, supporting keyed hashing.  The keyed mode is a MAC in its own
+     * right so no HMAC construction is needed.  The 64-bit operations make it faster than SHA-256 on 64-bit
+     * processors that lack SHA extensions.
+     */
+    class REST_API_V1_PUBLIC_API Blake2b {
+        public:
+            /**
+             * The BLAKE2b block length, in bytes.
+             */
+            static constexpr unsigned blockLength = 128;
+
+            /**
+             * The maximum key length, in bytes.
+             */
+            static constexpr unsigned maximumKeyLength = 64;
+
+            /**
+             * The maximum digest length, in bytes.
+             */
+            static constexpr unsigned maximumDigestLength = 64;
+
+            Blake2b();
+
+            /**
+             * Constructor
+             *
+             * \param[in] key          Pointer to the key.
+             *
+             * \param[in] keyLength    The key length, in bytes, up to \ref maximumKeyLength.  A length of 0 selects
+             *                         unkeyed hashing.
+             *
+             * \param[in] digestLength The digest length, in bytes, from 1 to \ref maximumDigestLength.
+             */
+            Blake2b(const unsigned char* key, unsigned keyLength, unsigned digestLength);
+
+            ~Blake2b();
+
+            /**
+             * Method you can use to add data to the hash calculation.
+             *
+             * \param[in] data   Pointer to the data to be added.
+             *
+             * \param[in] length The number of bytes to be added.
+             */
+            void addData(const char* data, unsigned long length);
+
+            /**
+             * Method you can use to complete the hash calculation.  No data can be added afterwards.
+             *
+             * \param[out] digest Receives the digest.
+             */
+            void result(unsigned char* digest);
+
+        private:
+            /**
+             * Method that hashes one block.
+             *
+             * \param[in] block     The block to be hashed.
+             *
+             * \param[in] lastBlock If true, this is the final block.
+             */
+            void compress(const unsigned char* block, bool lastBlock);
+
+            /**
+             * The current hash state.
+             */
+            std::uint64_t currentState[8];
+
+            /**
+             * The total number of bytes hashed, including the key block.
+             */
+            std::uint64_t currentLength[2];
+
+            /**
+             * Data waiting to be hashed.  The last block is held back until we know whether more data follows.
+             */
+            unsigned char pendingData[blockLength];
+
+            /**
+             * The number of bytes in \ref pendingData.
+             */
+            unsigned pendingLength;
+
+            /**
+             * The digest length, in bytes.
+             */
+            unsigned currentDigestLength;
+    };
+};
+
+#endif
@@ -0,0 +1,84 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::BufferPool class.
+***********************************************************************************************************************/
+
+#include <QByteArray>
+
+#include "rest_api_in_v1_lock_free_queue.h"
+#include "rest_api_in_v1_buffer_pool.h"
+
+namespace RestApiInV1 {
+    BufferPool::BufferPool() {
+        for (unsigned i=0 ; i<numberSizeClasses ; ++i) {
+            idleBuffers[i] = new LockFreeQueue<QByteArray>(sizeClassBudget / sizeClassCapacity(i));
+        }
+    }
+
+
+    BufferPool::~BufferPool() {
+        for (unsigned i=0 ; i<numberSizeClasses ; ++i) {
+            delete idleBuffers[i];
+        }
+    }
+
+
+    QByteArray BufferPool::acquire(unsigned long size) {
+        QByteArray result;
+
+        unsigned sizeClassIndex = sizeClass(size);
+        if (sizeClassIndex < numberSizeClasses) {
+            if (!idleBuffers[sizeClassIndex]->dequeue(result)) {
+                result.reserve(static_cast<int>(sizeClassCapacity(sizeClassIndex)));
+            }
+        } else {
+            result.reserve(static_cast<int>(size));
+        }
+
+        return result;
+    }
+
+
+    void BufferPool::release(QByteArray& buffer) {
+        // Shared buffers are still in use elsewhere and would be detached, losing the reservation, on first write.
+        if (buffer.isDetached()) {
+            unsigned long capacity       = static_cast<unsigned long>(buffer.capacity());
+            unsigned      sizeClassIndex = sizeClass(capacity);
+
+            if (sizeClassIndex < numberSizeClasses && sizeClassCapacity(sizeClassIndex) == capacity) {
+                // The reservation keeps the capacity when the buffer is emptied.
+                buffer.resize(0);
+                idleBuffers[sizeClassIndex]->enqueue(buffer);
+            }
+        }
+
+        buffer = QByteArray();
+    }
+
+
+    unsigned BufferPool::sizeClass(unsigned long size) {
+        unsigned result = 0;
+        while (result < numberSizeClasses && sizeClassCapacity(result) < size) {
+            ++result;
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,110 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::BufferPool class.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_BUFFER_POOL_H
+#define REST_API_IN_V1_BUFFER_POOL_H
+
+#include <QByteArray>
+
+#include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_lock_free_queue.h"
+
+namespace RestApiInV1 {
+    /**
+     * Class that recycles request body buffers so that steady traffic does not allocate a fresh body for every
+     * request.  Buffers are grouped into power of two size classes, each held in its own lock-free queue, so the
+     * workers sharing a pool never contend on a lock.
+     *
+     * Buffers larger than the largest size class are allocated on demand and are never retained.  A buffer is only
+     * returned to the pool if nothing else still holds a reference to it.
+     */
+    class REST_API_V1_PUBLIC_API BufferPool {
+        public:
+            /**
+             * The base two logarithm of the smallest size class, in bytes.
+             */
+            static constexpr unsigned smallestSizeClassShift = 12;
+
+            /**
+             * The number of size classes.  Classes run from 4 KiB up to 1 MiB.
+             */
+            static constexpr unsigned numberSizeClasses = 9;
+
+            /**
+             * The number of bytes we are willing to retain in each size class.
+             */
+            static constexpr unsigned long sizeClassBudget = 4194304;
+
+            BufferPool();
+
+            ~BufferPool();
+
+            /**
+             * Method you can use to obtain an empty buffer able to hold a given number of bytes without
+             * reallocating.
+             *
+             * \param[in] size The number of bytes the buffer must be able to hold.
+             *
+             * \return Returns an empty buffer with at least the requested capacity.
+             */
+            QByteArray acquire(unsigned long size);
+
+            /**
+             * Method you can use to return a buffer to the pool.  The supplied buffer is always cleared.
+             *
+             * \param[in,out] buffer The buffer to be returned.
+             */
+            void release(QByteArray& buffer);
+
+        private:
+            /**
+             * Method that determines the size class able to hold a given number of bytes.
+             *
+             * \param[in] size The number of bytes to be held.
+             *
+             * \return Returns the size class index.  The value \ref numberSizeClasses is returned if the size is too
+             *         large to be pooled.
+             */
+            static unsigned sizeClass(unsigned long size);
+
+            /**
+             * Method that determines the capacity of buffers in a size class.
+             *
+             * \param[in] sizeClassIndex The size class index.
+             *
+             * \return Returns the buffer capacity, in bytes.
+             */
+            static inline unsigned long sizeClassCapacity(unsigned sizeClassIndex) {
+                return 1UL << (smallestSizeClassShift + sizeClassIndex);
+            }
+
+            BufferPool(const BufferPool& other) = delete;
+            BufferPool& operator=(const BufferPool& other) = delete;
+
+            /**
+             * The idle buffers in each size class.
+             */
+            LockFreeQueue<QByteArray>* idleBuffers[numberSizeClasses];
+    };
+};
+
+#endif
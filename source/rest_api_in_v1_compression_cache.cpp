@@ -0,0 +1,100 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::CompressionCache class.
+***********************************************************************************************************************/
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QHash>
+
+#include "rest_api_in_v1_content_coding.h"
+#include "rest_api_in_v1_compression_cache.h"
+
+namespace RestApiInV1 {
+    CompressionCache::CompressionCache(unsigned capacity):currentCapacity(capacity) {}
+
+
+    CompressionCache::~CompressionCache() {}
+
+
+    void CompressionCache::setCapacity(unsigned newCapacity) {
+        QMutexLocker locker(&mutex);
+
+        currentCapacity = newCapacity;
+        while (static_cast<unsigned>(entries.size()) > currentCapacity) {
+            entries.removeLast();
+        }
+    }
+
+
+    unsigned CompressionCache::capacity() const {
+        QMutexLocker locker(&mutex);
+        return currentCapacity;
+    }
+
+
+    bool CompressionCache::find(ContentCoding coding, const QByteArray& body, QByteArray& encoded) {
+        bool found = false;
+
+        if (body.size() <= maximumCachedBodyLength) {
+            // Hash outside the lock so workers only serialize on the short scan.
+            unsigned hash = qHash(body);
+
+            QMutexLocker locker(&mutex);
+
+            int numberEntries = entries.size();
+            int index         = 0;
+            while (!found && index < numberEntries) {
+                const Entry& entry = entries.at(index);
+                found = (entry.hash == hash && entry.coding == coding && entry.body == body);
+                if (!found) {
+                    ++index;
+                }
+            }
+
+            if (found) {
+                encoded = entries.at(index).encoded;
+                if (index > 0) {
+                    entries.move(index, 0);
+                }
+            }
+        }
+
+        return found;
+    }
+
+
+    void CompressionCache::insert(ContentCoding coding, const QByteArray& body, const QByteArray& encoded) {
+        if (body.size() <= maximumCachedBodyLength) {
+            unsigned hash = qHash(body);
+
+            QMutexLocker locker(&mutex);
+
+            if (currentCapacity > 0) {
+                entries.prepend(Entry { coding, hash, body, encoded });
+                while (static_cast<unsigned>(entries.size()) > currentCapacity) {
+                    entries.removeLast();
+                }
+            }
+        }
+    }
+}
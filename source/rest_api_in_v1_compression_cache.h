@@ -0,0 +1,141 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::CompressionCache class.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_COMPRESSION_CACHE_H
+#define REST_API_IN_V1_COMPRESSION_CACHE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+
+#include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_content_coding.h"
+
+namespace RestApiInV1 {
+    /**
+     * Class that holds a small, least recently used, set of encoded response bodies so that responses which repeat
+     * are only compressed once.  Entries are matched on the complete body so a hit always returns the right
+     * encoding.  The cache is shared by all workers.
+     */
+    class REST_API_V1_PUBLIC_API CompressionCache {
+        public:
+            /**
+             * The largest body we are willing to cache, in bytes.  Larger bodies are rarely repeated and would
+             * crowd out everything else.
+             */
+            static constexpr int maximumCachedBodyLength = 1048576;
+
+            /**
+             * Constructor
+             *
+             * \param[in] capacity The maximum number of entries to retain.
+             */
+            CompressionCache(unsigned capacity);
+
+            ~CompressionCache();
+
+            /**
+             * Method you can use to change the maximum number of entries to retain.  Least recently used entries are
+             * discarded if the cache is shrunk.
+             *
+             * \param[in] newCapacity The new maximum number of entries.  A value of 0 disables the cache.
+             */
+            void setCapacity(unsigned newCapacity);
+
+            /**
+             * Method you can use to determine the maximum number of entries retained.
+             *
+             * \return Returns the maximum number of entries.
+             */
+            unsigned capacity() const;
+
+            /**
+             * Method you can use to locate a previously encoded body.
+             *
+             * \param[in]  coding  The coding applied to the body.
+             *
+             * \param[in]  body    The body before encoding.
+             *
+             * \param[out] encoded Receives the encoded body on a hit.
+             *
+             * \return Returns true on a hit.  Returns false on a miss.
+             */
+            bool find(ContentCoding coding, const QByteArray& body, QByteArray& encoded);
+
+            /**
+             * Method you can use to add an encoded body to the cache.
+             *
+             * \param[in] coding  The coding applied to the body.
+             *
+             * \param[in] body    The body before encoding.
+             *
+             * \param[in] encoded The encoded body.
+             */
+            void insert(ContentCoding coding, const QByteArray& body, const QByteArray& encoded);
+
+        private:
+            /**
+             * Type used to hold a single cached body.
+             */
+            struct Entry {
+                /**
+                 * The coding applied to the body.
+                 */
+                ContentCoding coding;
+
+                /**
+                 * The hash of the body before encoding.
+                 */
+                unsigned hash;
+
+                /**
+                 * The body before encoding.
+                 */
+                QByteArray body;
+
+                /**
+                 * The encoded body.
+                 */
+                QByteArray encoded;
+            };
+
+            CompressionCache(const CompressionCache& other) = delete;
+            CompressionCache& operator=(const CompressionCache& other) = delete;
+
+            /**
+             * Mutex used to serialize access from the workers.
+             */
+            mutable QMutex mutex;
+
+            /**
+             * The cached entries, most recently used first.
+             */
+            QList<Entry> entries;
+
+            /**
+             * The maximum number of entries to retain.
+             */
+            unsigned currentCapacity;
+    };
+};
+
+#endif
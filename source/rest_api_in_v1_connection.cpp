@@ -24,14 +24,34 @@
 #include <QByteArray>
 #include <QTcpServer>
 #include <QHash>
+#include <QVector>
 #include <QUrl>
+#include <QDeadlineTimer>
+#include <QFile>
+#include <QRandomGenerator>
 
 #include <utility>
+#include <algorithm>
+#include <limits>
 #include <iostream>
+#include <cstring>
+
+#if (defined(Q_OS_LINUX))
+#include <unistd.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+#include <cerrno>
+#endif
 
 #include "rest_api_in_v1_server.h"
 #include "rest_api_in_v1_server_private.h"
 #include "rest_api_in_v1_handler.h"
+#include "rest_api_in_v1_request_parser.h"
+#include "rest_api_in_v1_buffer_pool.h"
+#include "rest_api_in_v1_content_coding.h"
+#include "rest_api_in_v1_compression_cache.h"
+#include "rest_api_in_v1_connection_pool.h"
+#include "rest_api_in_v1_event_thread.h"
 #include "rest_api_in_v1_connection.h"
 
 namespace RestApiInV1 {
@@ -245,34 +265,194 @@ namespace RestApiInV1 {
     const QByteArray Connection::space(" ");
     const QByteArray Connection::newline("\r\n");
     const QByteArray Connection::colon(":");
+    const QVector<QByteArray> Connection::statusLineByStatusCode = Connection::buildStatusLines();
+    const QByteArray Connection::http10String("HTTP/1.0");
+    const QByteArray Connection::http11String("HTTP/1.1");
+    const QByteArray Connection::continueResponse("HTTP/1.1 100 Continue\r\n\r\n");
+    const QByteArray Connection::lastChunk("0\r\n\r\n");
+    const QByteArray Connection::multipartByterangesPrefix("multipart/byteranges; boundary=");
+    const QByteArray Connection::contentRangeBytesPrefix("bytes ");
+    const QByteArray Connection::boundaryDashes("--");
+
+    Connection::ChunkWriter::ChunkWriter(
+            Connection* connection,
+            bool        chunked
+        ):currentConnection(
+            connection
+        ),currentChunked(
+            chunked
+        ) {}
+
+
+    bool Connection::ChunkWriter::writeBodyData(const char* data, unsigned long length) {
+        bool success = true;
+
+        if (static_cast<unsigned long>(pendingData.size()) + length > streamedChunkLength) {
+            success = flush();
+        }
+
+        if (success && length > 0) {
+            if (length >= streamedChunkLength) {
+                success = sendChunk(data, length);
+            } else {
+                pendingData.append(data, static_cast<int>(length));
+            }
+        }
+
+        return success;
+    }
+
+
+    bool Connection::ChunkWriter::finish() {
+        bool success = flush();
+        if (success && currentChunked) {
+            success = currentConnection->sendData(lastChunk);
+        }
+
+        return success;
+    }
+
+
+    bool Connection::ChunkWriter::flush() {
+        bool success = true;
+        if (!pendingData.isEmpty()) {
+            success = sendChunk(pendingData.constData(), static_cast<unsigned long>(pendingData.size()));
+            pendingData.resize(0);
+        }
+
+        return success;
+    }
+
+
+    bool Connection::ChunkWriter::sendChunk(const char* data, unsigned long length) {
+        QByteArray chunkData = QByteArray::fromRawData(data, static_cast<int>(length));
+        bool       success;
+
+        if (currentChunked) {
+            success = (
+                   currentConnection->sendData(QByteArray::number(static_cast<qulonglong>(length), 16) + newline)
+                && currentConnection->sendData(chunkData)
+                && currentConnection->sendData(newline)
+            );
+        } else {
+            success = currentConnection->sendData(chunkData);
+        }
+
+        return success;
+    }
+
+
+    Connection::BodyCollector::BodyCollector(QByteArray& body):currentBody(body) {}
+
+
+    bool Connection::BodyCollector::receiveBodyData(const char* data, unsigned long length) {
+        currentBody.append(data, static_cast<int>(length));
+        return true;
+    }
+
+
+    QVector<QByteArray> Connection::buildStatusLines() {
+        QVector<QByteArray> result(static_cast<int>(statusLineTableSize));
+
+        typedef QHash<Handler::StatusCode, QByteArray> ReasonPhraseHash;
+
+        ReasonPhraseHash::const_iterator reasonIterator    = reasonPhraseByStatusCode.constBegin();
+        ReasonPhraseHash::const_iterator reasonEndIterator = reasonPhraseByStatusCode.constEnd();
+        while (reasonIterator != reasonEndIterator) {
+            unsigned code = static_cast<unsigned>(reasonIterator.key());
+            if (code < statusLineTableSize) {
+                QByteArray line = space + QByteArray::number(code) + space + reasonIterator.value() + newline;
+                result[static_cast<int>(code)] = line;
+            }
+
+            ++reasonIterator;
+        }
+
+        return result;
+    }
+
 
     Connection::Connection(
-            Server::Private*        serverPrivate,
-            qintptr                 socketDescriptor,
-            unsigned                threadId,
-            unsigned long           maximumBufferSize,
-            Server::LoggingFunction loggingFunction,
-            QObject*                parent
+            ConnectionPool*  pool,
+            Server::Private* serverPrivate,
+            unsigned         threadId,
+            unsigned long    maximumBufferSize,
+            QObject*         parent
         ):QThread(
             parent
+        ),currentPool(
+            pool
         ),currentServerPrivate(
             serverPrivate
         ),currentSocketDescriptor(
-            socketDescriptor
+            invalidSocketDescriptor
         ),currentThreadId(
             threadId
         ),currentMaximumBufferSize(
             maximumBufferSize
-        ),bytesAvailable(
+        ),receiveBufferOffset(
+            0
+        ),requestHeadOffset(
+            -1
+        ),requestParser(
+            maximumBufferSize
+        ),requestUriValid(
+            false
+        ),pathValid(
+            false
+        ),httpVersionValid(
+            false
+        ),headersValid(
+            false
+        ),requestBodyRemaining(
+            -1
+        ),requestBodyChunked(
+            false
+        ),chunkedBodyComplete(
+            false
+        ),chunkDataPending(
+            false
+        ),requestBodyMalformed(
+            false
+        ),requestBodyCoding(
+            ContentCoding::IDENTITY
+        ),currentRequestCount(
+            0
+        ),currentKeepAlive(
+            false
+        ),responseStarted(
+            false
+        ),requestTimedOut(
+            false
+        ),continuePending(
+            false
+        ),outboundLimit(
             0
+        ),currentEventThread(
+            nullptr
+        ),currentSocket(
+            nullptr
+        ),currentMethod(
+            Handler::Method::NUMBER_METHODS
+        ),currentHandler(
+            nullptr
+        ),routeReader(
+            serverPrivate->addRouteReader()
+        ),routedPathInHead(
+            true
         ),returnedStatusCode(
             Handler::StatusCode::OK
         ),currentLoggingFunction(
-            loggingFunction
-        ) {}
+            nullptr
+        ) {
+        receiveBuffer.reserve(receiveChunkSize);
+        routeMatch.numberParameters = 0;
+    }
 
 
-    Connection::~Connection() {}
+    Connection::~Connection() {
+        currentServerPrivate->removeRouteReader(routeReader);
+    }
 
 
     unsigned Connection::threadId() const {
@@ -285,321 +465,1973 @@ namespace RestApiInV1 {
             maximumSize = currentMaximumBufferSize;
         }
 
-        unsigned long long spaceRemaining = std::max(0LL, static_cast<long long>(maximumSize - buffer.size()));
+        int  initialSize = buffer.size();
+        bool success     = (sendContinue() && startBodyData() && requestBodyRemaining != 0);
+        if (success) {
+            unsigned long long spaceRemaining = std::max(0LL, static_cast<long long>(maximumSize - buffer.size()));
+            if (requestBodyRemaining >= 0) {
+                // Never read past the end of the body or chunk, the bytes that follow are not body data.
+                spaceRemaining = std::min(spaceRemaining, static_cast<unsigned long long>(requestBodyRemaining));
+            }
 
-        bool success = true;
-        if (bytesAvailable == 0) {
-            success = currentSocket->waitForReadyRead();
-            if (success) {
-                bytesAvailable = currentSocket->bytesAvailable();
-                unsigned long bytesToRead = std::min(bytesAvailable, spaceRemaining);
-                buffer.append(currentSocket->read(bytesToRead));
-                bytesAvailable -= bytesToRead;
+            if (receiveBufferOffset < receiveBuffer.size()) {
+                unsigned long bytesToRead = std::min(
+                    static_cast<unsigned long long>(receiveBuffer.size() - receiveBufferOffset),
+                    spaceRemaining
+                );
+
+                buffer.append(receiveBuffer.constData() + receiveBufferOffset, static_cast<int>(bytesToRead));
+                receiveBufferOffset += static_cast<int>(bytesToRead);
+            } else {
+                // Body data goes straight to the caller rather than through the receive buffer.
+                success = currentSocket->bytesAvailable() > 0 || waitForReadable();
+                if (success) {
+                    unsigned long long bytesAvailable = static_cast<unsigned long long>(
+                        currentSocket->bytesAvailable()
+                    );
+
+                    buffer.append(currentSocket->read(std::min(bytesAvailable, spaceRemaining)));
+                }
+            }
+
+            if (requestBodyRemaining > 0) {
+                requestBodyRemaining -= buffer.size() - initialSize;
             }
-        } else {
-            unsigned long bytesToRead = std::min(bytesAvailable, spaceRemaining);
-            buffer.append(currentSocket->read(bytesToRead));
-            bytesAvailable -= bytesToRead;
         }
 
         return success;
     }
 
 
-    QByteArray Connection::readLine(unsigned long maximumSize, bool* ok) {
-        QByteArray result;
-        char       lastCharacter        = 0;
-        bool       success              = true;
-        bool       lastWasCarrageReturn = false;
+    bool Connection::readData(char* buffer, unsigned long long bufferSize, unsigned long long& bytesRead) {
+        bytesRead = 0;
 
-        if (maximumSize == 0) {
-            maximumSize = currentMaximumBufferSize;
-        }
+        bool success = (bufferSize > 0 && sendContinue() && startBodyData() && requestBodyRemaining != 0);
+        if (success) {
+            unsigned long long spaceRemaining = bufferSize;
+            if (requestBodyRemaining >= 0) {
+                spaceRemaining = std::min(spaceRemaining, static_cast<unsigned long long>(requestBodyRemaining));
+            }
 
-        while (success && lastCharacter != '\n' && static_cast<unsigned long>(result.size()) < maximumSize) {
-            if (bytesAvailable == 0) {
-                success = currentSocket->waitForReadyRead();
+            if (receiveBufferOffset < receiveBuffer.size()) {
+                bytesRead = std::min(
+                    static_cast<unsigned long long>(receiveBuffer.size() - receiveBufferOffset),
+                    spaceRemaining
+                );
+
+                std::memcpy(buffer, receiveBuffer.constData() + receiveBufferOffset, static_cast<size_t>(bytesRead));
+                receiveBufferOffset += static_cast<int>(bytesRead);
+            } else {
+                success = currentSocket->bytesAvailable() > 0 || waitForReadable();
                 if (success) {
-                    bytesAvailable = currentSocket->bytesAvailable();
-                    success = currentSocket->getChar(&lastCharacter);
+                    qint64 socketBytesRead = currentSocket->read(buffer, static_cast<qint64>(spaceRemaining));
+                    if (socketBytesRead > 0) {
+                        bytesRead = static_cast<unsigned long long>(socketBytesRead);
+                    } else {
+                        success = false;
+                    }
                 }
-            } else {
-                success = currentSocket->getChar(&lastCharacter);
             }
 
+            if (requestBodyRemaining > 0) {
+                requestBodyRemaining -= static_cast<long long>(bytesRead);
+            }
+        }
+
+        return success;
+    }
+
+
+    bool Connection::readBody(QByteArray& body, unsigned long long maximumSize) {
+        if (maximumSize == 0 && currentHandler != nullptr) {
+            maximumSize = currentHandler->maximumBodySize();
+        }
+
+        // A QByteArray can not hold more than this regardless of the limit we were given.
+        unsigned long long storageLimit = static_cast<unsigned long long>(std::numeric_limits<int>::max());
+        if (maximumSize == 0 || maximumSize > storageLimit) {
+            maximumSize = storageLimit;
+        }
+
+        bool success;
+        if (requestBodyCoding != ContentCoding::IDENTITY) {
+            // The decoded length is unknown until the body has been decoded so the body grows as data arrives.
+            QByteArray    decodedBody;
+            BodyCollector collector(decodedBody);
+
+            success = readBody(collector, maximumSize);
             if (success) {
-                if (lastCharacter != '\n' && lastCharacter != '\r') {
-                    if (lastWasCarrageReturn) {
-                        result.append('\r');
-                        lastWasCarrageReturn = false;
-                    }
+                body = decodedBody;
+            }
+        } else if (!requestBodyChunked && requestBodyRemaining > 0) {
+            unsigned long long bodySize = static_cast<unsigned long long>(requestBodyRemaining);
 
-                    result.append(lastCharacter);
-                } else if (lastCharacter == '\r') {
-                    lastWasCarrageReturn = true;
+            success = checkBodySize(bodySize, maximumSize);
+            if (success) {
+                currentPool->bufferPool().release(pooledBody);
+                pooledBody = currentPool->bufferPool().acquire(static_cast<unsigned long>(bodySize));
+                pooledBody.resize(static_cast<int>(bodySize));
+
+                char*              data          = pooledBody.data();
+                unsigned long long bytesReceived = 0;
+                while (success && bytesReceived < bodySize) {
+                    unsigned long long bytesRead;
+                    success = readData(data + bytesReceived, bodySize - bytesReceived, bytesRead);
+                    bytesReceived += bytesRead;
                 }
 
-                --bytesAvailable;
+                if (success) {
+                    body = pooledBody;
+                }
+            }
+        } else if (!requestBodyChunked && requestBodyRemaining == 0) {
+            success = true;
+            body.clear();
+        } else {
+            // Chunked bodies, and bodies that run until the connection closes, have no length up front so we can only
+            // enforce the limit as the data arrives.  Decoded chunk data lands directly in the body.
+            QByteArray receivedData;
+            bool       withinLimit = true;
+            while (withinLimit && readData(receivedData, receivedData.size() + currentMaximumBufferSize)) {
+                withinLimit = checkBodySize(static_cast<unsigned long long>(receivedData.size()), maximumSize);
             }
-        }
 
-        if (ok != nullptr) {
-            *ok = success;
+            success = withinLimit && !requestTimedOut && (!requestBodyChunked || chunkedBodyComplete);
+            if (success) {
+                body = receivedData;
+            }
         }
 
-        return result;
+        return success;
     }
 
 
-    bool Connection::sendResponseHeader(Handler::StatusCode statusCode, const Handler::Headers& responseHeaders) {
-        const QByteArray& reasonPhrase = reasonPhraseByStatusCode.value(statusCode, defaultReasonPhrase);
-
-        // Send the status line.
-        bool success = (
-               sendData(currentHttpVersion.toUtf8())
-            && sendData(space)
-            && sendData(QByteArray::number(static_cast<unsigned>(statusCode)))
-            && sendData(space)
-            && sendData(reasonPhrase)
-            && sendData(newline)
-        );
-
-        // And then the headers.
-        Handler::Headers::const_iterator headerIterator    = responseHeaders.constBegin();
-        Handler::Headers::const_iterator headerEndIterator = responseHeaders.constEnd();
-        while (success && headerIterator != headerEndIterator) {
-            success = (
-                   sendData(headerIterator.key())
-                && sendData(colon)
-                && sendData(headerIterator.value())
-                && sendData(newline)
-            );
-            ++headerIterator;
+    bool Connection::readBody(BodyReceiver& receiver, unsigned long long maximumSize) {
+        // Nothing is stored on our side so only the caller's or handler's limit applies.
+        if (maximumSize == 0 && currentHandler != nullptr) {
+            maximumSize = currentHandler->maximumBodySize();
         }
 
-        // A blank line indicates the end of the header.
-        success = success && sendData(newline);
+        bool success;
+        if (requestBodyCoding == ContentCoding::IDENTITY) {
+            success = readEncodedBody(receiver, maximumSize);
+        } else {
+            // Small bodies can decode to very large ones so the decoded body is held to the server's limit as well.
+            unsigned long long decodedLimit = currentServerPrivate->maximumDecodedBodySize();
+            if (decodedLimit == 0 || (maximumSize != 0 && maximumSize < decodedLimit)) {
+                decodedLimit = maximumSize;
+            }
 
-        returnedStatusCode = statusCode;
+            ContentDecoder decoder(requestBodyCoding, receiver, decodedLimit);
+            success = readEncodedBody(decoder, maximumSize) && decoder.finish();
+
+            if (!success && !responseStarted) {
+                if (decoder.limitExceeded()) {
+                    checkBodySize(decoder.decodedLength(), decodedLimit);
+                } else if (decoder.malformed()) {
+                    sendFailedResponse(Handler::StatusCode::BAD_REQUEST);
+                    currentServerPrivate->sessionError(QString("Malformed encoded request body: %1").arg(path()));
+                }
+            }
+        }
 
         return success;
     }
 
 
-    bool Connection::sendFailedResponse(Handler::StatusCode statusCode) {
-        QByteArray body(
-            "<html>"
-              "<head>"
-                "<title>{{ status_code }} {{ reason_phrase }}</title>"
-              "</head>"
-              "<body>"
-                "<p align=\"center\">{{ status_code }} {{ reason_phrase }}</p>"
-              "</body>"
-            "</html>\n"
-        );
+    bool Connection::readEncodedBody(BodyReceiver& receiver, unsigned long long maximumSize) {
+        bool success = sendContinue();
+        if (success && !requestBodyChunked && requestBodyRemaining > 0) {
+            success = checkBodySize(static_cast<unsigned long long>(requestBodyRemaining), maximumSize);
+        }
 
-        const QByteArray& reasonPhrase = reasonPhraseByStatusCode.value(statusCode, defaultReasonPhrase);
-        body = body.replace("{{ status_code }}", QByteArray::number(static_cast<unsigned>(statusCode)))
-                   .replace("{{ reason_phrase }}", reasonPhrase);
+        unsigned long long bytesReceived = 0;
+        bool               bodyComplete  = false;
+        while (success && !bodyComplete) {
+            success = startBodyData();
+            if (!success || requestBodyRemaining == 0) {
+                bodyComplete = true;
+            } else if (receiveBufferOffset < receiveBuffer.size()) {
+                // Hand out data where it landed so the body is never copied on our side.
+                unsigned long long bytesAvailable = static_cast<unsigned long long>(
+                    receiveBuffer.size() - receiveBufferOffset
+                );
+
+                if (requestBodyRemaining >= 0) {
+                    bytesAvailable = std::min(bytesAvailable, static_cast<unsigned long long>(requestBodyRemaining));
+                }
 
-        Handler::Headers headers;
-        headers.insert(Handler::contentLengthString, QByteArray::number(body.size()));
-        headers.insert(Handler::contentTypeString, Handler::textHtmlString);
-        headers.insert(Handler::connectionString, Handler::connectionCloseString);
+                bytesReceived += bytesAvailable;
+                if (requestBodyRemaining < 0 || requestBodyChunked) {
+                    success = checkBodySize(bytesReceived, maximumSize);
+                }
 
-        return sendResponseHeader(statusCode, headers) && sendData(body);
-    }
+                if (success) {
+                    const char* data = receiveBuffer.constData() + receiveBufferOffset;
+                    receiveBufferOffset += static_cast<int>(bytesAvailable);
+
+                    if (requestBodyRemaining > 0) {
+                        requestBodyRemaining -= static_cast<long long>(bytesAvailable);
+                    }
 
+                    success = receiver.receiveBodyData(data, static_cast<unsigned long>(bytesAvailable));
+                }
+            } else if (!fillReceiveBuffer()) {
+                // A body without a known length runs until the client closes the connection.
+                success      = (requestBodyRemaining < 0 && !requestTimedOut);
+                bodyComplete = true;
+            }
+        }
 
-    bool Connection::sendData(const QByteArray& data) {
-        return currentSocket->write(data) == data.size();
+        return success;
     }
 
 
-    const QUrl& Connection::requestUri() const {
-        return currentRequestUri;
-    }
+    QByteArray Connection::readLine(unsigned long maximumSize, bool* ok) {
+        if (maximumSize == 0) {
+            maximumSize = currentMaximumBufferSize;
+        }
 
+        QByteArray  result;
+        const char* line;
+        int         lineLength;
+        bool        terminated;
 
-    Handler::Method Connection::method() const {
-        return currentMethod;
-    }
+        bool success = nextLine(maximumSize, line, lineLength, terminated);
+        if (success) {
+            result = QByteArray(line, lineLength);
+
+            // A line in a chunked body can straddle chunks.  The pieces are joined unless the body ends first.
+            bool joined  = false;
+            bool joining = !terminated && requestBodyChunked;
+            while (joining) {
+                success = startBodyData();
+                joining = (
+                       success
+                    && requestBodyRemaining > 0
+                    && static_cast<unsigned long>(result.size()) < maximumSize
+                );
+
+                if (joining) {
+                    unsigned long spaceRemaining = maximumSize - static_cast<unsigned long>(result.size());
+                    success = nextLine(spaceRemaining, line, lineLength, terminated);
+                    if (success) {
+                        result.append(line, lineLength);
+                        joined = true;
+                    }
 
+                    joining = success && !terminated;
+                }
+            }
 
-    const QString& Connection::httpVersion() const {
-        return currentHttpVersion;
-    }
+            if (joined && terminated && result.endsWith('\r')) {
+                // The carriage return ended the previous chunk.
+                result.chop(1);
+            }
+        }
 
+        if (ok != nullptr) {
+            *ok = success;
+        }
 
-    const Handler::Headers& Connection::headers() const {
-        return currentHeaders;
+        return result;
     }
 
 
-    void Connection::startSession(qintptr socketDescriptor) {
-        currentSocketDescriptor = socketDescriptor;
-        currentSessionSemaphore.release(1);
+    bool Connection::sendResponseHeader(Handler::StatusCode statusCode, const Handler::Headers& responseHeaders) {
+        QByteArray response = buildResponseHead(statusCode, responseHeaders, -1, 0);
+        return sendData(response);
     }
 
 
-    void Connection::run() {
-        QTcpSocket socket;
-        bool success = socket.setSocketDescriptor(currentSocketDescriptor);
-        if (success) {
-            currentSocket = &socket;
-            processRequest();
+    bool Connection::sendResponse(
+            Handler::StatusCode     statusCode,
+            const Handler::Headers& responseHeaders,
+            const QByteArray&       body
+        ) {
+        bool success;
+
+        Handler::Headers    rangedHeaders;
+        BodySegments        segments;
+        QByteArray          closingDelimiter;
+        QByteArray          encodedBody;
+        Handler::StatusCode rangedStatusCode = statusCode;
+
+        // Compressed bodies never advertise ranges so only one of the two transformations applies.
+        bool encoded = encodeResponse(statusCode, responseHeaders, body, rangedHeaders, encodedBody);
+        if (!encoded) {
+            rangedStatusCode = selectRanges(
+                statusCode,
+                responseHeaders,
+                static_cast<unsigned long long>(body.size()),
+                rangedHeaders,
+                segments,
+                closingDelimiter
+            );
+        }
 
-            socket.disconnectFromHost();
-            if (socket.state() != QTcpSocket::SocketState::UnconnectedState) {
-                socket.waitForDisconnected();
-            }
+        if (encoded) {
+            success = sendCompleteResponse(statusCode, rangedHeaders, encodedBody);
+        } else if (rangedStatusCode == statusCode) {
+            success = sendCompleteResponse(statusCode, rangedHeaders, body);
         } else {
-            currentServerPrivate->sessionError(
-                QString("Could not bind to socket: %1").arg(socket.errorString())
-            );
+            QByteArray rangedBody;
+            for (const BodySegment& segment : segments) {
+                rangedBody.append(segment.prefix);
+                rangedBody.append(body.constData() + segment.offset, static_cast<int>(segment.length));
+            }
+
+            rangedBody.append(closingDelimiter);
+
+            success = sendCompleteResponse(rangedStatusCode, rangedHeaders, rangedBody);
         }
-    }
 
+        return success;
+    }
 
-    void Connection::processRequest() {
-        bool         success;
-        QByteArray   requestLine     = readLine(0, &success);
-        if (success) {
-            QList<QByteArray> requestLineParts = requestLine.split(' ');
-            unsigned          numberParts      = static_cast<unsigned>(requestLineParts.size());
-
-            if (numberParts >= 3) {
-                const QByteArray* methodString     = nullptr;
-                const QByteArray* requestUriString = nullptr;
-                const QByteArray* httpVersion      = nullptr;
-
-                unsigned nextField = 0;
-                unsigned index     = 0;
-                while (success && index<numberParts) {
-                    const QByteArray& field = requestLineParts.at(index);
-                    if (field.size() > 0) {
-                        if (nextField == 0) {
-                            methodString = &field;
-                        } else if (nextField == 1) {
-                            requestUriString = &field;
-                        } else if (nextField == 2) {
-                            httpVersion = &field;
-                        } else {
-                            success = false;
-                            sendFailedResponse(Handler::StatusCode::BAD_REQUEST);
 
-                            QString message = QString("Malformed HTTP request line: %1")
-                                              .arg(QString::fromUtf8(requestLine));
+    bool Connection::encodeResponse(
+            Handler::StatusCode     statusCode,
+            const Handler::Headers& responseHeaders,
+            const QByteArray&       body,
+            Handler::Headers&       encodedHeaders,
+            QByteArray&             encodedBody
+        ) {
+        bool success = (
+               currentHandler != nullptr
+            && statusCode == Handler::StatusCode::OK
+            && static_cast<unsigned long>(body.size()) >= currentServerPrivate->responseCompressionThreshold()
+            && currentHandler->compressResponses()
+            && !responseHeaders.contains(Handler::contentEncodingString)
+            && !containsToken(responseHeaders.value(Handler::acceptRangesString), Handler::acceptRangesBytesString)
+        );
 
-                            writeLog(message, false);
-                            currentServerPrivate->sessionError(message);
-                        }
+        if (success) {
+            ContentCoding coding = selectContentCoding(header(Handler::acceptEncodingString));
+            success = (coding != ContentCoding::IDENTITY);
 
-                        ++nextField;
+            if (success) {
+                CompressionCache& cache = currentServerPrivate->compressionCache();
+                if (!cache.find(coding, body, encodedBody)) {
+                    success = encodeContent(coding, body, encodedBody);
+                    if (success) {
+                        cache.insert(coding, body, encodedBody);
                     }
-
-                    ++index;
                 }
 
-                if (success && nextField < 3) {
-                    success = false;
-                    sendFailedResponse(Handler::StatusCode::BAD_REQUEST);
+                // Incompressible data is sent as is rather than paying for the client to decode it.
+                success = success && encodedBody.size() < body.size();
+            }
 
-                    QString message = QString("Malformed HTTP request line: %1").arg(QString::fromUtf8(requestLine));
-                    writeLog(message, false);
-                    currentServerPrivate->sessionError(message);
+            if (success) {
+                encodedHeaders = responseHeaders;
+                encodedHeaders.insert(Handler::contentEncodingString, contentCodingName(coding));
+
+                QByteArray vary = responseHeaders.value(Handler::varyString);
+                if (vary.isEmpty()) {
+                    encodedHeaders.insert(Handler::varyString, Handler::acceptEncodingString);
+                } else if (!containsToken(vary, Handler::acceptEncodingString)) {
+                    encodedHeaders.insert(Handler::varyString, vary + ", " + Handler::acceptEncodingString);
                 }
 
-                if (success) {
-                    currentRequestUri.setUrl(QString::fromUtf8(*requestUriString));
-                    currentMethod      = toMethod(*methodString);
-                    currentHttpVersion = QString::fromUtf8(*httpVersion);
+                // The encoded body is a different representation so a strong entity tag no longer applies.
+                QByteArray entityTag = responseHeaders.value(Handler::etagString);
+                if (entityTag.startsWith('"')) {
+                    encodedHeaders.insert(Handler::etagString, "W/" + entityTag);
+                }
+            } else {
+                encodedBody.clear();
+            }
+        }
 
-                    currentHeaders.clear();
-                    QByteArray receivedHeader;
-                    do {
-                        receivedHeader = readLine(0, &success).trimmed();
-                        if (!success) {
-                            QString message = QString("Falied to read content: %1").arg(currentSocket->errorString());
+        return success;
+    }
 
-                            sendFailedResponse(Handler::StatusCode::BAD_REQUEST);
 
-                            writeLog(message, false);
-                            currentServerPrivate->sessionError(message);
-                        }
+    bool Connection::sendCompleteResponse(
+            Handler::StatusCode     statusCode,
+            const Handler::Headers& responseHeaders,
+            const QByteArray&       body
+        ) {
+        bool success;
 
-                        if (success && !receivedHeader.isEmpty()) {
-                            int splitIndex = receivedHeader.indexOf(':');
-                            if (splitIndex >= 0) {
-                                QByteArray headerName  = receivedHeader.left(splitIndex);
-                                QByteArray headerValue = receivedHeader.mid(splitIndex + 1);
-                                currentHeaders.insert(headerName.toLower(), headerValue.trimmed());
-                            } else {
-                                currentHeaders.insert(receivedHeader, QByteArray());
-                            }
-                        }
-                    } while (success && !receivedHeader.isEmpty());
+        if (bodylessResponse(statusCode)) {
+            // The head still reports the length of the body a GET would have received.
+            success = sendData(buildResponseHead(statusCode, responseHeaders, body.size(), 0));
+        } else if (static_cast<unsigned long>(body.size()) <= maximumCoalescedBodyLength) {
+            // Small bodies ride along with the head so the whole response goes out in a single write.
+            QByteArray response = buildResponseHead(statusCode, responseHeaders, body.size(), body.size());
+            response.append(body);
 
-                    if (success) {
-                        QString  path    = currentRequestUri.path();
-                        Handler* handler = currentServerPrivate->handler(currentMethod, path);
+            success = sendData(response);
+        } else {
+            QByteArray response = buildResponseHead(statusCode, responseHeaders, body.size(), 0);
+            success = sendData(response) && sendData(body);
+        }
 
-                        if (handler != nullptr) {
-                            handler->session(*this);
-                            writeLog(path, false);
-                        } else {
-                            // When we're behind a proxy, we lose our host and scheme which screws up the path calculation above.  We address that here.
+        return success;
+    }
 
-                            QString host = currentRequestUri.host();
-                            path    = QString("/") + host + path;
-                            handler = currentServerPrivate->handler(currentMethod, path);
 
-                            if (handler != nullptr) {
-                                handler->session(*this);
-                            } else {
-                                success = false;
-                                sendFailedResponse(Handler::StatusCode::NOT_FOUND);
+    bool Connection::sendStreamedResponse(
+            Handler::StatusCode     statusCode,
+            const Handler::Headers& responseHeaders,
+            BodyGenerator&          generator
+        ) {
+        // Only HTTP/1.1 clients are required to understand chunked encoding.
+        bool chunked = spanEquals(requestParser.version(), http11String);
 
-                                QString message = QString("Invalid URI: %1").arg(QString::fromUtf8(*requestUriString));
-                                writeLog(message, false);
-                                currentServerPrivate->sessionError(message);
-                            }
-                        }
+        Handler::Headers headers = responseHeaders;
+        headers.remove(Handler::contentLengthString);
+        if (chunked) {
+            headers.insert(Handler::transferEncodingString, Handler::transferEncodingChunkedString);
+        } else {
+            headers.remove(Handler::transferEncodingString);
+        }
 
-                    }
-                }
-            } else {
-                sendFailedResponse(Handler::StatusCode::BAD_REQUEST);
+        // Generating the body can take far longer than receiving the request did so only the request deadline
+        // applies from here on.
+        phaseDeadline = QDeadlineTimer(QDeadlineTimer::Forever);
 
-                QString message = QString("Malformed HTTP request line: %1").arg(QString::fromUtf8(requestLine));
-                writeLog(message, false);
-                currentServerPrivate->sessionError(message);
+        bool success = sendData(buildResponseHead(statusCode, headers, -1, 0));
 
-                success = false;
+        if (success && !bodylessResponse(statusCode)) {
+            ChunkWriter writer(this, chunked);
+            success = generator.generateBody(writer) && writer.finish();
+
+            if (!success) {
+                // Without the last chunk the client can tell the body is incomplete.
+                currentKeepAlive = false;
             }
-        } else {
-            QString message = QString("Falied to read content: %1").arg(currentSocket->errorString());
+        }
 
-            sendFailedResponse(Handler::StatusCode::BAD_REQUEST);
+        return success;
+    }
 
-            writeLog(message, false);
-            currentServerPrivate->sessionError(message);
 
-            success = false;
+    bool Connection::sendFileResponse(
+            Handler::StatusCode     statusCode,
+            const Handler::Headers& responseHeaders,
+            int                     fileDescriptor,
+            unsigned long long      offset,
+            unsigned long long      length
+        ) {
+        Handler::Headers    headers;
+        BodySegments        segments;
+        QByteArray          closingDelimiter;
+        Handler::StatusCode rangedStatusCode = selectRanges(
+            statusCode,
+            responseHeaders,
+            length,
+            headers,
+            segments,
+            closingDelimiter
+        );
+
+        headers.remove(Handler::transferEncodingString);
+
+        unsigned long long contentLength = static_cast<unsigned long long>(closingDelimiter.size());
+        for (const BodySegment& segment : segments) {
+            contentLength += static_cast<unsigned long long>(segment.prefix.size()) + segment.length;
         }
-    }
 
+        // Large files can take far longer to send than the request took to receive so only the request deadline
+        // applies from here on.
+        phaseDeadline = QDeadlineTimer(QDeadlineTimer::Forever);
 
-    void Connection::writeLog(const QString& message, bool error) const {
+        bool success = sendData(
+            buildResponseHead(rangedStatusCode, headers, static_cast<long long>(contentLength), 0)
+        );
+
+        if (success && !bodylessResponse(rangedStatusCode)) {
+            BodySegments::const_iterator segmentIterator    = segments.constBegin();
+            BodySegments::const_iterator segmentEndIterator = segments.constEnd();
+            while (success && segmentIterator != segmentEndIterator) {
+                const BodySegment& segment = *segmentIterator;
+
+                if (!segment.prefix.isEmpty()) {
+                    success = sendData(segment.prefix);
+                }
+
+                if (success && segment.length > 0) {
+                    success = sendFileRange(fileDescriptor, offset + segment.offset, segment.length);
+                }
+
+                ++segmentIterator;
+            }
+
+            if (success && !closingDelimiter.isEmpty()) {
+                success = sendData(closingDelimiter);
+            }
+
+            if (!success) {
+                // The client can only tell the body is short if we close the connection.
+                currentKeepAlive = false;
+            }
+        }
+
+        return success;
+    }
+
+
+    Handler::StatusCode Connection::selectRanges(
+            Handler::StatusCode     statusCode,
+            const Handler::Headers& responseHeaders,
+            unsigned long long      bodyLength,
+            Handler::Headers&       rangedHeaders,
+            BodySegments&           segments,
+            QByteArray&             closingDelimiter
+        ) const {
+        Handler::StatusCode result = statusCode;
+
+        rangedHeaders = responseHeaders;
+        segments.clear();
+        closingDelimiter.clear();
+
+        // Successful responses advertise byte ranges unless the handler says otherwise, for example with
+        // "Accept-Ranges: none".
+        bool advertised;
+        if (responseHeaders.contains(Handler::acceptRangesString)) {
+            advertised = containsToken(
+                responseHeaders.value(Handler::acceptRangesString),
+                Handler::acceptRangesBytesString
+            );
+        } else {
+            advertised = (
+                   statusCode == Handler::StatusCode::OK
+                && (currentMethod == Handler::Method::GET || currentMethod == Handler::Method::HEAD)
+            );
+
+            if (advertised) {
+                rangedHeaders.insert(Handler::acceptRangesString, Handler::acceptRangesBytesString);
+            }
+        }
+
+        // Ranges are only defined for GET.
+        QByteArray range;
+        bool       rangesApply = (
+               advertised
+            && statusCode == Handler::StatusCode::OK
+            && currentMethod == Handler::Method::GET
+        );
+
+        if (rangesApply) {
+            range = header(Handler::rangeString);
+            if (!range.isEmpty()) {
+                // If the client's partial copy is stale, it needs the whole body.
+                QByteArray ifRange = header(Handler::ifRangeString);
+                rangesApply = (ifRange.isEmpty() || ifRangeMatches(ifRange, responseHeaders));
+            }
+        }
+
+        if (rangesApply && !range.isEmpty() && parseRanges(range, bodyLength, segments)) {
+            if (segments.isEmpty()) {
+                result = Handler::StatusCode::REQUESTED_RANGE_NOT_SATISFIABLE;
+
+                rangedHeaders.remove(Handler::contentTypeString);
+                rangedHeaders.insert(
+                    Handler::contentRangeString,
+                    contentRangeBytesPrefix + "*/" + QByteArray::number(bodyLength)
+                );
+            } else if (segments.size() == 1) {
+                result = Handler::StatusCode::PARTIAL_CONTENT;
+                rangedHeaders.insert(Handler::contentRangeString, contentRange(segments.first(), bodyLength));
+            } else {
+                result = Handler::StatusCode::PARTIAL_CONTENT;
+
+                QByteArray boundary        = QByteArray::number(QRandomGenerator::global()->generate64(), 16);
+                QByteArray partContentType = responseHeaders.value(Handler::contentTypeString);
+
+                rangedHeaders.insert(Handler::contentTypeString, multipartByterangesPrefix + boundary);
+
+                for (BodySegment& segment : segments) {
+                    QByteArray& prefix = segment.prefix;
+                    prefix.append(newline);
+                    prefix.append(boundaryDashes);
+                    prefix.append(boundary);
+                    prefix.append(newline);
+
+                    if (!partContentType.isEmpty()) {
+                        prefix.append(Handler::contentTypeString);
+                        prefix.append(colon);
+                        prefix.append(partContentType);
+                        prefix.append(newline);
+                    }
+
+                    prefix.append(Handler::contentRangeString);
+                    prefix.append(colon);
+                    prefix.append(contentRange(segment, bodyLength));
+                    prefix.append(newline);
+                    prefix.append(newline);
+                }
+
+                closingDelimiter = newline + boundaryDashes + boundary + boundaryDashes + newline;
+            }
+        } else {
+            segments.clear();
+            segments.append(BodySegment { QByteArray(), 0, bodyLength });
+        }
+
+        return result;
+    }
+
+
+    bool Connection::parseRanges(const QByteArray& value, unsigned long long bodyLength, BodySegments& ranges) {
+        ranges.clear();
+
+        int  unitEnd = value.indexOf('=');
+        bool success = (
+               unitEnd > 0
+            && value.left(unitEnd).trimmed().toLower() == Handler::acceptRangesBytesString
+        );
+
+        if (success) {
+            QList<QByteArray> specifiers       = value.mid(unitEnd + 1).split(',');
+            int               numberSpecifiers = specifiers.size();
+            int               index            = 0;
+
+            success = (numberSpecifiers <= maximumRangeCount);
+            while (success && index < numberSpecifiers) {
+                QByteArray specifier = specifiers.at(index).trimmed();
+
+                // Empty list elements are allowed and ignored.
+                if (!specifier.isEmpty()) {
+                    int dash = specifier.indexOf('-');
+                    success = (dash >= 0);
+
+                    if (success) {
+                        QByteArray firstText = specifier.left(dash);
+                        QByteArray lastText  = specifier.mid(dash + 1);
+
+                        if (firstText.isEmpty()) {
+                            // A suffix range asks for the last N bytes.
+                            unsigned long long suffixLength;
+                            success = parseBytePosition(lastText, suffixLength);
+                            if (success && suffixLength > 0 && bodyLength > 0) {
+                                if (suffixLength > bodyLength) {
+                                    suffixLength = bodyLength;
+                                }
+
+                                ranges.append(BodySegment { QByteArray(), bodyLength - suffixLength, suffixLength });
+                            }
+                        } else {
+                            unsigned long long first;
+                            unsigned long long last = bodyLength;
+                            success = (
+                                   parseBytePosition(firstText, first)
+                                && (lastText.isEmpty() || (parseBytePosition(lastText, last) && last >= first))
+                            );
+
+                            if (success && first < bodyLength) {
+                                if (last >= bodyLength) {
+                                    last = bodyLength - 1;
+                                }
+
+                                ranges.append(BodySegment { QByteArray(), first, last - first + 1 });
+                            }
+                        }
+                    }
+                }
+
+                ++index;
+            }
+        }
+
+        if (success && ranges.size() > 1) {
+            std::sort(
+                ranges.begin(),
+                ranges.end(),
+                [](const BodySegment& a, const BodySegment& b) {
+                    return a.offset < b.offset;
+                }
+            );
+
+            int numberMerged = 1;
+            int numberRanges = ranges.size();
+            for (int index=1 ; index<numberRanges ; ++index) {
+                BodySegment&       previous = ranges[numberMerged - 1];
+                const BodySegment& current  = ranges.at(index);
+
+                unsigned long long previousEnd = previous.offset + previous.length;
+                if (current.offset <= previousEnd) {
+                    unsigned long long currentEnd = current.offset + current.length;
+                    if (currentEnd > previousEnd) {
+                        previous.length = currentEnd - previous.offset;
+                    }
+                } else {
+                    ranges[numberMerged] = current;
+                    ++numberMerged;
+                }
+            }
+
+            ranges.resize(numberMerged);
+        } else if (!success) {
+            ranges.clear();
+        }
+
+        return success;
+    }
+
+
+    bool Connection::parseBytePosition(const QByteArray& value, unsigned long long& position) {
+        int  length  = value.size();
+        bool success = (length > 0 && length <= maximumBytePositionDigits);
+        int  index   = 0;
+
+        while (success && index < length) {
+            success = (value.at(index) >= '0' && value.at(index) <= '9');
+            ++index;
+        }
+
+        if (success) {
+            position = value.toULongLong(&success);
+        }
+
+        return success;
+    }
+
+
+    bool Connection::ifRangeMatches(const QByteArray& validator, const Handler::Headers& responseHeaders) {
+        bool result;
+
+        if (validator.startsWith('"')) {
+            // Only strong entity tags can be used to join ranges.
+            result = (validator == responseHeaders.value(Handler::etagString));
+        } else {
+            QByteArray lastModified = responseHeaders.value(Handler::lastModifiedString);
+            result = (!lastModified.isEmpty() && validator == lastModified);
+        }
+
+        return result;
+    }
+
+
+    QByteArray Connection::contentRange(const BodySegment& range, unsigned long long bodyLength) {
+        return (
+              contentRangeBytesPrefix
+            + QByteArray::number(range.offset)
+            + "-"
+            + QByteArray::number(range.offset + range.length - 1)
+            + "/"
+            + QByteArray::number(bodyLength)
+        );
+    }
+
+
+    QByteArray Connection::statusLine(Handler::StatusCode statusCode) {
+        unsigned   code = static_cast<unsigned>(statusCode);
+        QByteArray result;
+        if (code < static_cast<unsigned>(statusLineByStatusCode.size())) {
+            result = statusLineByStatusCode.at(code);
+        }
+
+        if (result.isEmpty()) {
+            result = space + QByteArray::number(code) + space + defaultReasonPhrase + newline;
+        }
+
+        return result;
+    }
+
+
+    QByteArray Connection::closingResponse(Handler::StatusCode statusCode) {
+        return (
+              http11String
+            + statusLine(statusCode)
+            + Handler::contentLengthString + colon + QByteArray("0") + newline
+            + Handler::connectionString + colon + Handler::connectionCloseString + newline
+            + newline
+        );
+    }
+
+
+    QByteArray Connection::buildResponseHead(
+            Handler::StatusCode     statusCode,
+            const Handler::Headers& responseHeaders,
+            long long               contentLength,
+            int                     reservedBodyLength
+        ) {
+        // The connection can only be reused if the client can find the end of this response and we can find the
+        // start of the next request.
+        if (currentKeepAlive) {
+            bool bodyless = bodylessResponse(statusCode);
+
+            bool framedByHeaders = (
+                   responseHeaders.contains(Handler::contentLengthString)
+                || containsToken(
+                       responseHeaders.value(Handler::transferEncodingString),
+                       Handler::transferEncodingChunkedString
+                   )
+            );
+
+            if (containsToken(responseHeaders.value(Handler::connectionString), Handler::connectionCloseString)) {
+                currentKeepAlive = false;
+            } else if (!bodyless && contentLength < 0 && !framedByHeaders) {
+                currentKeepAlive = false;
+            } else if (requestBodyRemaining > static_cast<long long>(maximumDrainLength)) {
+                currentKeepAlive = false;
+            } else if (requestBodyChunked && !chunkedBodyComplete) {
+                // There is no telling how much of a chunked body is left to drain.
+                currentKeepAlive = false;
+            } else if (continuePending) {
+                // The client may or may not send the body it held back so we can not find the next request.
+                currentKeepAlive = false;
+            }
+        }
+
+        responseStarted    = true;
+        returnedStatusCode = statusCode;
+
+        QByteArray version = responseVersion();
+        QByteArray status  = statusLine(statusCode);
+
+        // Size the buffer up front so the head is assembled with a single allocation.
+        int responseLength = version.size() + status.size() + responseHeadSlack + reservedBodyLength;
+
+        Handler::Headers::const_iterator headerIterator    = responseHeaders.constBegin();
+        Handler::Headers::const_iterator headerEndIterator = responseHeaders.constEnd();
+        while (headerIterator != headerEndIterator) {
+            responseLength += headerIterator.key().size() + headerIterator.value().size() + 3;
+            ++headerIterator;
+        }
+
+        QByteArray response;
+        response.reserve(responseLength);
+
+        response.append(version);
+        response.append(status);
+
+        headerIterator = responseHeaders.constBegin();
+        while (headerIterator != headerEndIterator) {
+            const QByteArray& headerName = headerIterator.key();
+            if (headerName != Handler::connectionString                                   &&
+                (contentLength < 0 || headerName != Handler::contentLengthString)    ) {
+                response.append(headerName);
+                response.append(colon);
+                response.append(headerIterator.value());
+                response.append(newline);
+            }
+
+            ++headerIterator;
+        }
+
+        if (contentLength >= 0) {
+            response.append(Handler::contentLengthString);
+            response.append(colon);
+            response.append(QByteArray::number(contentLength));
+            response.append(newline);
+        }
+
+        response.append(Handler::connectionString);
+        response.append(colon);
+        if (currentKeepAlive) {
+            response.append(Handler::connectionKeepAliveString);
+        } else {
+            response.append(Handler::connectionCloseString);
+        }
+
+        // A blank line indicates the end of the header.
+        response.append(newline);
+        response.append(newline);
+
+        return response;
+    }
+
+
+    bool Connection::bodylessResponse(Handler::StatusCode statusCode) const {
+        return (
+               currentMethod == Handler::Method::HEAD
+            || statusCode == Handler::StatusCode::NO_CONTENT
+            || statusCode == Handler::StatusCode::NOT_MODIFIED
+        );
+    }
+
+
+    QByteArray Connection::responseVersion() const {
+        QByteArray result;
+
+        if (requestHeadOffset >= 0) {
+            const RequestParser::Span& version = requestParser.version();
+            result = QByteArray::fromRawData(headData() + version.offset, static_cast<int>(version.length));
+        } else {
+            // We could not parse the request so we answer using the highest version we support.
+            result = http11String;
+        }
+
+        return result;
+    }
+
+
+    bool Connection::sendFailedResponse(Handler::StatusCode statusCode) {
+        QByteArray body(
+            "<html>"
+              "<head>"
+                "<title>{{ status_code }} {{ reason_phrase }}</title>"
+              "</head>"
+              "<body>"
+                "<p align=\"center\">{{ status_code }} {{ reason_phrase }}</p>"
+              "</body>"
+            "</html>\n"
+        );
+
+        const QByteArray& reasonPhrase = reasonPhraseByStatusCode.value(statusCode, defaultReasonPhrase);
+        body = body.replace("{{ status_code }}", QByteArray::number(static_cast<unsigned>(statusCode)))
+                   .replace("{{ reason_phrase }}", reasonPhrase);
+
+        Handler::Headers headers;
+        headers.insert(Handler::contentTypeString, Handler::textHtmlString);
+
+        return sendResponse(statusCode, headers, body);
+    }
+
+
+    bool Connection::sendData(const QByteArray& data) {
+        const char* position  = data.constData();
+        qint64      remaining = data.size();
+        bool        success   = true;
+
+        // Large writes are fed to the socket as the client drains it so a slow client can not make us hold a
+        // second copy of the whole response.
+        while (success && remaining > 0) {
+            success = waitForOutboundSpace();
+            if (success) {
+                qint64 pieceLength = remaining;
+                if (outboundLimit > 0) {
+                    qint64 space = outboundLimit - currentSocket->bytesToWrite();
+                    if (pieceLength > space) {
+                        pieceLength = space;
+                    }
+                }
+
+                success = (currentSocket->write(position, pieceLength) == pieceLength);
+
+                position  += pieceLength;
+                remaining -= pieceLength;
+            }
+        }
+
+        if (!success) {
+            currentKeepAlive = false;
+        }
+
+        return success;
+    }
+
+
+    unsigned long long Connection::bufferedOutboundBytes() const {
+        return static_cast<unsigned long long>(currentSocket->bytesToWrite());
+    }
+
+
+    const QUrl& Connection::requestUri() const {
+        if (!requestUriValid) {
+            currentRequestUri.setUrl(toString(requestParser.target()));
+            requestUriValid = true;
+        }
+
+        return currentRequestUri;
+    }
+
+
+    const QString& Connection::path() const {
+        if (!pathValid) {
+            const RequestParser::Span& target     = requestParser.target();
+            const char*                targetData = headData() + target.offset;
+            unsigned long              pathLength;
+
+            if (isPlainPath(targetData, target.length, pathLength)) {
+                currentPath = QString::fromUtf8(targetData, static_cast<int>(pathLength));
+            } else {
+                // Absolute and percent encoded targets need the full URI parser.
+                currentPath = requestUri().path();
+            }
+
+            pathValid = true;
+        }
+
+        return currentPath;
+    }
+
+
+    QString Connection::pathParameter(const QString& name) const {
+        QString    result;
+        QByteArray parameterName = name.toUtf8();
+        unsigned   index         = 0;
+
+        while (index < routeMatch.numberParameters && *routeMatch.parameters[index].name != parameterName) {
+            ++index;
+        }
+
+        if (index < routeMatch.numberParameters) {
+            const Router::Parameter& parameter = routeMatch.parameters[index];
+            result = QString::fromUtf8(routedPathData() + parameter.offset, static_cast<int>(parameter.length));
+        }
+
+        return result;
+    }
+
+
+    Handler::Method Connection::method() const {
+        return currentMethod;
+    }
+
+
+    const QString& Connection::httpVersion() const {
+        if (!httpVersionValid) {
+            currentHttpVersion = toString(requestParser.version());
+            httpVersionValid   = true;
+        }
+
+        return currentHttpVersion;
+    }
+
+
+    const Handler::Headers& Connection::headers() const {
+        if (!headersValid) {
+            currentHeaders.clear();
+
+            const QVector<RequestParser::Field>& fields       = requestParser.fields();
+            unsigned                             numberFields = static_cast<unsigned>(fields.size());
+            const char*                          data         = headData();
+
+            for (unsigned i=0 ; i<numberFields ; ++i) {
+                const RequestParser::Field& field = fields.at(i);
+                currentHeaders.insert(
+                    QByteArray(data + field.name.offset, static_cast<int>(field.name.length)).toLower(),
+                    QByteArray(data + field.value.offset, static_cast<int>(field.value.length))
+                );
+            }
+
+            // Trailers never replace a field from the request head.
+            Handler::Headers::const_iterator trailerIterator    = requestTrailers.constBegin();
+            Handler::Headers::const_iterator trailerEndIterator = requestTrailers.constEnd();
+            while (trailerIterator != trailerEndIterator) {
+                if (!currentHeaders.contains(trailerIterator.key())) {
+                    currentHeaders.insert(trailerIterator.key(), trailerIterator.value());
+                }
+
+                ++trailerIterator;
+            }
+
+            headersValid = true;
+        }
+
+        return currentHeaders;
+    }
+
+
+    QByteArray Connection::header(const QByteArray& name) const {
+        QByteArray                  result;
+        const RequestParser::Field* field = findHeader(name);
+
+        if (field != nullptr) {
+            result = QByteArray(headData() + field->value.offset, static_cast<int>(field->value.length));
+        } else {
+            result = requestTrailers.value(name);
+        }
+
+        return result;
+    }
+
+
+    void Connection::startSession(
+            qintptr                 socketDescriptor,
+            Server::LoggingFunction loggingFunction,
+            const QByteArray&       receivedData,
+            EventThread*            eventThread
+        ) {
+        currentSocketDescriptor = socketDescriptor;
+        currentLoggingFunction  = loggingFunction;
+        receiveBufferOffset     = 0;
+        currentEventThread      = eventThread;
+
+        // Copy rather than assign so the worker keeps its reserved receive buffer.
+        receiveBuffer.resize(0);
+        receiveBuffer.append(receivedData);
+
+        currentSessionSemaphore.release(1);
+    }
+
+
+    void Connection::stop() {
+        startSession(invalidSocketDescriptor, nullptr);
+    }
+
+
+    void Connection::run() {
+        currentSessionSemaphore.acquire();
+        while (currentSocketDescriptor != invalidSocketDescriptor) {
+            processSession();
+
+            currentSocket       = nullptr;
+            receiveBufferOffset = 0;
+            receiveBuffer.resize(0);
+            currentEventThread  = nullptr;
+            returnedStatusCode  = Handler::StatusCode::OK;
+
+            currentPool->workerIdle(this);
+            currentSessionSemaphore.acquire();
+        }
+    }
+
+
+    void Connection::processSession() {
+        QTcpSocket socket;
+        qintptr    socketDescriptor = currentSocketDescriptor;
+
+#if (defined(Q_OS_LINUX))
+        if (currentEventThread != nullptr) {
+            // Qt gets its own descriptor so the socket can be handed back to the I/O thread between requests.
+            socketDescriptor = ::dup(static_cast<int>(currentSocketDescriptor));
+        }
+#endif
+
+        bool success = (socketDescriptor >= 0 && socket.setSocketDescriptor(socketDescriptor));
+        if (success) {
+            currentSocket       = &socket;
+            currentRequestCount = 0;
+            requestTimedOut     = false;
+
+            bool keepAlive    = true;
+            bool returnSocket = false;
+            while (keepAlive && !returnSocket) {
+                ++currentRequestCount;
+                keepAlive = processRequest();
+
+                while (keepAlive && socket.bytesToWrite() > 0) {
+                    keepAlive = waitForWritten();
+                }
+
+                if (keepAlive && receiveBufferOffset >= receiveBuffer.size() && socket.bytesAvailable() == 0) {
+                    if (currentEventThread != nullptr) {
+                        returnSocket = true;
+                    } else {
+                        keepAlive = socket.waitForReadyRead(
+                            static_cast<int>(currentServerPrivate->keepAliveTimeout())
+                        );
+                    }
+                }
+            }
+
+            if (returnSocket) {
+                // Closing our duplicate leaves the connection open for the I/O thread.
+                socket.abort();
+                returnSessionSocket();
+            } else if (requestTimedOut) {
+                // Push out whatever the socket will take without blocking, then drop the client.
+                socket.flush();
+                socket.abort();
+                closeSessionSocket();
+            } else {
+                socket.disconnectFromHost();
+                if (socket.state() != QTcpSocket::SocketState::UnconnectedState) {
+                    socket.waitForDisconnected(remainingTime());
+                }
+
+                closeSessionSocket();
+            }
+        } else {
+            currentServerPrivate->sessionError(
+                QString("Could not bind to socket: %1").arg(socket.errorString())
+            );
+
+#if (defined(Q_OS_LINUX))
+            if (socketDescriptor >= 0 && socketDescriptor != currentSocketDescriptor) {
+                ::close(static_cast<int>(socketDescriptor));
+            }
+#endif
+
+            closeSessionSocket();
+        }
+    }
+
+
+#if (defined(Q_OS_LINUX))
+
+    void Connection::returnSessionSocket() {
+        if (!currentEventThread->returnSocket(currentSocketDescriptor)) {
+            ::close(static_cast<int>(currentSocketDescriptor));
+        }
+
+        // The I/O thread may be deleted as soon as it is released.
+        currentEventThread->sessionEnded();
+    }
+
+
+    void Connection::closeSessionSocket() {
+        if (currentEventThread != nullptr) {
+            ::close(static_cast<int>(currentSocketDescriptor));
+
+            currentEventThread->sessionEnded();
+        }
+    }
+
+#else
+
+    void Connection::returnSessionSocket() {}
+
+
+    void Connection::closeSessionSocket() {}
+
+#endif
+
+
+    bool Connection::processRequest() {
+        currentKeepAlive     = false;
+        responseStarted      = false;
+        requestTimedOut      = false;
+        continuePending      = false;
+        requestBodyChunked   = false;
+        chunkedBodyComplete  = false;
+        chunkDataPending     = false;
+        requestBodyMalformed = false;
+        requestBodyCoding    = ContentCoding::IDENTITY;
+        requestDeadline      = deadlineAfter(currentServerPrivate->requestTimeout());
+        outboundLimit        = static_cast<qint64>(currentServerPrivate->maximumOutboundBufferSize());
+        phaseDeadline        = deadlineAfter(currentServerPrivate->requestHeadTimeout());
+        requestBodyRemaining = -1;
+        requestHeadOffset    = -1;
+        returnedStatusCode   = Handler::StatusCode::OK;
+        currentMethod        = Handler::Method::NUMBER_METHODS;
+        routedPathInHead     = true;
+        requestUriValid      = false;
+        pathValid            = false;
+        httpVersionValid     = false;
+        headersValid         = false;
+
+        routeMatch.numberParameters = 0;
+        requestTrailers.clear();
+
+        bool success = readRequestHead();
+        if (success) {
+            phaseDeadline = deadlineAfter(currentServerPrivate->requestBodyTimeout());
+            success       = prepareRequestBody();
+        }
+
+        if (success) {
+            currentKeepAlive = requestAllowsKeepAlive();
+
+            Handler* handler = nullptr;
+            if (currentMethod != Handler::Method::NUMBER_METHODS) {
+                handler = routeRequest();
+            }
+
+            if (handler != nullptr) {
+                if (checkRequestHead(handler)) {
+                    currentHandler = handler;
+                    handler->session(*this);
+                    currentHandler = nullptr;
+
+                    currentPool->bufferPool().release(pooledBody);
+                }
+
+                writeLog(path(), false);
+            } else {
+                success = false;
+                sendFailedResponse(Handler::StatusCode::NOT_FOUND);
+
+                QString message = QString("Invalid URI: %1").arg(toString(requestParser.target()));
+                writeLog(message, false);
+                currentServerPrivate->sessionError(message);
+            }
+
+            currentServerPrivate->releaseRoutes(*routeReader);
+
+            if (requestTimedOut && !responseStarted) {
+                sendFailedResponse(Handler::StatusCode::REQUEST_TIMEOUT);
+                currentServerPrivate->sessionError(QString("Request body timed out: %1").arg(path()));
+            } else if (requestBodyMalformed && !responseStarted) {
+                sendFailedResponse(Handler::StatusCode::BAD_REQUEST);
+                currentServerPrivate->sessionError(QString("Malformed request body: %1").arg(path()));
+            }
+        }
+
+        bool keepAlive = currentKeepAlive && responseStarted;
+        if (keepAlive && requestBodyPending()) {
+            keepAlive = discardRequestBody();
+        }
+
+        // Only the request deadline applies while the response drains.
+        phaseDeadline = QDeadlineTimer(QDeadlineTimer::Forever);
+
+        return keepAlive;
+    }
+
+
+    bool Connection::readRequestHead() {
+        requestParser.reset();
+
+        RequestParser::State state = requestParser.parse(
+            receiveBuffer.constData() + receiveBufferOffset,
+            static_cast<unsigned long>(receiveBuffer.size() - receiveBufferOffset)
+        );
+
+        // The parser works from offsets so it is unaffected when the fill moves the partial head.
+        bool success = true;
+        while (success && state != RequestParser::State::COMPLETE && state != RequestParser::State::FAILED) {
+            success = fillReceiveBuffer();
+            if (success) {
+                state = requestParser.parse(
+                    receiveBuffer.constData() + receiveBufferOffset,
+                    static_cast<unsigned long>(receiveBuffer.size() - receiveBufferOffset)
+                );
+            }
+        }
+
+        if (!success && requestTimedOut) {
+            // Clients that never started a request are simply dropped.
+            if (receiveBufferOffset < receiveBuffer.size()) {
+                sendFailedResponse(Handler::StatusCode::REQUEST_TIMEOUT);
+                currentServerPrivate->sessionError(QString("Request head timed out."));
+            }
+        } else if (!success) {
+            QString message = QString("Falied to read content: %1").arg(currentSocket->errorString());
+
+            sendFailedResponse(Handler::StatusCode::BAD_REQUEST);
+
+            writeLog(message, false);
+            currentServerPrivate->sessionError(message);
+        } else if (state == RequestParser::State::FAILED) {
+            success = false;
+            sendFailedResponse(requestParser.failureStatusCode());
+
+            QString message = QString("Malformed HTTP request head: %1")
+                              .arg(static_cast<unsigned>(requestParser.failureStatusCode()));
+
+            writeLog(message, false);
+            currentServerPrivate->sessionError(message);
+        } else {
+            requestHeadOffset    = receiveBufferOffset;
+            receiveBufferOffset += static_cast<int>(requestParser.headLength());
+            currentMethod        = toMethod(requestParser.method());
+        }
+
+        return success;
+    }
+
+
+    bool Connection::nextLine(unsigned long maximumSize, const char*& line, int& lineLength, bool& terminated) {
+        if (maximumSize == 0) {
+            maximumSize = currentMaximumBufferSize;
+        }
+
+        bool success  = (sendContinue() && startBodyData() && requestBodyRemaining != 0);
+        bool found    = false;
+
+        terminated = false;
+        int  scanned  = 0;
+        int  consumed = 0;
+        while (success && !found) {
+            long long   searchLimit = receiveBuffer.size() - receiveBufferOffset;
+            const char* start       = receiveBuffer.constData() + receiveBufferOffset;
+
+            if (requestBodyRemaining >= 0 && searchLimit > requestBodyRemaining) {
+                searchLimit = requestBodyRemaining;
+            }
+
+            if (searchLimit > static_cast<long long>(maximumSize)) {
+                searchLimit = static_cast<long long>(maximumSize);
+            }
+
+            const char* newlinePosition = static_cast<const char*>(
+                std::memchr(start + scanned, '\n', static_cast<size_t>(searchLimit - scanned))
+            );
+
+            if (newlinePosition != nullptr) {
+                found      = true;
+                terminated = true;
+                line       = start;
+                lineLength = static_cast<int>(newlinePosition - start);
+                consumed   = lineLength + 1;
+
+                if (lineLength > 0 && start[lineLength - 1] == '\r') {
+                    --lineLength;
+                }
+            } else if (searchLimit == static_cast<long long>(maximumSize) || searchLimit == requestBodyRemaining) {
+                // Hand out what we have, as the original per-byte reader did for overlong lines.
+                found      = true;
+                line       = start;
+                lineLength = static_cast<int>(searchLimit);
+                consumed   = lineLength;
+            } else {
+                scanned = static_cast<int>(searchLimit);
+                success = fillReceiveBuffer();
+            }
+        }
+
+        if (found) {
+            receiveBufferOffset += consumed;
+            if (requestBodyRemaining > 0) {
+                requestBodyRemaining -= consumed;
+            }
+        }
+
+        return success;
+    }
+
+
+    bool Connection::fillReceiveBuffer() {
+        // Slide unread data to the front so the buffer does not grow across requests.  The current request head is
+        // kept as the request accessors refer to it.
+        int discardLength = receiveBufferOffset;
+        if (requestHeadOffset >= 0 && requestHeadOffset < discardLength) {
+            discardLength = requestHeadOffset;
+        }
+
+        if (discardLength > 0) {
+            receiveBuffer.remove(0, discardLength);
+            receiveBufferOffset -= discardLength;
+
+            if (requestHeadOffset >= 0) {
+                requestHeadOffset -= discardLength;
+            }
+        }
+
+        if (requestHeadOffset >= 0) {
+            // Body data consumed since the head was parsed is also dropped so a streamed body does not accumulate
+            // behind the head.
+            int headEnd = requestHeadOffset + static_cast<int>(requestParser.headLength());
+            if (receiveBufferOffset > headEnd) {
+                receiveBuffer.remove(headEnd, receiveBufferOffset - headEnd);
+                receiveBufferOffset = headEnd;
+            }
+        }
+
+        bool success = currentSocket->bytesAvailable() > 0 || waitForReadable();
+        if (success) {
+            int currentSize = receiveBuffer.size();
+            receiveBuffer.resize(currentSize + receiveChunkSize);
+
+            qint64 bytesRead = currentSocket->read(receiveBuffer.data() + currentSize, receiveChunkSize);
+            if (bytesRead > 0) {
+                receiveBuffer.resize(currentSize + static_cast<int>(bytesRead));
+            } else {
+                receiveBuffer.resize(currentSize);
+                success = false;
+            }
+        }
+
+        return success;
+    }
+
+
+    bool Connection::startBodyData() {
+        bool success = true;
+
+        if (requestBodyChunked && requestBodyRemaining == 0 && !chunkedBodyComplete) {
+            const char* line;
+            int         lineLength;
+
+            if (chunkDataPending) {
+                // Each chunk's data is followed by a bare line terminator.
+                success = readChunkLine(line, lineLength);
+                if (success && lineLength != 0) {
+                    success              = false;
+                    requestBodyMalformed = true;
+                }
+
+                chunkDataPending = false;
+            }
+
+            if (success) {
+                success = readChunkLine(line, lineLength);
+            }
+
+            if (success) {
+                long long chunkSize;
+                success = parseChunkSize(line, lineLength, chunkSize);
+                if (!success) {
+                    requestBodyMalformed = true;
+                } else if (chunkSize > 0) {
+                    requestBodyRemaining = chunkSize;
+                    chunkDataPending     = true;
+                } else {
+                    success             = readTrailers();
+                    chunkedBodyComplete = success;
+                }
+            }
+
+            if (!success) {
+                currentKeepAlive = false;
+            }
+        }
+
+        return success;
+    }
+
+
+    bool Connection::readChunkLine(const char*& line, int& lineLength) {
+        bool success = true;
+        bool found   = false;
+        int  scanned = 0;
+
+        while (success && !found) {
+            const char* start     = receiveBuffer.constData() + receiveBufferOffset;
+            int         available = receiveBuffer.size() - receiveBufferOffset;
+
+            const char* newlinePosition = static_cast<const char*>(
+                std::memchr(start + scanned, '\n', static_cast<size_t>(available - scanned))
+            );
+
+            if (newlinePosition != nullptr) {
+                found                = true;
+                line                 = start;
+                lineLength           = static_cast<int>(newlinePosition - start);
+                receiveBufferOffset += lineLength + 1;
+
+                if (lineLength > 0 && start[lineLength - 1] == '\r') {
+                    --lineLength;
+                }
+            } else if (available >= maximumChunkLineLength) {
+                success              = false;
+                requestBodyMalformed = true;
+            } else {
+                scanned = available;
+                success = fillReceiveBuffer();
+            }
+        }
+
+        return success;
+    }
+
+
+    bool Connection::readTrailers() {
+        bool          success       = true;
+        bool          done          = false;
+        unsigned long trailerLength = 0;
+
+        while (success && !done) {
+            const char* line;
+            int         lineLength;
+
+            success = readChunkLine(line, lineLength);
+            if (success) {
+                if (lineLength == 0) {
+                    done = true;
+                } else {
+                    const char* colonPosition = static_cast<const char*>(
+                        std::memchr(line, ':', static_cast<size_t>(lineLength))
+                    );
+
+                    trailerLength += static_cast<unsigned long>(lineLength);
+                    if (colonPosition == nullptr || colonPosition == line || trailerLength > currentMaximumBufferSize) {
+                        success              = false;
+                        requestBodyMalformed = true;
+                    } else {
+                        int nameLength = static_cast<int>(colonPosition - line);
+                        requestTrailers.insert(
+                            QByteArray(line, nameLength).trimmed().toLower(),
+                            QByteArray(colonPosition + 1, lineLength - nameLength - 1).trimmed()
+                        );
+                    }
+                }
+            }
+        }
+
+        // The header table is rebuilt so it includes the trailers.
+        headersValid = false;
+
+        return success;
+    }
+
+
+    bool Connection::parseChunkSize(const char* line, int lineLength, long long& chunkSize) {
+        chunkSize = 0;
+
+        // Chunk extensions, after a semicolon, are ignored.
+        int  index   = 0;
+        bool success = true;
+        while (success && index < lineLength && line[index] != ';' && line[index] != ' ' && line[index] != '\t') {
+            char c = line[index];
+            int  digit;
+            if (c >= '0' && c <= '9') {
+                digit = c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                digit = c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                digit = c - 'A' + 10;
+            } else {
+                digit = -1;
+            }
+
+            success = (digit >= 0 && index < maximumChunkSizeDigits);
+            if (success) {
+                chunkSize = (chunkSize << 4) | digit;
+                ++index;
+            }
+        }
+
+        return success && index > 0;
+    }
+
+
+    bool Connection::waitForReadable() {
+        bool success = currentSocket->waitForReadyRead(remainingTime());
+        if (!success) {
+            checkDeadlines();
+        }
+
+        return success;
+    }
+
+
+    bool Connection::waitForWritten() {
+        bool success = currentSocket->waitForBytesWritten(remainingTime());
+        if (!success) {
+            checkDeadlines();
+        }
+
+        return success;
+    }
+
+
+    bool Connection::waitForOutboundSpace() {
+        bool success = true;
+        if (outboundLimit > 0) {
+            while (success && currentSocket->bytesToWrite() >= outboundLimit) {
+                success = waitForWritten();
+            }
+        }
+
+        return success;
+    }
+
+
+    bool Connection::sendFileRange(int fileDescriptor, unsigned long long offset, unsigned long long length) {
+        // The response head, and anything before it, must reach the socket before we write to it directly.
+        bool success = true;
+        while (success && currentSocket->bytesToWrite() > 0) {
+            success = waitForWritten();
+        }
+
+#if (defined(Q_OS_LINUX))
+
+        bool useMapping = false;
+        while (success && !useMapping && length > 0) {
+            off_t              position      = static_cast<off_t>(offset);
+            unsigned long long requestLength = length;
+            if (requestLength > maximumSendFileLength) {
+                requestLength = maximumSendFileLength;
+            }
+
+            ssize_t bytesSent = ::sendfile(
+                static_cast<int>(currentSocket->socketDescriptor()),
+                fileDescriptor,
+                &position,
+                static_cast<size_t>(requestLength)
+            );
+
+            if (bytesSent > 0) {
+                offset += static_cast<unsigned long long>(bytesSent);
+                length -= static_cast<unsigned long long>(bytesSent);
+            } else if (bytesSent == 0) {
+                // The file is shorter than the range we promised.
+                success = false;
+            } else if (errno == EAGAIN || errno == EINTR) {
+                success = waitForSocketWritable();
+            } else if (errno == EINVAL || errno == ENOSYS) {
+                // Some file systems can not be sent directly.  Nothing was sent by this call so we can continue
+                // from the same offset.
+                useMapping = true;
+            } else {
+                success = false;
+            }
+        }
+
+        if (success && length > 0) {
+            success = sendMappedFileRange(fileDescriptor, offset, length);
+        }
+
+#else
+
+        if (success) {
+            success = sendMappedFileRange(fileDescriptor, offset, length);
+        }
+
+#endif
+
+        return success;
+    }
+
+
+    bool Connection::sendMappedFileRange(int fileDescriptor, unsigned long long offset, unsigned long long length) {
+        QFile file;
+        bool  success = file.open(fileDescriptor, QFile::ReadOnly, QFile::DontCloseHandle);
+
+        while (success && length > 0) {
+            unsigned long long windowLength = length;
+            if (windowLength > fileMappingWindowLength) {
+                windowLength = fileMappingWindowLength;
+            }
+
+            uchar* window = file.map(static_cast<qint64>(offset), static_cast<qint64>(windowLength));
+            if (window != nullptr) {
+                // The socket copies what it queues and sendData only returns once the last piece is queued so
+                // the window can be unmapped right after.
+                success = sendData(
+                    QByteArray::fromRawData(reinterpret_cast<const char*>(window), static_cast<int>(windowLength))
+                );
+
+                file.unmap(window);
+
+                offset += windowLength;
+                length -= windowLength;
+            } else {
+                success = false;
+            }
+        }
+
+        return success;
+    }
+
+
+    bool Connection::waitForSocketWritable() {
+        bool success;
+
+#if (defined(Q_OS_LINUX))
+
+        struct pollfd descriptor;
+        descriptor.fd      = static_cast<int>(currentSocket->socketDescriptor());
+        descriptor.events  = POLLOUT;
+        descriptor.revents = 0;
+
+        int result = ::poll(&descriptor, 1, remainingTime());
+        if (result < 0) {
+            success = (errno == EINTR);
+        } else if (result == 0) {
+            success = false;
+            checkDeadlines();
+        } else {
+            success = ((descriptor.revents & (POLLERR | POLLHUP | POLLNVAL)) == 0);
+        }
+
+#else
+
+        success = waitForWritten();
+
+#endif
+
+        return success;
+    }
+
+
+    void Connection::checkDeadlines() {
+        if (phaseDeadline.hasExpired() || requestDeadline.hasExpired()) {
+            requestTimedOut  = true;
+            currentKeepAlive = false;
+        }
+    }
+
+
+    int Connection::remainingTime() const {
+        qint64 result           = phaseDeadline.remainingTime();
+        qint64 requestRemaining = requestDeadline.remainingTime();
+
+        if (result < 0 || (requestRemaining >= 0 && requestRemaining < result)) {
+            result = requestRemaining;
+        }
+
+        return static_cast<int>(result);
+    }
+
+
+    QDeadlineTimer Connection::deadlineAfter(unsigned timeout) {
+        QDeadlineTimer result(QDeadlineTimer::Forever);
+        if (timeout > 0) {
+            result = QDeadlineTimer(static_cast<qint64>(timeout));
+        }
+
+        return result;
+    }
+
+
+    bool Connection::prepareRequestBody() {
+        bool    success = true;
+        QString failure;
+
+        // Framing that another server in the path could read differently is refused rather than guessed at.
+        const RequestParser::Field* transferEncoding = nullptr;
+        const RequestParser::Field* contentLength    = nullptr;
+
+        unsigned numberTransferEncodings = countHeaders(Handler::transferEncodingString, transferEncoding);
+        unsigned numberContentLengths    = countHeaders(Handler::contentLengthString, contentLength);
+
+        if (numberTransferEncodings > 0 && numberContentLengths > 0) {
+            failure = QString("Both Transfer-Encoding and Content-Length supplied");
+        } else if (numberContentLengths > 1) {
+            failure = QString("Multiple Content-Length fields supplied");
+        } else if (numberTransferEncodings > 0) {
+            const char* value       = headData() + transferEncoding->value.offset;
+            int         valueLength = static_cast<int>(transferEncoding->value.length);
+            int         finalCoding = valueLength;
+            while (finalCoding > 0 && value[finalCoding - 1] != ',') {
+                --finalCoding;
+            }
+
+            if (tokenEquals(value + finalCoding, valueLength - finalCoding, Handler::transferEncodingChunkedString)) {
+                // The chunk framing tells us where the body ends.  Chunks are located as the body is read.
+                requestBodyChunked   = true;
+                requestBodyRemaining = 0;
+            } else {
+                failure = QString("Transfer-Encoding does not end with chunked: %1")
+                          .arg(toString(transferEncoding->value));
+            }
+        } else if (numberContentLengths > 0) {
+            QByteArray contentLengthValue = QByteArray::fromRawData(
+                headData() + contentLength->value.offset,
+                static_cast<int>(contentLength->value.length)
+            );
+
+            bool validLength;
+            requestBodyRemaining = contentLengthValue.toLongLong(&validLength);
+            if (!validLength || requestBodyRemaining < 0) {
+                failure = QString("Invalid content length: %1").arg(toString(contentLength->value));
+            }
+        } else {
+            requestBodyRemaining = 0;
+        }
+
+        if (!failure.isEmpty()) {
+            // The connection is closed as there is no telling where the next request starts.
+            success              = false;
+            requestBodyRemaining = -1;
+
+            sendFailedResponse(Handler::StatusCode::BAD_REQUEST);
+
+            writeLog(failure, false);
+            currentServerPrivate->sessionError(failure);
+        }
+
+        return success;
+    }
+
+
+    bool Connection::requestBodyPending() const {
+        return requestBodyRemaining != 0 || (requestBodyChunked && !chunkedBodyComplete);
+    }
+
+
+    bool Connection::requestAllowsKeepAlive() const {
+        bool     result                       = false;
+        unsigned maximumRequestsPerConnection = currentServerPrivate->maximumRequestsPerConnection();
+
+        if (requestBodyRemaining >= 0                                                                    &&
+            currentServerPrivate->keepAliveTimeout() > 0                                                 &&
+            (maximumRequestsPerConnection == 0 || currentRequestCount < maximumRequestsPerConnection)       ) {
+            QByteArray connectionValue = header(Handler::connectionString);
+            if (spanEquals(requestParser.version(), http11String)) {
+                result = !containsToken(connectionValue, Handler::connectionCloseString);
+            } else if (spanEquals(requestParser.version(), http10String)) {
+                result = containsToken(connectionValue, Handler::connectionKeepAliveString);
+            }
+        }
+
+        return result;
+    }
+
+
+    bool Connection::checkBodySize(unsigned long long bodySize, unsigned long long maximumSize) {
+        bool success = (maximumSize == 0 || bodySize <= maximumSize);
+        if (!success) {
+            sendFailedResponse(Handler::StatusCode::REQUEST_ENTITY_TOO_LARGE);
+
+            QString message = QString("Request body too large: %1").arg(bodySize);
+
+            writeLog(message, false);
+            currentServerPrivate->sessionError(message);
+        }
+
+        return success;
+    }
+
+
+    bool Connection::checkRequestHead(Handler* handler) {
+        bool success = true;
+
+        const RequestParser::Field* expect = findHeader(Handler::expectString);
+        if (expect != nullptr) {
+            QByteArray expectValue = QByteArray::fromRawData(
+                headData() + expect->value.offset,
+                static_cast<int>(expect->value.length)
+            );
+
+            if (!containsToken(expectValue, Handler::expectContinueString)) {
+                success = false;
+                sendFailedResponse(Handler::StatusCode::EXPECTATION_FAILED);
+
+                QString message = QString("Unsupported expectation: %1").arg(toString(expect->value));
+
+                writeLog(message, false);
+                currentServerPrivate->sessionError(message);
+            } else if (requestBodyPending() && spanEquals(requestParser.version(), http11String)) {
+                // HTTP/1.0 clients do not wait for the interim response so it is only owed to HTTP/1.1 clients.
+                continuePending = true;
+            }
+        }
+
+        if (success && !parseContentCoding(header(Handler::contentEncodingString), requestBodyCoding)) {
+            success = false;
+            sendFailedResponse(Handler::StatusCode::REQUEST_UNSUPPORTED_MEDIA_TYPE);
+
+            QString message = QString("Unsupported content encoding: %1")
+                              .arg(QString::fromLatin1(header(Handler::contentEncodingString)));
+
+            writeLog(message, false);
+            currentServerPrivate->sessionError(message);
+        }
+
+        // Refuse bodies over the handler's limit before reading any of them.
+        if (success && requestBodyRemaining > 0) {
+            success = checkBodySize(static_cast<unsigned long long>(requestBodyRemaining), handler->maximumBodySize());
+        }
+
+        if (success) {
+            Handler::StatusCode statusCode = handler->checkRequestHead(*this);
+            if (statusCode != Handler::StatusCode::OK) {
+                success = false;
+                sendFailedResponse(statusCode);
+            }
+        }
+
+        return success;
+    }
+
+
+    bool Connection::sendContinue() {
+        bool success = true;
+        if (continuePending) {
+            continuePending = false;
+
+            success = sendData(continueResponse);
+            if (success) {
+                currentSocket->flush();
+            }
+        }
+
+        return success;
+    }
+
+
+    bool Connection::discardRequestBody() {
+        bool success = true;
+        while (success && requestBodyPending()) {
+            QByteArray discardedData;
+            success = readData(discardedData);
+        }
+
+        return success;
+    }
+
+
+    void Connection::writeLog(const QString& message, bool error) const {
         if (currentLoggingFunction != nullptr) {
-            QString                          peerAddress;
-            Handler::Headers::const_iterator headerIterator = currentHeaders.find(Handler::xRealIPString);
-            if (headerIterator != currentHeaders.constEnd()) {
-                peerAddress = QString::fromUtf8(headerIterator.value());
+            QString                     peerAddress;
+            const RequestParser::Field* field = findHeader(Handler::xRealIPString);
+            if (field != nullptr) {
+                peerAddress = toString(field->value);
             } else {
-                headerIterator = currentHeaders.find(Handler::xForwardedForString);
-                if (headerIterator != currentHeaders.constEnd()) {
-                    peerAddress = QString::fromUtf8(headerIterator.value());
+                field = findHeader(Handler::xForwardedForString);
+                if (field != nullptr) {
+                    peerAddress = toString(field->value);
                 } else {
                     peerAddress = currentSocket->peerAddress().toString();
                 }
@@ -615,7 +2447,197 @@ namespace RestApiInV1 {
     }
 
 
-    Handler::Method Connection::toMethod(const QByteArray& methodString) {
-        return handlerMethodsByString.value(methodString.toLower(), Handler::Method::NUMBER_METHODS);
+    Handler::Method Connection::toMethod(const RequestParser::Span& methodSpan) const {
+        Handler::Method result = Handler::Method::NUMBER_METHODS;
+
+        if (methodSpan.length <= maximumMethodLength) {
+            // Lower case into a stack buffer so the lookup does not allocate.
+            char        lowerCaseMethod[maximumMethodLength];
+            const char* methodData = headData() + methodSpan.offset;
+            for (unsigned long i=0 ; i<methodSpan.length ; ++i) {
+                char c = methodData[i];
+                if (c >= 'A' && c <= 'Z') {
+                    c += 'a' - 'A';
+                }
+
+                lowerCaseMethod[i] = c;
+            }
+
+            result = handlerMethodsByString.value(
+                QByteArray::fromRawData(lowerCaseMethod, static_cast<int>(methodSpan.length)),
+                Handler::Method::NUMBER_METHODS
+            );
+        }
+
+        return result;
+    }
+
+
+    Handler* Connection::routeRequest() {
+        const RequestParser::Span& target     = requestParser.target();
+        const char*                targetData = headData() + target.offset;
+        unsigned long              pathLength;
+        Handler*                   result;
+
+        routedPathInHead = isPlainPath(targetData, target.length, pathLength);
+        if (routedPathInHead) {
+            result = currentServerPrivate->route(
+                *routeReader,
+                currentMethod,
+                targetData,
+                pathLength,
+                nullptr,
+                0,
+                routeMatch
+            );
+        } else {
+            // When we're behind a proxy, the target carries the host and scheme.  Handlers registered under the host
+            // are found by the same lookup.
+
+            QByteArray host  = requestUri().host().toUtf8();
+            decodedRoutePath = path().toUtf8();
+
+            result = currentServerPrivate->route(
+                *routeReader,
+                currentMethod,
+                decodedRoutePath.constData(),
+                static_cast<unsigned long>(decodedRoutePath.size()),
+                host.constData(),
+                static_cast<unsigned long>(host.size()),
+                routeMatch
+            );
+        }
+
+        return result;
+    }
+
+
+    const char* Connection::routedPathData() const {
+        const char* result;
+        if (routedPathInHead) {
+            result = headData() + requestParser.target().offset;
+        } else {
+            result = decodedRoutePath.constData();
+        }
+
+        return result;
+    }
+
+
+    bool Connection::isPlainPath(const char* target, unsigned long targetLength, unsigned long& pathLength) {
+        bool plainPath = (targetLength > 0 && target[0] == '/');
+
+        pathLength = 0;
+        while (plainPath                 &&
+               pathLength < targetLength &&
+               target[pathLength] != '?' &&
+               target[pathLength] != '#'    ) {
+            plainPath = (target[pathLength] != '%');
+            ++pathLength;
+        }
+
+        return plainPath;
+    }
+
+
+    const RequestParser::Field* Connection::findHeader(const QByteArray& name) const {
+        const RequestParser::Field* result = nullptr;
+
+        if (requestHeadOffset >= 0) {
+            const QVector<RequestParser::Field>& fields       = requestParser.fields();
+            unsigned                             numberFields = static_cast<unsigned>(fields.size());
+            unsigned                             nameLength   = static_cast<unsigned>(name.size());
+            const char*                          data         = headData();
+            unsigned                             index        = 0;
+
+            while (result == nullptr && index < numberFields) {
+                const RequestParser::Field& field = fields.at(index);
+                if (field.name.length == nameLength                                         &&
+                    qstrnicmp(data + field.name.offset, name.constData(), nameLength) == 0    ) {
+                    result = &field;
+                }
+
+                ++index;
+            }
+        }
+
+        return result;
+    }
+
+
+    unsigned Connection::countHeaders(const QByteArray& name, const RequestParser::Field*& lastField) const {
+        unsigned result = 0;
+
+        lastField = nullptr;
+        if (requestHeadOffset >= 0) {
+            const QVector<RequestParser::Field>& fields       = requestParser.fields();
+            unsigned                             numberFields = static_cast<unsigned>(fields.size());
+            unsigned                             nameLength   = static_cast<unsigned>(name.size());
+            const char*                          data         = headData();
+
+            for (unsigned index=0 ; index<numberFields ; ++index) {
+                const RequestParser::Field& field = fields.at(index);
+                if (field.name.length == nameLength                                         &&
+                    qstrnicmp(data + field.name.offset, name.constData(), nameLength) == 0    ) {
+                    lastField = &field;
+                    ++result;
+                }
+            }
+        }
+
+        return result;
+    }
+
+
+    QString Connection::toString(const RequestParser::Span& span) const {
+        return QString::fromUtf8(headData() + span.offset, static_cast<int>(span.length));
+    }
+
+
+    bool Connection::spanEquals(const RequestParser::Span& span, const QByteArray& value) const {
+        return (
+               span.length == static_cast<unsigned long>(value.size())
+            && qstrncmp(headData() + span.offset, value.constData(), static_cast<unsigned>(span.length)) == 0
+        );
+    }
+
+
+    bool Connection::containsToken(const QByteArray& value, const QByteArray& token) {
+        const char* data   = value.constData();
+        int         length = value.size();
+        int         start  = 0;
+        bool        found  = false;
+
+        while (!found && start <= length) {
+            const char* comma = static_cast<const char*>(
+                std::memchr(data + start, ',', static_cast<size_t>(length - start))
+            );
+
+            int end = comma != nullptr ? static_cast<int>(comma - data) : length;
+            found   = tokenEquals(data + start, end - start, token);
+            start   = end + 1;
+        }
+
+        return found;
+    }
+
+
+    bool Connection::tokenEquals(const char* element, int elementLength, const QByteArray& token) {
+        int start = 0;
+        int end   = elementLength;
+
+        while (start < end && (element[start] == ' ' || element[start] == '\t')) {
+            ++start;
+        }
+
+        while (end > start && (element[end - 1] == ' ' || element[end - 1] == '\t')) {
+            --end;
+        }
+
+        unsigned length = static_cast<unsigned>(end - start);
+        return (
+               length == static_cast<unsigned>(token.size())
+            && qstrnicmp(element + start, token.constData(), length) == 0
+        );
     }
 }
@@ -31,42 +31,56 @@
 #include <QQueue>
 #include <QHostAddress>
 #include <QTcpSocket>
+#include <QVector>
+#include <QDeadlineTimer>
 
 #include "rest_api_in_v1_common.h"
 #include "rest_api_in_v1_session.h"
+#include "rest_api_in_v1_request_parser.h"
+#include "rest_api_in_v1_router.h"
 #include "rest_api_in_v1_server_private.h"
+#include "rest_api_in_v1_content_coding.h"
 
 namespace RestApiInV1 {
+    class REST_API_V1_PUBLIC_API ConnectionPool;
+    class REST_API_V1_PUBLIC_API EventThread;
+
     /**
-     * Class that manages communcation for a single session in a separate thread.
+     * Class that manages communcation for a single session at a time in a long lived worker thread.  Workers are
+     * owned by a \ref ConnectionPool and are handed sockets using \ref startSession.  A session services requests
+     * on the socket until the connection is no longer persistent, the client goes idle, or the server's per
+     * connection request limit is reached.
      */
     class REST_API_V1_PUBLIC_API Connection:public QThread, public Session {
         Q_OBJECT
 
         public:
+            /**
+             * Value used to indicate that no socket descriptor is assigned.  Handing this value to
+             * \ref startSession will cause the worker thread to exit.
+             */
+            static constexpr qintptr invalidSocketDescriptor = -1;
+
             /**
              * Constructor
              *
-             * \param[in] serverPrivate     The server instance.
+             * \param[in] pool              The pool that owns this worker.
              *
-             * \param[in] socketDescriptor  The socket descriptor for the socket to tie to this session.
+             * \param[in] serverPrivate     The server instance.
              *
              * \param[in] threadId          A value used to uniquely identify this thread.   Note that values are
              *                              recycled but will always be unique while in flight.
              *
              * \param[in] maximumBufferSize The maximum amount of data we are allowed to read at once.
              *
-             * \param[in] loggingFunction   The function to be used for logging.
-             *
              * \param[in] parent            The pointer to the parent object.
              */
             Connection(
-                Server::Private*        server,
-                qintptr                 socketDescriptor,
-                unsigned                threadId,
-                unsigned long           maximumBufferSize,
-                Server::LoggingFunction loggingFunction,
-                QObject*                parent = nullptr
+                ConnectionPool*  pool,
+                Server::Private* serverPrivate,
+                unsigned         threadId,
+                unsigned long    maximumBufferSize,
+                QObject*         parent = nullptr
             );
 
             ~Connection() override;
@@ -80,17 +94,62 @@ namespace RestApiInV1 {
 
             /**
              * Method you can use to get the next bolus of available data.  This method will block until there is at
-             * least some data available.
+             * least some data available.  Reads never extend past the end of the request body.
              *
              * \param[in,out] buffer      The buffer to hold the current receive data.
              *
              * \param[in]     maximumSize The maximum number of bytes of data to obtain.  A value of 0 indicates that
              *                            the current default maximum value should be used.
              *
-             * \return Returns true on success or false on error.
+             * \return Returns true on success or false on error or if the request body has been fully read.
              */
             bool readData(QByteArray& buffer, unsigned long maximumSize = 0) final;
 
+            /**
+             * Method you can use to read request body data directly into memory you supply.  This method will block
+             * until there is at least some data available.  Reads never extend past the end of the request body.
+             *
+             * \param[in]  buffer     The memory to receive the data.
+             *
+             * \param[in]  bufferSize The number of bytes the buffer can hold.
+             *
+             * \param[out] bytesRead  Receives the number of bytes placed in the buffer.
+             *
+             * \return Returns true on success or false on error or if the request body has been fully read.
+             */
+            bool readData(char* buffer, unsigned long long bufferSize, unsigned long long& bytesRead) final;
+
+            /**
+             * Method you can use to read the entire request body.  When the client supplies a "Content-Length"
+             * header, a pooled buffer is sized once up front and filled in place.  Bodies larger than the limit are
+             * answered with \ref Handler::StatusCode::REQUEST_ENTITY_TOO_LARGE.
+             *
+             * \param[out] body        The buffer to receive the request body.
+             *
+             * \param[in]  maximumSize The largest body to accept, in bytes.  A value of 0 indicates that the limit
+             *                         reported by the handler should be used.
+             *
+             * \return Returns true on success.  Returns false on error.  The session answers the client on error so
+             *         no further response should be sent.
+             */
+            bool readBody(QByteArray& body, unsigned long long maximumSize = 0) final;
+
+            /**
+             * Method you can use to process the request body as it arrives.  Data is handed to the receiver directly
+             * from the receive buffer unless the body must be decoded first.  Bodies larger than the limit are
+             * answered with \ref Handler::StatusCode::REQUEST_ENTITY_TOO_LARGE.
+             *
+             * \param[in] receiver    The receiver to be handed the request body.
+             *
+             * \param[in] maximumSize The largest body to accept, in bytes.  A value of 0 indicates that the limit
+             *                        reported by the handler should be used.
+             *
+             * \return Returns true once the entire body has been handed to the receiver.  Returns false on error or
+             *         if the receiver stopped early.
+             */
+            bool readBody(BodyReceiver& receiver, unsigned long long maximumSize = 0) final;
+
+
             /**
              * Method you can use to get a single line of data.  This method will block until a full line is read.
              *
@@ -106,6 +165,8 @@ namespace RestApiInV1 {
 
             /**
              * Method you can use to send response status.  Always call this method before sending any response data.
+             * The "Connection" header is managed by this class.  Responses without a "Content-Length" header will
+             * cause the connection to be closed once the response is sent.
              *
              * \param[in] statusCode      The response status code.
              *
@@ -128,14 +189,84 @@ namespace RestApiInV1 {
             bool sendFailedResponse(Handler::StatusCode statusCode) final;
 
             /**
-             * Method you can use to send response data.
+             * Method you can use to send a complete response.  The "Content-Length" header is set from the body.
+             * Small bodies are sent in the same write as the status line and headers.
              *
-             * \param[in] data The raw data to be sent.
+             * \param[in] statusCode      The response status code.
+             *
+             * \param[in] responseHeaders The response headers.
+             *
+             * \param[in] body            The response body.
              *
              * \return Returns true on success.  Returns false on error.
              */
+            bool sendResponse(
+                Handler::StatusCode     statusCode,
+                const Handler::Headers& responseHeaders,
+                const QByteArray&       body
+            ) final;
+
+            /**
+             * Method you can use to send response data.  Data is handed to the socket no faster than the client
+             * accepts it so no more than the server's outbound buffer limit is ever held for this connection.
+             *
+             * \param[in] data The raw data to be sent.
+             *
+             * \return Returns true on success.  Returns false on error or timeout.
+             */
             bool sendData(const QByteArray& data) final;
 
+            /**
+             * Method you can use to determine how much response data is buffered waiting for the client.
+             *
+             * \return Returns the number of buffered bytes.
+             */
+            unsigned long long bufferedOutboundBytes() const final;
+
+            /**
+             * Method you can use to send a response whose length is not known when the response starts.  HTTP/1.1
+             * clients receive the body using "Transfer-Encoding: chunked".  Older clients receive the body as is
+             * and the connection is closed once it is sent.
+             *
+             * \param[in] statusCode      The response status code.
+             *
+             * \param[in] responseHeaders The response headers.
+             *
+             * \param[in] generator       The generator that produces the response body.
+             *
+             * \return Returns true on success.  Returns false on error or if the generator failed.
+             */
+            bool sendStreamedResponse(
+                Handler::StatusCode     statusCode,
+                const Handler::Headers& responseHeaders,
+                BodyGenerator&          generator
+            ) final;
+
+            /**
+             * Method you can use to send a response whose body is a range of an open file.  On Linux, the file is
+             * sent using sendfile.  Elsewhere, or if sendfile is not supported for the file, the file is memory
+             * mapped and sent in pieces.
+             *
+             * \param[in] statusCode      The response status code.
+             *
+             * \param[in] responseHeaders The response headers.
+             *
+             * \param[in] fileDescriptor  The descriptor of the file to be sent.
+             *
+             * \param[in] offset          The offset to the first byte to be sent.
+             *
+             * \param[in] length          The number of bytes to be sent.
+             *
+             * \return Returns true on success.  Returns false on error.
+             */
+            bool sendFileResponse(
+                Handler::StatusCode     statusCode,
+                const Handler::Headers& responseHeaders,
+                int                     fileDescriptor,
+                unsigned long long      offset,
+                unsigned long long      length
+            ) final;
+
             /**
              * Method you can use to obtain the current request URI.
              *
@@ -143,6 +274,23 @@ namespace RestApiInV1 {
              */
             const QUrl& requestUri() const final;
 
+            /**
+             * Method you can use to obtain the path portion of the request URI.  Unlike \ref requestUri, this method
+             * does not invoke the full URI parser for typical origin-form request targets.
+             *
+             * \return Returns the decoded request path.
+             */
+            const QString& path() const final;
+
+            /**
+             * Method you can use to obtain a value captured from the request path by the handler's path pattern.
+             *
+             * \param[in] name The parameter name, without braces.  Use "*" for the trailing wildcard.
+             *
+             * \return Returns the parameter value.  An empty string is returned if the parameter is not present.
+             */
+            QString pathParameter(const QString& name) const final;
+
             /**
              * Method you can use to obtain the current access method.
              *
@@ -164,6 +312,35 @@ namespace RestApiInV1 {
              */
             const Handler::Headers& headers() const final;
 
+            /**
+             * Method you can use to obtain a single request header.  The lookup is case insensitive and does not
+             * build the full header table.
+             *
+             * \param[in] name The lower case header name.
+             *
+             * \return Returns the header value.  An empty value is returned if the header is not present.
+             */
+            QByteArray header(const QByteArray& name) const final;
+
+            /**
+             * Method you can use to obtain the status line for a status code, less the HTTP version.
+             *
+             * \param[in] statusCode The response status code.
+             *
+             * \return Returns the status line, including the trailing newline.
+             */
+            static QByteArray statusLine(Handler::StatusCode statusCode);
+
+            /**
+             * Method you can use to obtain a complete HTTP/1.1 response with an empty body that closes the
+             * connection.  Used to refuse requests before a worker is assigned.
+             *
+             * \param[in] statusCode The response status code.
+             *
+             * \return Returns the response.
+             */
+            static QByteArray closingResponse(Handler::StatusCode statusCode);
+
         signals:
             /**
              * Signal that is emitted when the thread finishes.
@@ -182,12 +359,159 @@ namespace RestApiInV1 {
         public slots:
             /**
              * Method you can use to set the underlying socket descriptor and to start processing of the request.
+             * The worker must be idle when this method is called.
              *
              * \param[in] socketDescriptor The socket descriptor to be processed.
+             *
+             * \param[in] loggingFunction  The function to be used for logging during this session.
+             *
+             * \param[in] receivedData     Data already read from the socket.  This data is consumed before any
+             *                             further data is read from the socket.
+             *
+             * \param[in] eventThread      The I/O thread that handed us this socket.  The socket is returned to
+             *                             this thread when the connection goes idle between requests.  A null
+             *                             pointer indicates the worker should wait on the socket itself.
+             */
+            void startSession(
+                qintptr                 socketDescriptor,
+                Server::LoggingFunction loggingFunction,
+                const QByteArray&       receivedData = QByteArray(),
+                EventThread*            eventThread = nullptr
+            );
+
+            /**
+             * Method you can use to cause an idle worker to exit.  Call QThread::wait to wait for the worker to
+             * finish.
              */
-            void startSession(qintptr socketDescriptor);
+            void stop();
 
         private:
+            /**
+             * Writer used to send streamed response bodies.  Small writes are gathered so each chunk carries a
+             * reasonable amount of data.
+             */
+            class ChunkWriter:public BodyWriter {
+                public:
+                    /**
+                     * Constructor
+                     *
+                     * \param[in] connection The connection used to send the body.
+                     *
+                     * \param[in] chunked    If true, the body is sent using chunked encoding.  If false, the body is
+                     *                       sent as is.
+                     */
+                    ChunkWriter(Connection* connection, bool chunked);
+
+                    /**
+                     * Method you can use to write the next piece of the response body.
+                     *
+                     * \param[in] data   Pointer to the data to be written.
+                     *
+                     * \param[in] length The number of bytes to be written.
+                     *
+                     * \return Returns true on success.  Returns false on error.
+                     */
+                    bool writeBodyData(const char* data, unsigned long length) override;
+
+                    using BodyWriter::writeBodyData;
+
+                    /**
+                     * Method that sends any gathered data and ends the body.
+                     *
+                     * \return Returns true on success.  Returns false on error.
+                     */
+                    bool finish();
+
+                private:
+                    /**
+                     * Method that sends any gathered data.
+                     *
+                     * \return Returns true on success.  Returns false on error.
+                     */
+                    bool flush();
+
+                    /**
+                     * Method that sends a single chunk.
+                     *
+                     * \param[in] data   Pointer to the chunk data.
+                     *
+                     * \param[in] length The length of the chunk, in bytes.
+                     *
+                     * \return Returns true on success.  Returns false on error.
+                     */
+                    bool sendChunk(const char* data, unsigned long length);
+
+                    /**
+                     * The connection used to send the body.
+                     */
+                    Connection* currentConnection;
+
+                    /**
+                     * Flag indicating if chunked encoding is used.
+                     */
+                    bool currentChunked;
+
+                    /**
+                     * Data gathered for the next chunk.
+                     */
+                    QByteArray pendingData;
+            };
+
+            /**
+             * Receiver used to gather a decoded request body into a single buffer.
+             */
+            class BodyCollector:public BodyReceiver {
+                public:
+                    /**
+                     * Constructor
+                     *
+                     * \param[in] body The buffer to receive the body.
+                     */
+                    BodyCollector(QByteArray& body);
+
+                    /**
+                     * Method that appends the next piece of the body.
+                     *
+                     * \param[in] data   Pointer to the received data.
+                     *
+                     * \param[in] length The number of bytes received.
+                     *
+                     * \return Returns true to continue receiving the body.
+                     */
+                    bool receiveBodyData(const char* data, unsigned long length) final;
+
+                private:
+                    /**
+                     * The buffer receiving the body.
+                     */
+                    QByteArray& currentBody;
+            };
+
+            /**
+             * Type used to describe one piece of a response body taken from a larger body.
+             */
+            struct BodySegment {
+                /**
+                 * Data sent ahead of the piece, such as a multipart part header.
+                 */
+                QByteArray prefix;
+
+                /**
+                 * The offset to the first byte of the piece.
+                 */
+                unsigned long long offset;
+
+                /**
+                 * The number of bytes in the piece.
+                 */
+                unsigned long long length;
+            };
+
+            /**
+             * Type used to hold the pieces of a response body.
+             */
+            typedef QVector<BodySegment> BodySegments;
+
             /**
              * Hash table used to convert handler methods into strings.
              */
@@ -198,6 +522,74 @@ namespace RestApiInV1 {
              */
             static const QHash<Handler::StatusCode, QByteArray> reasonPhraseByStatusCode;
 
+            /**
+             * The number of entries in the status line table.  Status codes are three digit values.
+             */
+            static constexpr unsigned statusLineTableSize = 600;
+
+            /**
+             * The largest body we copy into the response head buffer so it can be sent in a single write, in
+             * bytes.
+             */
+            static constexpr unsigned long maximumCoalescedBodyLength = 16384;
+
+            /**
+             * Space reserved in the response head buffer for the headers we add, in bytes.
+             */
+            static constexpr int responseHeadSlack = 64;
+
+            /**
+             * The size of the chunks used to send streamed response bodies, in bytes.  Larger writes are sent as a
+             * single chunk.
+             */
+            static constexpr unsigned long streamedChunkLength = 16384;
+
+            /**
+             * The chunk that ends a chunked body.
+             */
+            static const QByteArray lastChunk;
+
+            /**
+             * The most file data we hand to the kernel in a single sendfile call, in bytes.
+             */
+            static constexpr unsigned long long maximumSendFileLength = 1048576;
+
+            /**
+             * The size of the window mapped at one time when a file can not be sent directly, in bytes.
+             */
+            static constexpr unsigned long long fileMappingWindowLength = 4194304;
+
+            /**
+             * The most ranges we honor in a single range request.  Requests asking for more receive the whole body.
+             */
+            static constexpr int maximumRangeCount = 16;
+
+            /**
+             * The most digits we accept in a byte position.
+             */
+            static constexpr int maximumBytePositionDigits = 19;
+
+            /**
+             * The content type used for responses carrying multiple ranges, up to the boundary.
+             */
+            static const QByteArray multipartByterangesPrefix;
+
+            /**
+             * The range unit, followed by a space, as used in the "content-range" header.
+             */
+            static const QByteArray contentRangeBytesPrefix;
+
+            /**
+             * The dashes that introduce a multipart boundary.
+             */
+            static const QByteArray boundaryDashes;
+
+            /**
+             * Table of precomputed status lines, less the HTTP version, indexed by status code.  Entries for
+             * unrecognized status codes are empty.
+             */
+            static const QVector<QByteArray> statusLineByStatusCode;
+
             /**
              * The default reason phrase to use if a status code is not recognized.
              */
@@ -219,88 +611,813 @@ namespace RestApiInV1 {
             static const QByteArray colon;
 
             /**
-             * Method that manages the underlying connection.
+             * The HTTP/1.0 version string.
              */
-            void run() override;
+            static const QByteArray http10String;
 
             /**
-             * Method that handles the incoming request and outgoing response.
+             * The HTTP/1.1 version string.
              */
-            void processRequest();
+            static const QByteArray http11String;
 
             /**
-             * Method that writes a log entry.
+             * The interim response sent to clients waiting to send a request body.
+             */
+            static const QByteArray continueResponse;
+
+            /**
+             * The length of the longest method name we recognize.
+             */
+            static constexpr unsigned long maximumMethodLength = 16;
+
+            /**
+             * The largest unread request body we will discard in order to keep a connection open, in bytes.
+             */
+            static constexpr unsigned long maximumDrainLength = 65536;
+
+            /**
+             * The number of bytes we pull from the socket into the receive buffer at one time.
+             */
+            static constexpr int receiveChunkSize = 16384;
+
+            /**
+             * The longest chunk size line we accept, in bytes, including any chunk extensions.
+             */
+            static constexpr int maximumChunkLineLength = 4096;
+
+            /**
+             * The most hexadecimal digits we accept in a chunk size.  This keeps the size within a long long.
+             */
+            static constexpr int maximumChunkSizeDigits = 15;
+
+            /**
+             * Method that builds the status line table.
              *
-             * \param[in] message The log message to be included.
+             * \return Returns the status line table.
+             */
+            static QVector<QByteArray> buildStatusLines();
+
+            /**
+             * Method that assembles the status line and headers of a response into a single buffer.  This method also
+             * decides if the connection will be kept open after the response.
              *
-             * \param[in] error   If true, then this is an error message.
+             * \param[in] statusCode         The response status code.
+             *
+             * \param[in] responseHeaders    The response headers.
+             *
+             * \param[in] contentLength      The content length to report.  A negative value indicates that any
+             *                               "Content-Length" header supplied by the caller should be used.
+             *
+             * \param[in] reservedBodyLength Additional space to reserve for a body appended by the caller.
+             *
+             * \return Returns the response head.
              */
-            void writeLog(const QString& message, bool error) const;
+            QByteArray buildResponseHead(
+                Handler::StatusCode     statusCode,
+                const Handler::Headers& responseHeaders,
+                long long               contentLength,
+                int                     reservedBodyLength
+            );
 
             /**
-             * Method that parses a method string into a handler method.
+             * Method that determines if a response must be sent without a body.  Responses to HEAD requests and
+             * responses with status 204 or 304 keep their headers, including "Content-Length", but never carry body
+             * bytes.
              *
-             * \param[in] methodString The method string to be parsed.
+             * \param[in] statusCode The response status code.
              *
-             * \return Returns the method enumerated value.  The value Handler::Method::NUMBER_METHODS is returned if
-             *         the supplied method is unknown.
+             * \return Returns true if no body may be sent.
              */
-            static Handler::Method toMethod(const QByteArray& methodString);
+            bool bodylessResponse(Handler::StatusCode statusCode) const;
 
             /**
-             * The underlying server private instance.
+             * Method that waits for sessions and processes them until the worker is stopped.
              */
-            Server::Private* currentServerPrivate;
+            void run() override;
 
             /**
-             * The current socket descriptor.
+             * Method that manages a single connection.
              */
-            qintptr currentSocketDescriptor;
+            void processSession();
 
             /**
-             * The current thread ID of this thread.
+             * Method that hands the session socket back to the I/O thread that provided it and releases the thread.
+             * The socket is closed if the I/O thread can not take it.
              */
-            unsigned currentThreadId;
+            void returnSessionSocket();
 
             /**
-             * The current maximum read buffer size.
+             * Method that closes the session socket and releases the I/O thread if the socket was provided by an
+             * I/O thread.  Sockets provided directly are owned, and closed, by the QTcpSocket instance.
              */
-            unsigned long currentMaximumBufferSize;
+            void closeSessionSocket();
 
             /**
-             * Value holding the current number of bytes available for reading.
+             * Method that handles the incoming request and outgoing response.
+             *
+             * \return Returns true if the connection can be used for another request.  Returns false if the
+             *         connection should be closed.
              */
-            unsigned long long bytesAvailable;
+            bool processRequest();
 
             /**
-             * Mutex used to gate this session.
+             * Method that reads and parses the request head in place in the receive buffer.  A failed response is
+             * sent if the head can not be read or is malformed.
+             *
+             * \return Returns true on success.  Returns false on error.
              */
-            QSemaphore currentSessionSemaphore;
+            bool readRequestHead();
 
             /**
-             * The active socket.
+             * Method that locates the next line in the receive buffer, reading more data from the socket as needed.
+             * The returned line points into the receive buffer and is only valid until the next read.
+             *
+             * \param[in]  maximumSize The maximum line length.  A value of 0 indicates that the current default
+             *                         maximum value should be used.  Longer lines are returned in pieces.
+             *
+             * \param[out] line        Pointer to the start of the line.
+             *
+             * \param[out] lineLength  The length of the line, excluding the line terminator.
+             *
+             * \param[out] terminated  Set to true if the line terminator was found.  Set to false if the line was
+             *                         cut short by the size limit or the end of the body or chunk.
+             *
+             * \return Returns true on success.  Returns false on error.
              */
-            QTcpSocket* currentSocket;
+            bool nextLine(unsigned long maximumSize, const char*& line, int& lineLength, bool& terminated);
 
             /**
-             * The request URI for this connection.
+             * Method that positions the body reader at the next body data.  For chunked bodies, the chunk framing is
+             * read once the current chunk has been consumed, and the trailers are read after the last chunk.  On
+             * return, a remaining body length of zero indicates the body has been fully read.
+             *
+             * \return Returns true on success.  Returns false on error or if the chunk framing is malformed.
              */
-            QUrl currentRequestUri;
+            bool startBodyData();
 
             /**
-             * The current connection method.
+             * Method that hands the request body, as sent, to a receiver directly from the receive buffer.
+             *
+             * \param[in] receiver    The receiver to be handed the request body.
+             *
+             * \param[in] maximumSize The largest body to accept, in bytes.  A value of 0 indicates no limit.
+             *
+             * \return Returns true once the entire body has been handed to the receiver.  Returns false on error or
+             *         if the receiver stopped early.
              */
-            Handler::Method currentMethod;
+            bool readEncodedBody(BodyReceiver& receiver, unsigned long long maximumSize);
+
+            /**
+             * Method that reads a chunk size or trailer line from the receive buffer.  The returned line points into
+             * the receive buffer and is only valid until the next read.
+             *
+             * \param[out] line       Pointer to the start of the line.
+             *
+             * \param[out] lineLength The length of the line, excluding the line terminator.
+             *
+             * \return Returns true on success.  Returns false on error or if the line is too long.
+             */
+            bool readChunkLine(const char*& line, int& lineLength);
+
+            /**
+             * Method that reads the trailers that follow the last chunk of a chunked body.
+             *
+             * \return Returns true on success.  Returns false on error or if a trailer is malformed.
+             */
+            bool readTrailers();
+
+            /**
+             * Method that parses the size from a chunk size line.  Chunk extensions are ignored.
+             *
+             * \param[in]  line       The chunk size line.
+             *
+             * \param[in]  lineLength The length of the line, in bytes.
+             *
+             * \param[out] chunkSize  Receives the chunk size, in bytes.
+             *
+             * \return Returns true on success.  Returns false if the size is malformed or too large.
+             */
+            static bool parseChunkSize(const char* line, int lineLength, long long& chunkSize);
+
+            /**
+             * Method that discards consumed data from the receive buffer and appends any data available on the
+             * socket, waiting for data if none is available.
+             *
+             * \return Returns true on success.  Returns false on error.
+             */
+            bool fillReceiveBuffer();
+
+            /**
+             * Method that waits for data from the client until the current phase or request deadline expires.
+             *
+             * \return Returns true if data is available.  Returns false on error or timeout.
+             */
+            bool waitForReadable();
+
+            /**
+             * Method that waits for buffered response data to be sent until the current phase or request deadline
+             * expires.
+             *
+             * \return Returns true if data was written.  Returns false on error or timeout.
+             */
+            bool waitForWritten();
+
+            /**
+             * Method that waits until the socket holds less than \ref outboundLimit bytes of response data.  This
+             * keeps fast producers from buffering an entire response in memory.
+             *
+             * \return Returns true on success.  Returns false on error or timeout.
+             */
+            bool waitForOutboundSpace();
+
+            /**
+             * Method that compresses a response body if the handler allows it and the client accepts a coding we
+             * support.
+             *
+             * \param[in]  statusCode      The response status code.
+             *
+             * \param[in]  responseHeaders The response headers.
+             *
+             * \param[in]  body            The response body.
+             *
+             * \param[out] encodedHeaders  Receives the headers to send with the encoded body.
+             *
+             * \param[out] encodedBody     Receives the encoded body.
+             *
+             * \return Returns true if the body was encoded.  Returns false if the body should be sent as is.
+             */
+            bool encodeResponse(
+                Handler::StatusCode     statusCode,
+                const Handler::Headers& responseHeaders,
+                const QByteArray&       body,
+                Handler::Headers&       encodedHeaders,
+                QByteArray&             encodedBody
+            );
+
+            /**
+             * Method that sends a complete response without considering byte ranges.
+             *
+             * \param[in] statusCode      The response status code.
+             *
+             * \param[in] responseHeaders The response headers.
+             *
+             * \param[in] body            The response body.
+             *
+             * \return Returns true on success.  Returns false on error.
+             */
+            bool sendCompleteResponse(
+                Handler::StatusCode     statusCode,
+                const Handler::Headers& responseHeaders,
+                const QByteArray&       body
+            );
+
+            /**
+             * Method that decides which parts of a response body are sent based on the request's "Range" and
+             * "If-Range" headers.  Successful responses to GET and HEAD requests gain "Accept-Ranges: bytes" unless
+             * the handler supplied its own "Accept-Ranges" header.
+             *
+             * \param[in]  statusCode       The status code the handler asked for.
+             *
+             * \param[in]  responseHeaders  The headers the handler asked for.
+             *
+             * \param[in]  bodyLength       The length of the complete body, in bytes.
+             *
+             * \param[out] rangedHeaders    Receives the headers to send.
+             *
+             * \param[out] segments         Receives the pieces of the body to send, in order.
+             *
+             * \param[out] closingDelimiter Receives data to send after the last piece.
+             *
+             * \return Returns the status code to send.  The status code is unchanged if the whole body is sent.
+             */
+            Handler::StatusCode selectRanges(
+                Handler::StatusCode     statusCode,
+                const Handler::Headers& responseHeaders,
+                unsigned long long      bodyLength,
+                Handler::Headers&       rangedHeaders,
+                BodySegments&           segments,
+                QByteArray&             closingDelimiter
+            ) const;
+
+            /**
+             * Method that parses a "Range" header.  Overlapping and adjacent ranges are merged and ranges that start
+             * past the end of the body are dropped.
+             *
+             * \param[in]  value      The header value.
+             *
+             * \param[in]  bodyLength The length of the complete body, in bytes.
+             *
+             * \param[out] ranges     Receives the satisfiable ranges, in ascending order.
+             *
+             * \return Returns true if the header is well formed.  Returns false if the header is malformed, uses
+             *         an unknown unit, or names too many ranges.
+             */
+            static bool parseRanges(const QByteArray& value, unsigned long long bodyLength, BodySegments& ranges);
+
+            /**
+             * Method that parses a byte position from a "Range" header.
+             *
+             * \param[in]  value    The text to parse.
+             *
+             * \param[out] position Receives the position.
+             *
+             * \return Returns true on success.  Returns false if the text is not a valid position.
+             */
+            static bool parseBytePosition(const QByteArray& value, unsigned long long& position);
+
+            /**
+             * Method that determines if an "If-Range" validator matches the response.  Weak entity tags never match.
+             *
+             * \param[in] validator       The "If-Range" header value.
+             *
+             * \param[in] responseHeaders The response headers.
+             *
+             * \return Returns true if the validator matches the response's entity tag or last modified date.
+             */
+            static bool ifRangeMatches(const QByteArray& validator, const Handler::Headers& responseHeaders);
+
+            /**
+             * Method that builds a "content-range" header value.
+             *
+             * \param[in] range      The range being sent.
+             *
+             * \param[in] bodyLength The length of the complete body, in bytes.
+             *
+             * \return Returns the header value.
+             */
+            static QByteArray contentRange(const BodySegment& range, unsigned long long bodyLength);
+
+            /**
+             * Method that sends a range of a file directly from the file system.  Data already queued on the socket
+             * is sent first.
+             *
+             * \param[in] fileDescriptor The descriptor of the file to be sent.
+             *
+             * \param[in] offset         The offset to the first byte to be sent.
+             *
+             * \param[in] length         The number of bytes to be sent.
+             *
+             * \return Returns true on success.  Returns false on error.
+             */
+            bool sendFileRange(int fileDescriptor, unsigned long long offset, unsigned long long length);
+
+            /**
+             * Method that sends a range of a file by memory mapping it a window at a time.
+             *
+             * \param[in] fileDescriptor The descriptor of the file to be sent.
+             *
+             * \param[in] offset         The offset to the first byte to be sent.
+             *
+             * \param[in] length         The number of bytes to be sent.
+             *
+             * \return Returns true on success.  Returns false on error.
+             */
+            bool sendMappedFileRange(int fileDescriptor, unsigned long long offset, unsigned long long length);
+
+            /**
+             * Method that waits until the socket can accept more data, bypassing the QTcpSocket write buffer.
+             *
+             * \return Returns true if the socket is writable.  Returns false on error or timeout.
+             */
+            bool waitForSocketWritable();
+
+            /**
+             * Method that records a timeout if either the phase or the request deadline has expired.  The connection
+             * will not be reused after a timeout.
+             */
+            void checkDeadlines();
+
+            /**
+             * Method that determines how long we may wait on the client.
+             *
+             * \return Returns the time until the earlier of the phase and request deadlines, in milliseconds.  A value
+             *         of -1 indicates no limit.
+             */
+            int remainingTime() const;
+
+            /**
+             * Method that builds a deadline from a timeout.
+             *
+             * \param[in] timeout The timeout, in milliseconds.  A value of 0 indicates no limit.
+             *
+             * \return Returns the deadline.
+             */
+            static QDeadlineTimer deadlineAfter(unsigned timeout);
+
+            /**
+             * Method that determines the length of the request body from the request headers.  A failed response is
+             * sent, and the connection closed, if the length is invalid or the framing is ambiguous: several
+             * "Content-Length" fields, both "Transfer-Encoding" and "Content-Length", or a "Transfer-Encoding" whose
+             * final coding is not chunked.
+             *
+             * \return Returns true on success.  Returns false on error.
+             */
+            bool prepareRequestBody();
+
+            /**
+             * Method that determines if the client and server settings allow the connection to be reused after the
+             * current request.
+             *
+             * \return Returns true if the connection can be reused.  Returns false if the connection must be closed.
+             */
+            bool requestAllowsKeepAlive() const;
+
+            /**
+             * Method that determines if any of the request body remains to be read.
+             *
+             * \return Returns true if body data remains.  Returns false if the body has been fully read.
+             */
+            bool requestBodyPending() const;
+
+            /**
+             * Method that checks a request body against a size limit.  Bodies over the limit are answered with
+             * \ref Handler::StatusCode::REQUEST_ENTITY_TOO_LARGE.
+             *
+             * \param[in] bodySize    The size of the request body, in bytes.
+             *
+             * \param[in] maximumSize The largest body to accept, in bytes.  A value of 0 indicates no limit.
+             *
+             * \return Returns true if the body is within the limit.  Returns false if the body is too large.
+             */
+            bool checkBodySize(unsigned long long bodySize, unsigned long long maximumSize);
+
+            /**
+             * Method that applies the checks that can be made before the request body is read: the "Expect" header,
+             * the handler's body size limit and the handler's own header checks.  A failed response is sent if any
+             * check fails.
+             *
+             * \param[in] handler The handler servicing the request.
+             *
+             * \return Returns true if the request was accepted.  Returns false if the request was refused.
+             */
+            bool checkRequestHead(Handler* handler);
+
+            /**
+             * Method that tells a client waiting on "Expect: 100-continue" to send the request body.  The interim
+             * response is only sent once, on the first read of the body.
+             *
+             * \return Returns true on success.  Returns false on error.
+             */
+            bool sendContinue();
+
+            /**
+             * Method that reads and discards any request body the handler left unread.
+             *
+             * \return Returns true on success.  Returns false on error.
+             */
+            bool discardRequestBody();
+
+            /**
+             * Method that writes a log entry.
+             *
+             * \param[in] message The log message to be included.
+             *
+             * \param[in] error   If true, then this is an error message.
+             */
+            void writeLog(const QString& message, bool error) const;
+
+            /**
+             * Method that parses the request method into a handler method.
+             *
+             * \param[in] methodSpan The location of the method in the request head.
+             *
+             * \return Returns the method enumerated value.  The value Handler::Method::NUMBER_METHODS is returned if
+             *         the supplied method is unknown.
+             */
+            Handler::Method toMethod(const RequestParser::Span& methodSpan) const;
+
+            /**
+             * Method that locates the handler for the current request and records the path parameters.
+             *
+             * \return Returns a pointer to the handler.  A null pointer is returned if there is no matching handler.
+             */
+            Handler* routeRequest();
+
+            /**
+             * Method that obtains a pointer to the path the current request was routed on.  Path parameters are
+             * offsets into this path.
+             *
+             * \return Returns a pointer to the routed path.
+             */
+            const char* routedPathData() const;
+
+            /**
+             * Method that determines if a request target is an origin-form path that needs no decoding.
+             *
+             * \param[in]  target       The request target.
+             *
+             * \param[in]  targetLength The length of the request target, in bytes.
+             *
+             * \param[out] pathLength   Receives the length of the path, excluding any query or fragment.
+             *
+             * \return Returns true if the path can be used as received.  Returns false if the target must be parsed.
+             */
+            static bool isPlainPath(const char* target, unsigned long targetLength, unsigned long& pathLength);
+
+            /**
+             * Method that locates a request header field.
+             *
+             * \param[in] name The lower case header name.
+             *
+             * \return Returns a pointer to the field.  A null pointer is returned if the header is not present.
+             */
+            const RequestParser::Field* findHeader(const QByteArray& name) const;
+
+            /**
+             * Method that counts the request header fields with a given name.
+             *
+             * \param[in]  name      The lower case header name.
+             *
+             * \param[out] lastField Receives a pointer to the last matching field.  A null pointer is returned if
+             *                       the header is not present.
+             *
+             * \return Returns the number of matching fields.
+             */
+            unsigned countHeaders(const QByteArray& name, const RequestParser::Field*& lastField) const;
+
+            /**
+             * Method that converts a span of the request head to a string.
+             *
+             * \param[in] span The span to be converted.
+             *
+             * \return Returns the span as a string.
+             */
+            QString toString(const RequestParser::Span& span) const;
+
+            /**
+             * Method that compares a span of the request head against a value.  The comparison is case sensitive.
+             *
+             * \param[in] span  The span to be compared.
+             *
+             * \param[in] value The value to compare against.
+             *
+             * \return Returns true if the span matches the value.  Returns false otherwise.
+             */
+            bool spanEquals(const RequestParser::Span& span, const QByteArray& value) const;
+
+            /**
+             * Method that determines the HTTP version to report in the response status line.
+             *
+             * \return Returns the version echoed from the request.
+             */
+            QByteArray responseVersion() const;
+
+            /**
+             * Method that obtains a pointer to the start of the current request head.
+             *
+             * \return Returns a pointer to the request head in the receive buffer.
+             */
+            inline const char* headData() const {
+                return receiveBuffer.constData() + requestHeadOffset;
+            }
+
+            /**
+             * Method that determines if a comma separated header value contains a token.  The comparison is case
+             * insensitive and the value is scanned in place so nothing is allocated.
+             *
+             * \param[in] value The header value to be searched.
+             *
+             * \param[in] token The lower case token to search for.
+             *
+             * \return Returns true if the token is present.  Returns false if the token is not present.
+             */
+            static bool containsToken(const QByteArray& value, const QByteArray& token);
+
+            /**
+             * Method that compares one element of a comma separated header value against a token.  Surrounding
+             * spaces and tabs are ignored and the comparison is case insensitive.
+             *
+             * \param[in] element       Pointer to the start of the element.
+             *
+             * \param[in] elementLength The length of the element, in bytes.
+             *
+             * \param[in] token         The lower case token to compare against.
+             *
+             * \return Returns true if the element is the token.
+             */
+            static bool tokenEquals(const char* element, int elementLength, const QByteArray& token);
+
+            /**
+             * The pool that owns this worker.
+             */
+            ConnectionPool* currentPool;
+
+            /**
+             * The underlying server private instance.
+             */
+            Server::Private* currentServerPrivate;
+
+            /**
+             * The current socket descriptor.
+             */
+            qintptr currentSocketDescriptor;
+
+            /**
+             * The current thread ID of this thread.
+             */
+            unsigned currentThreadId;
+
+            /**
+             * The current maximum read buffer size.
+             */
+            unsigned long currentMaximumBufferSize;
+
+            /**
+             * Buffer holding data read from the socket, or handed to us by an \ref EventThread, that has not yet
+             * been consumed.  The request line and headers are parsed in place from this buffer.
+             */
+            QByteArray receiveBuffer;
+
+            /**
+             * The offset to the next unread byte in the receive buffer.
+             */
+            int receiveBufferOffset;
+
+            /**
+             * The offset to the current request head in the receive buffer.  A negative value indicates that no
+             * request head has been parsed.  The head is held in the buffer until the next request begins.
+             */
+            int requestHeadOffset;
+
+            /**
+             * Parser used to locate the request line and header fields in the receive buffer.
+             */
+            RequestParser requestParser;
+
+            /**
+             * Flag indicating that \ref currentRequestUri holds the parsed URI for this request.
+             */
+            mutable bool requestUriValid;
+
+            /**
+             * Flag indicating that \ref currentPath holds the path for this request.
+             */
+            mutable bool pathValid;
+
+            /**
+             * Flag indicating that \ref currentHttpVersion holds the version for this request.
+             */
+            mutable bool httpVersionValid;
+
+            /**
+             * Flag indicating that \ref currentHeaders holds the header table for this request.
+             */
+            mutable bool headersValid;
+
+            /**
+             * The number of request body bytes not yet read.  A negative value indicates that the body length is
+             * not known.
+             */
+            long long requestBodyRemaining;
+
+            /**
+             * Flag indicating that the request body uses chunked transfer encoding.  For chunked bodies,
+             * \ref requestBodyRemaining holds the bytes remaining in the current chunk.
+             */
+            bool requestBodyChunked;
+
+            /**
+             * Flag indicating that the last chunk and the trailers of a chunked body have been read.
+             */
+            bool chunkedBodyComplete;
+
+            /**
+             * Flag indicating that chunk data has been read and the line terminator that follows it has not.
+             */
+            bool chunkDataPending;
+
+            /**
+             * Flag indicating that the chunk framing of the request body was malformed.  The connection will not be
+             * reused.
+             */
+            bool requestBodyMalformed;
+
+            /**
+             * The content coding applied to the request body.
+             */
+            ContentCoding requestBodyCoding;
+
+            /**
+             * Trailers received after the last chunk of a chunked body.
+             */
+            Handler::Headers requestTrailers;
+
+            /**
+             * The number of requests serviced on the current connection, including the current request.
+             */
+            unsigned currentRequestCount;
+
+            /**
+             * Flag indicating if the connection will be kept open after the current response.
+             */
+            bool currentKeepAlive;
+
+            /**
+             * Flag indicating if a response header has been sent for the current request.
+             */
+            bool responseStarted;
+
+            /**
+             * Flag indicating that a request deadline expired.  Timed out connections are dropped rather than closed
+             * gracefully.
+             */
+            bool requestTimedOut;
+
+            /**
+             * Flag indicating that the client is waiting on "100 Continue" before sending the request body.  If a
+             * final response is sent first, we can not know if the body will follow so the connection is closed.
+             */
+            bool continuePending;
+
+            /**
+             * The most response data we let the socket hold before waiting on the client, in bytes.  A value of 0
+             * indicates no limit.  Sampled from the server at the start of each request.
+             */
+            qint64 outboundLimit;
+
+            /**
+             * The deadline for the current phase of the request, that is, receiving the head, receiving the body, or
+             * sending the response.
+             */
+            QDeadlineTimer phaseDeadline;
+
+            /**
+             * The deadline for the entire request.
+             */
+            QDeadlineTimer requestDeadline;
+
+            /**
+             * The I/O thread that provided the current socket.  A null pointer is used if the socket was provided
+             * directly.
+             */
+            EventThread* currentEventThread;
+
+            /**
+             * Semaphore used to hand sessions to this worker.
+             */
+            QSemaphore currentSessionSemaphore;
+
+            /**
+             * The active socket.
+             */
+            QTcpSocket* currentSocket;
+
+            /**
+             * The request URI for this connection.  Built on first use.
+             */
+            mutable QUrl currentRequestUri;
+
+            /**
+             * The request path.  Built on first use.
+             */
+            mutable QString currentPath;
+
+            /**
+             * The current connection method.
+             */
+            Handler::Method currentMethod;
+
+            /**
+             * The handler servicing the current request.  A null pointer is used between requests.
+             */
+            Handler* currentHandler;
+
+            /**
+             * The pooled buffer handed out by \ref readBody for the current request.  The buffer is returned to the
+             * pool once the handler is done.
+             */
+            QByteArray pooledBody;
+
+            /**
+             * The hazard slot used to hold the routing table while a request is being serviced.
+             */
+            RouteTable::Reader* routeReader;
+
+            /**
+             * The path parameters captured when the current request was routed.
+             */
+            Router::Match routeMatch;
+
+            /**
+             * Flag indicating that the current request was routed on the path as received in the request head.  If
+             * false, the request was routed on \ref decodedRoutePath.
+             */
+            bool routedPathInHead;
+
+            /**
+             * The decoded path used to route requests whose targets could not be used as received.
+             */
+            QByteArray decodedRoutePath;
 
             /**
-             * The current HTTP version.
+             * The current HTTP version.  Built on first use.
              */
-            QString currentHttpVersion;
+            mutable QString currentHttpVersion;
 
             /**
-             * The current request headers.
+             * The current request headers.  Built on first use.
              */
-            Handler::Headers currentHeaders;
+            mutable Handler::Headers currentHeaders;
 
             /**
              * The returned status code.
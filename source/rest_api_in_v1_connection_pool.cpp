@@ -0,0 +1,161 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::ConnectionPool class.
+***********************************************************************************************************************/
+
+#include <QList>
+#include <QSemaphore>
+#include <QByteArray>
+
+#include "rest_api_in_v1_server.h"
+#include "rest_api_in_v1_server_private.h"
+#include "rest_api_in_v1_lock_free_queue.h"
+#include "rest_api_in_v1_buffer_pool.h"
+#include "rest_api_in_v1_connection.h"
+#include "rest_api_in_v1_connection_pool.h"
+
+namespace RestApiInV1 {
+    ConnectionPool::ConnectionPool(
+            Server::Private* serverPrivate,
+            unsigned long    maximumBufferSize,
+            unsigned         firstThreadId
+        ):currentServerPrivate(
+            serverPrivate
+        ),currentMaximumBufferSize(
+            maximumBufferSize
+        ),currentFirstThreadId(
+            firstThreadId
+        ),currentLoggingFunction(
+            nullptr
+        ),idleWorkers(
+            new LockFreeQueue<Connection*>(1)
+        ) {}
+
+
+    ConnectionPool::~ConnectionPool() {
+        resize(0);
+        delete idleWorkers;
+    }
+
+
+    void ConnectionPool::setLoggingFunction(Server::LoggingFunction newLoggingFunction) {
+        currentLoggingFunction = newLoggingFunction;
+    }
+
+
+    void ConnectionPool::resize(unsigned newNumberWorkers) {
+        unsigned currentNumberWorkers = static_cast<unsigned>(workers.size());
+
+        if (newNumberWorkers > currentNumberWorkers) {
+            if (newNumberWorkers > idleWorkers->capacity()) {
+                // Quiesce the pool so nothing touches the idle queue while we swap it out.
+                idleWorkerSemaphore.acquire(currentNumberWorkers);
+                rebuildIdleQueue(newNumberWorkers);
+                idleWorkerSemaphore.release(currentNumberWorkers);
+            }
+
+            for (unsigned index=currentNumberWorkers ; index<newNumberWorkers ; ++index) {
+                Connection* worker = new Connection(
+                    this,
+                    currentServerPrivate,
+                    currentFirstThreadId + index,
+                    currentMaximumBufferSize
+                );
+
+                workers.append(worker);
+                worker->start();
+
+                idleWorkers->enqueue(worker);
+                idleWorkerSemaphore.release();
+            }
+        } else {
+            while (static_cast<unsigned>(workers.size()) > newNumberWorkers) {
+                Connection* worker = acquireIdleWorker();
+                worker->stop();
+                worker->wait();
+
+                workers.removeOne(worker);
+                delete worker;
+            }
+        }
+    }
+
+
+    unsigned ConnectionPool::size() const {
+        return static_cast<unsigned>(workers.size());
+    }
+
+
+    void ConnectionPool::startSession(qintptr socketDescriptor, const QByteArray& receivedData) {
+        Connection* worker = acquireIdleWorker();
+        worker->startSession(socketDescriptor, currentLoggingFunction.load(), receivedData);
+    }
+
+
+    bool ConnectionPool::tryStartSession(
+            qintptr           socketDescriptor,
+            const QByteArray& receivedData,
+            EventThread*      eventThread,
+            int               timeout
+        ) {
+        bool success = idleWorkerSemaphore.tryAcquire(1, timeout);
+        if (success) {
+            Connection* worker = nullptr;
+            while (!idleWorkers->dequeue(worker)) {}
+
+            worker->startSession(socketDescriptor, currentLoggingFunction.load(), receivedData, eventThread);
+        }
+
+        return success;
+    }
+
+
+    void ConnectionPool::workerIdle(Connection* worker) {
+        // The idle queue is always sized to hold every worker so this can not fail.
+        idleWorkers->enqueue(worker);
+        idleWorkerSemaphore.release();
+    }
+
+
+    Connection* ConnectionPool::acquireIdleWorker() {
+        Connection* worker = nullptr;
+
+        idleWorkerSemaphore.acquire();
+
+        // The semaphore guarantees an entry is present; the loop only covers the brief window between a worker
+        // claiming its slot and publishing the entry.
+        while (!idleWorkers->dequeue(worker)) {}
+
+        return worker;
+    }
+
+
+    void ConnectionPool::rebuildIdleQueue(unsigned long minimumCapacity) {
+        LockFreeQueue<Connection*>* newIdleWorkers = new LockFreeQueue<Connection*>(minimumCapacity);
+
+        Connection* worker;
+        while (idleWorkers->dequeue(worker)) {
+            newIdleWorkers->enqueue(worker);
+        }
+
+        delete idleWorkers;
+        idleWorkers = newIdleWorkers;
+    }
+}
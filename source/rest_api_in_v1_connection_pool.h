@@ -0,0 +1,205 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::ConnectionPool class.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_CONNECTION_POOL_H
+#define REST_API_IN_V1_CONNECTION_POOL_H
+
+#include <QList>
+#include <QSemaphore>
+#include <QByteArray>
+
+#include <atomic>
+
+#include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_server.h"
+#include "rest_api_in_v1_server_private.h"
+#include "rest_api_in_v1_lock_free_queue.h"
+#include "rest_api_in_v1_buffer_pool.h"
+
+namespace RestApiInV1 {
+    class REST_API_V1_PUBLIC_API Connection;
+    class REST_API_V1_PUBLIC_API EventThread;
+
+    /**
+     * Class that manages a pool of long lived worker threads.  Each worker services one socket at a time and returns
+     * itself to the pool when the session ends, so thread creation and destruction stay off the request path.
+     *
+     * Idle workers are tracked using a lock-free queue.  A semaphore counts the idle workers so that callers can block
+     * until a worker becomes available.
+     */
+    class REST_API_V1_PUBLIC_API ConnectionPool {
+        public:
+            /**
+             * Constructor
+             *
+             * \param[in] serverPrivate     The server instance.
+             *
+             * \param[in] maximumBufferSize The maximum amount of data a worker is allowed to read at once.
+             *
+             * \param[in] firstThreadId     The thread ID to assign to the first worker in this pool.  Workers are
+             *                              assigned consecutive thread IDs starting from this value.
+             */
+            ConnectionPool(
+                Server::Private* serverPrivate,
+                unsigned long    maximumBufferSize,
+                unsigned         firstThreadId = 0
+            );
+
+            /**
+             * Destructor.  Blocks until every worker has finished its current session.
+             */
+            ~ConnectionPool();
+
+            /**
+             * Method you can use to set the logging function handed to workers.  The new function will be used
+             * starting with the next session.
+             *
+             * \param[in] newLoggingFunction The new logging function to be used.
+             */
+            void setLoggingFunction(Server::LoggingFunction newLoggingFunction);
+
+            /**
+             * Method you can use to change the number of workers.  Shrinking the pool will block until enough workers
+             * have finished their current sessions.
+             *
+             * \param[in] newNumberWorkers The new number of workers.
+             */
+            void resize(unsigned newNumberWorkers);
+
+            /**
+             * Method you can use to determine the number of workers in this pool.
+             *
+             * \return Returns the number of workers.
+             */
+            unsigned size() const;
+
+            /**
+             * Method you can use to obtain the pool of request body buffers shared by the workers.
+             *
+             * \return Returns a reference to the buffer pool.
+             */
+            inline BufferPool& bufferPool() {
+                return bodyBufferPool;
+            }
+
+            /**
+             * Method you can use to hand a socket to an idle worker.  This method will block until a worker is
+             * available.
+             *
+             * \param[in] socketDescriptor The socket descriptor to be processed.
+             *
+             * \param[in] receivedData     Data already read from the socket.  The worker will consume this data
+             *                             before reading from the socket.
+             */
+            void startSession(qintptr socketDescriptor, const QByteArray& receivedData = QByteArray());
+
+            /**
+             * Method you can use to hand a socket to an idle worker without blocking, or blocking for at most a
+             * given time.  This method can be called from any thread.
+             *
+             * \param[in] socketDescriptor The socket descriptor to be processed.
+             *
+             * \param[in] receivedData     Data already read from the socket.  The worker will consume this data
+             *                             before reading from the socket.
+             *
+             * \param[in] eventThread      The I/O thread handing over the socket.  The worker returns the socket to
+             *                             this thread when the connection goes idle.
+             *
+             * \param[in] timeout          The longest time to wait for a worker, in milliseconds.  A value of 0
+             *                             returns at once.
+             *
+             * \return Returns true if a worker took the socket.  Returns false if every worker stayed busy.  The
+             *         caller retains ownership of the socket on failure.
+             */
+            bool tryStartSession(
+                qintptr           socketDescriptor,
+                const QByteArray& receivedData,
+                EventThread*      eventThread = nullptr,
+                int               timeout = 0
+            );
+
+            /**
+             * Method called by a worker, from the worker's thread, when the worker has finished a session.
+             *
+             * \param[in] worker The worker that is now idle.
+             */
+            void workerIdle(Connection* worker);
+
+        private:
+            /**
+             * Method that blocks until a worker is idle and then removes it from the idle queue.
+             *
+             * \return Returns the idle worker.
+             */
+            Connection* acquireIdleWorker();
+
+            /**
+             * Method that replaces the idle queue with one able to hold the requested number of workers.  All workers
+             * must be idle when this method is called.
+             *
+             * \param[in] minimumCapacity The minimum number of workers the new queue must be able to hold.
+             */
+            void rebuildIdleQueue(unsigned long minimumCapacity);
+
+            /**
+             * The underlying server private instance.
+             */
+            Server::Private* currentServerPrivate;
+
+            /**
+             * The maximum read buffer size handed to each worker.
+             */
+            unsigned long currentMaximumBufferSize;
+
+            /**
+             * The thread ID of the first worker.
+             */
+            unsigned currentFirstThreadId;
+
+            /**
+             * The logging function handed to workers.  Sessions may be started from several threads.
+             */
+            std::atomic<Server::LoggingFunction> currentLoggingFunction;
+
+            /**
+             * Queue of idle workers.
+             */
+            LockFreeQueue<Connection*>* idleWorkers;
+
+            /**
+             * Semaphore used to track the number of idle workers.
+             */
+            QSemaphore idleWorkerSemaphore;
+
+            /**
+             * All workers in the pool, indexed by thread ID less the first thread ID.
+             */
+            QList<Connection*> workers;
+
+            /**
+             * The pool of request body buffers shared by the workers.
+             */
+            BufferPool bodyBufferPool;
+    };
+};
+
+#endif
@@ -0,0 +1,464 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements helpers used to negotiate and apply HTTP content codings.
+***********************************************************************************************************************/
+
+#include <QByteArray>
+#include <QList>
+
+#include <zlib.h>
+
+#if (defined(REST_API_IN_V1_ZSTD))
+#include <zstd.h>
+#endif
+
+#include "rest_api_in_v1_session.h"
+#include "rest_api_in_v1_content_coding.h"
+
+namespace RestApiInV1 {
+    static const QByteArray identityName("identity");
+    static const QByteArray deflateName("deflate");
+    static const QByteArray gzipName("gzip");
+    static const QByteArray xGzipName("x-gzip");
+    static const QByteArray zstdName("zstd");
+    static const QByteArray wildcardName("*");
+
+    static const int zlibCompressionLevel = 6;
+    static const int zlibMemoryLevel      = 8;
+    static const int zlibWindowBits       = 15;
+    static const int zlibGzipWindowOffset = 16;
+    static const int zstdCompressionLevel = 3;
+
+    /**
+     * Method that encodes data using zlib.
+     *
+     * \param[in]  data       The data to be encoded.
+     *
+     * \param[in]  windowBits The zlib window bits, selecting the zlib or gzip format.
+     *
+     * \param[out] encoded    Receives the encoded data.
+     *
+     * \return Returns true on success.  Returns false on error.
+     */
+    static bool zlibEncode(const QByteArray& data, int windowBits, QByteArray& encoded) {
+        z_stream stream;
+        stream.zalloc = Z_NULL;
+        stream.zfree  = Z_NULL;
+        stream.opaque = Z_NULL;
+
+        bool success = (
+               deflateInit2(&stream, zlibCompressionLevel, Z_DEFLATED, windowBits, zlibMemoryLevel, Z_DEFAULT_STRATEGY)
+            == Z_OK
+        );
+
+        if (success) {
+            // The bound lets us compress in a single call.  The gzip wrapper needs a few bytes more than zlib.
+            uLong bound = deflateBound(&stream, static_cast<uLong>(data.size())) + 32;
+            encoded.resize(static_cast<int>(bound));
+
+            stream.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+            stream.avail_in  = static_cast<uInt>(data.size());
+            stream.next_out  = reinterpret_cast<Bytef*>(encoded.data());
+            stream.avail_out = static_cast<uInt>(bound);
+
+            success = (deflate(&stream, Z_FINISH) == Z_STREAM_END);
+            if (success) {
+                encoded.resize(static_cast<int>(stream.total_out));
+            } else {
+                encoded.clear();
+            }
+
+            deflateEnd(&stream);
+        }
+
+        return success;
+    }
+
+
+    /**
+     * Method that encodes data using zstd.
+     *
+     * \param[in]  data    The data to be encoded.
+     *
+     * \param[out] encoded Receives the encoded data.
+     *
+     * \return Returns true on success.  Returns false on error or if zstd is not available.
+     */
+    static bool zstdEncode(const QByteArray& data, QByteArray& encoded) {
+        bool success;
+
+#if (defined(REST_API_IN_V1_ZSTD))
+
+        size_t bound = ZSTD_compressBound(static_cast<size_t>(data.size()));
+        encoded.resize(static_cast<int>(bound));
+
+        size_t length = ZSTD_compress(
+            encoded.data(),
+            bound,
+            data.constData(),
+            static_cast<size_t>(data.size()),
+            zstdCompressionLevel
+        );
+
+        success = (ZSTD_isError(length) == 0);
+        if (success) {
+            encoded.resize(static_cast<int>(length));
+        } else {
+            encoded.clear();
+        }
+
+#else
+
+        (void) data;
+        encoded.clear();
+        success = false;
+
+#endif
+
+        return success;
+    }
+
+
+    ContentCoding selectContentCoding(const QByteArray& acceptEncoding) {
+        // Quality values, in thousandths, indexed by coding.  A value of -1 indicates the coding was not named.
+        int qualities[4]    = { -1, -1, -1, -1 };
+        int wildcardQuality = -1;
+
+        QList<QByteArray> entries = acceptEncoding.split(',');
+        for (const QByteArray& entry : entries) {
+            QList<QByteArray> parameters = entry.split(';');
+            QByteArray        name       = parameters.first().trimmed().toLower();
+            int               quality    = 1000;
+
+            for (int i=1 ; i<parameters.size() ; ++i) {
+                QByteArray parameter = parameters.at(i).trimmed().toLower();
+                if (parameter.startsWith("q=")) {
+                    bool   ok;
+                    double value = parameter.mid(2).toDouble(&ok);
+                    quality = (ok && value >= 0 && value <= 1) ? static_cast<int>(value * 1000 + 0.5) : 0;
+                }
+            }
+
+            if (name == deflateName) {
+                qualities[static_cast<unsigned>(ContentCoding::DEFLATE)] = quality;
+            } else if (name == gzipName || name == xGzipName) {
+                qualities[static_cast<unsigned>(ContentCoding::GZIP)] = quality;
+            } else if (name == zstdName) {
+                qualities[static_cast<unsigned>(ContentCoding::ZSTD)] = quality;
+            } else if (name == wildcardName) {
+                wildcardQuality = quality;
+            }
+        }
+
+#if (!defined(REST_API_IN_V1_ZSTD))
+
+        qualities[static_cast<unsigned>(ContentCoding::ZSTD)] = 0;
+
+#endif
+
+        ContentCoding result        = ContentCoding::IDENTITY;
+        int           bestQuality   = 0;
+        unsigned      numberCodings = sizeof(qualities) / sizeof(qualities[0]);
+        for (unsigned coding=static_cast<unsigned>(ContentCoding::DEFLATE) ; coding<numberCodings ; ++coding) {
+            int quality = qualities[coding] >= 0 ? qualities[coding] : wildcardQuality;
+            if (quality > 0 && quality >= bestQuality) {
+                bestQuality = quality;
+                result      = static_cast<ContentCoding>(coding);
+            }
+        }
+
+        return result;
+    }
+
+
+    bool parseContentCoding(const QByteArray& contentEncoding, ContentCoding& coding) {
+        QByteArray name    = contentEncoding.trimmed().toLower();
+        bool       success = true;
+
+        if (name.isEmpty() || name == identityName) {
+            coding = ContentCoding::IDENTITY;
+        } else if (name == deflateName) {
+            coding = ContentCoding::DEFLATE;
+        } else if (name == gzipName || name == xGzipName) {
+            coding = ContentCoding::GZIP;
+        } else {
+            coding = ContentCoding::ZSTD;
+
+#if (defined(REST_API_IN_V1_ZSTD))
+
+            success = (name == zstdName);
+
+#else
+
+            success = false;
+
+#endif
+
+        }
+
+        return success;
+    }
+
+
+    const QByteArray& contentCodingName(ContentCoding coding) {
+        const QByteArray* result;
+
+        if (coding == ContentCoding::DEFLATE) {
+            result = &deflateName;
+        } else if (coding == ContentCoding::GZIP) {
+            result = &gzipName;
+        } else if (coding == ContentCoding::ZSTD) {
+            result = &zstdName;
+        } else {
+            result = &identityName;
+        }
+
+        return *result;
+    }
+
+
+    bool encodeContent(ContentCoding coding, const QByteArray& data, QByteArray& encoded) {
+        bool success;
+
+        if (coding == ContentCoding::DEFLATE) {
+            success = zlibEncode(data, zlibWindowBits, encoded);
+        } else if (coding == ContentCoding::GZIP) {
+            success = zlibEncode(data, zlibWindowBits + zlibGzipWindowOffset, encoded);
+        } else if (coding == ContentCoding::ZSTD) {
+            success = zstdEncode(data, encoded);
+        } else {
+            success = false;
+        }
+
+        return success;
+    }
+
+
+    ContentDecoder::ContentDecoder(
+            ContentCoding          coding,
+            Session::BodyReceiver& receiver,
+            unsigned long long     maximumDecodedLength
+        ):currentCoding(
+            coding
+        ),currentReceiver(
+            receiver
+        ),currentMaximumDecodedLength(
+            maximumDecodedLength
+        ),currentDecodedLength(
+            0
+        ),zlibStream(
+            nullptr
+        ),zstdStream(
+            nullptr
+        ),dataReceived(
+            false
+        ),streamEnded(
+            false
+        ),currentLimitExceeded(
+            false
+        ),currentMalformed(
+            false
+        ) {
+        outputBlock.resize(static_cast<int>(decodedBlockLength));
+
+        if (coding == ContentCoding::DEFLATE || coding == ContentCoding::GZIP) {
+            zlibStream = new z_stream;
+            zlibStream->zalloc   = Z_NULL;
+            zlibStream->zfree    = Z_NULL;
+            zlibStream->opaque   = Z_NULL;
+            zlibStream->next_in  = Z_NULL;
+            zlibStream->avail_in = 0;
+
+            int windowBits = coding == ContentCoding::GZIP ? zlibWindowBits + zlibGzipWindowOffset : zlibWindowBits;
+            if (inflateInit2(zlibStream, windowBits) != Z_OK) {
+                delete zlibStream;
+                zlibStream = nullptr;
+            }
+        }
+
+#if (defined(REST_API_IN_V1_ZSTD))
+
+        if (coding == ContentCoding::ZSTD) {
+            zstdStream = ZSTD_createDStream();
+            if (zstdStream != nullptr && ZSTD_isError(ZSTD_initDStream(zstdStream)) != 0) {
+                ZSTD_freeDStream(zstdStream);
+                zstdStream = nullptr;
+            }
+        }
+
+#endif
+
+    }
+
+
+    ContentDecoder::~ContentDecoder() {
+        if (zlibStream != nullptr) {
+            inflateEnd(zlibStream);
+            delete zlibStream;
+        }
+
+#if (defined(REST_API_IN_V1_ZSTD))
+
+        if (zstdStream != nullptr) {
+            ZSTD_freeDStream(zstdStream);
+        }
+
+#endif
+
+    }
+
+
+    bool ContentDecoder::receiveBodyData(const char* data, unsigned long length) {
+        bool success;
+
+        if (length == 0) {
+            success = true;
+        } else if (streamEnded && currentCoding == ContentCoding::DEFLATE) {
+            // Unlike gzip members and zstd frames, a deflate stream can not be followed by another.
+            currentMalformed = true;
+            success          = false;
+        } else {
+            dataReceived = true;
+
+            if (zlibStream != nullptr) {
+                success = inflateData(data, length);
+            } else if (zstdStream != nullptr) {
+                success = zstdDecodeData(data, length);
+            } else {
+                currentMalformed = true;
+                success          = false;
+            }
+        }
+
+        return success;
+    }
+
+
+    bool ContentDecoder::finish() {
+        bool success = (!dataReceived || streamEnded);
+        if (!success) {
+            currentMalformed = true;
+        }
+
+        return success;
+    }
+
+
+    bool ContentDecoder::inflateData(const char* data, unsigned long length) {
+        zlibStream->next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        zlibStream->avail_in = static_cast<uInt>(length);
+
+        bool success    = true;
+        bool needsInput = false;
+        while (success && !needsInput) {
+            if (streamEnded) {
+                // Another gzip member follows the last one.
+                streamEnded = false;
+                success     = (inflateReset(zlibStream) == Z_OK);
+            }
+
+            if (success) {
+                zlibStream->next_out  = reinterpret_cast<Bytef*>(outputBlock.data());
+                zlibStream->avail_out = static_cast<uInt>(decodedBlockLength);
+
+                int result = inflate(zlibStream, Z_NO_FLUSH);
+                if (result == Z_OK || result == Z_STREAM_END || result == Z_BUF_ERROR) {
+                    unsigned long produced = decodedBlockLength - zlibStream->avail_out;
+                    if (produced > 0) {
+                        success = deliverBlock(produced);
+                    }
+
+                    if (result == Z_STREAM_END) {
+                        streamEnded = true;
+                        needsInput  = (zlibStream->avail_in == 0);
+
+                        if (!needsInput && currentCoding == ContentCoding::DEFLATE) {
+                            currentMalformed = true;
+                            success          = false;
+                        }
+                    } else {
+                        // zlib stops when either the input is used up or the output block is full.
+                        needsInput = (zlibStream->avail_in == 0 && zlibStream->avail_out > 0);
+                    }
+                } else {
+                    currentMalformed = true;
+                    success          = false;
+                }
+            }
+        }
+
+        return success;
+    }
+
+
+    bool ContentDecoder::zstdDecodeData(const char* data, unsigned long length) {
+        bool success;
+
+#if (defined(REST_API_IN_V1_ZSTD))
+
+        ZSTD_inBuffer input = { data, static_cast<size_t>(length), 0 };
+
+        success = true;
+        bool needsInput = false;
+        while (success && !needsInput) {
+            ZSTD_outBuffer output = { outputBlock.data(), static_cast<size_t>(decodedBlockLength), 0 };
+
+            size_t result = ZSTD_decompressStream(zstdStream, &output, &input);
+            if (ZSTD_isError(result) == 0) {
+                if (output.pos > 0) {
+                    success = deliverBlock(static_cast<unsigned long>(output.pos));
+                }
+
+                // A result of 0 marks the end of a frame.  Further frames may follow.
+                streamEnded = (result == 0);
+                needsInput  = (input.pos == input.size && output.pos < output.size);
+            } else {
+                currentMalformed = true;
+                success          = false;
+            }
+        }
+
+#else
+
+        (void) data;
+        (void) length;
+
+        currentMalformed = true;
+        success          = false;
+
+#endif
+
+        return success;
+    }
+
+
+    bool ContentDecoder::deliverBlock(unsigned long length) {
+        currentDecodedLength += length;
+
+        bool success = (currentMaximumDecodedLength == 0 || currentDecodedLength <= currentMaximumDecodedLength);
+        if (success) {
+            success = currentReceiver.receiveBodyData(outputBlock.constData(), length);
+        } else {
+            currentLimitExceeded = true;
+        }
+
+        return success;
+    }
+}
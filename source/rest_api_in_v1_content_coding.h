@@ -0,0 +1,275 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements helpers used to negotiate and apply HTTP content codings.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_CONTENT_CODING_H
+#define REST_API_IN_V1_CONTENT_CODING_H
+
+#include <QByteArray>
+
+#include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_session.h"
+
+struct z_stream_s;
+struct ZSTD_DCtx_s;
+
+namespace RestApiInV1 {
+    /**
+     * Enumeration of supported content codings.  Codings are listed in increasing order of preference.
+     */
+    enum class ContentCoding {
+        /**
+         * Indicates the data is not encoded.
+         */
+        IDENTITY,
+
+        /**
+         * Indicates the zlib format, RFC 1950, named "deflate" in HTTP.
+         */
+        DEFLATE,
+
+        /**
+         * Indicates the gzip format, RFC 1952.
+         */
+        GZIP,
+
+        /**
+         * Indicates the Zstandard format, RFC 8878.  Only available if the library was built with zstd.
+         */
+        ZSTD
+    };
+
+    /**
+     * Method that selects the coding to use for a response based on an "Accept-Encoding" header.  The coding with
+     * the highest quality value wins.  Ties are broken by our own preference.
+     *
+     * \param[in] acceptEncoding The "Accept-Encoding" header value.
+     *
+     * \return Returns the selected coding.  Returns \ref ContentCoding::IDENTITY if the header is absent or no
+     *         supported coding is acceptable.
+     */
+    ContentCoding selectContentCoding(const QByteArray& acceptEncoding);
+
+    /**
+     * Method that identifies the coding named in a "Content-Encoding" header.
+     *
+     * \param[in]  contentEncoding The "Content-Encoding" header value.
+     *
+     * \param[out] coding          Receives the coding.  An empty header or "identity" yields
+     *                             \ref ContentCoding::IDENTITY.
+     *
+     * \return Returns true if we can decode the coding.  Returns false if the coding is unknown, not available, or
+     *         if more than one coding was applied.
+     */
+    bool parseContentCoding(const QByteArray& contentEncoding, ContentCoding& coding);
+
+    /**
+     * Method that determines the name used for a coding in the "Content-Encoding" header.
+     *
+     * \param[in] coding The coding of interest.
+     *
+     * \return Returns the coding name.
+     */
+    const QByteArray& contentCodingName(ContentCoding coding);
+
+    /**
+     * Method that encodes a block of data.
+     *
+     * \param[in]  coding  The coding to apply.
+     *
+     * \param[in]  data    The data to be encoded.
+     *
+     * \param[out] encoded Receives the encoded data.
+     *
+     * \return Returns true on success.  Returns false if the coding is not supported or the data could not be
+     *         encoded.
+     */
+    bool encodeContent(ContentCoding coding, const QByteArray& data, QByteArray& encoded);
+
+    /**
+     * Class that decodes a request body as it arrives and passes the decoded data on to another receiver.  Data is
+     * decoded a block at a time so a small, highly compressed body can not make us hold a large decoded body.
+     */
+    class REST_API_V1_PUBLIC_API ContentDecoder:public Session::BodyReceiver {
+        public:
+            /**
+             * The largest block of decoded data handed to the receiver at one time, in bytes.
+             */
+            static constexpr unsigned decodedBlockLength = 16384;
+
+            /**
+             * Constructor
+             *
+             * \param[in] coding               The coding applied to the body.
+             *
+             * \param[in] receiver             The receiver for the decoded data.
+             *
+             * \param[in] maximumDecodedLength The most decoded data we accept, in bytes.  A value of 0 indicates no
+             *                                 limit.
+             */
+            ContentDecoder(
+                ContentCoding          coding,
+                Session::BodyReceiver& receiver,
+                unsigned long long     maximumDecodedLength
+            );
+
+            ~ContentDecoder() override;
+
+            /**
+             * Method that decodes the next piece of the encoded body.
+             *
+             * \param[in] data   Pointer to the encoded data.
+             *
+             * \param[in] length The number of encoded bytes.
+             *
+             * \return Returns true to continue receiving the body.  Returns false if the data is malformed, the
+             *         decoded data exceeds the limit, or the receiver asked to stop.
+             */
+            bool receiveBodyData(const char* data, unsigned long length) override;
+
+            /**
+             * Method you should call once the encoded body has been received in full.
+             *
+             * \return Returns true if the encoded body was complete.  Returns false if the body was truncated.
+             */
+            bool finish();
+
+            /**
+             * Method you can use to determine if decoding stopped because the decoded data exceeded the limit.
+             *
+             * \return Returns true if the limit was exceeded.
+             */
+            inline bool limitExceeded() const {
+                return currentLimitExceeded;
+            }
+
+            /**
+             * Method you can use to determine if decoding stopped because the encoded data was malformed.
+             *
+             * \return Returns true if the data was malformed.
+             */
+            inline bool malformed() const {
+                return currentMalformed;
+            }
+
+            /**
+             * Method you can use to determine the amount of decoded data produced so far.
+             *
+             * \return Returns the decoded length, in bytes.
+             */
+            inline unsigned long long decodedLength() const {
+                return currentDecodedLength;
+            }
+
+        private:
+            /**
+             * Method that decodes data using zlib.
+             *
+             * \param[in] data   Pointer to the encoded data.
+             *
+             * \param[in] length The number of encoded bytes.
+             *
+             * \return Returns true on success.  Returns false on error.
+             */
+            bool inflateData(const char* data, unsigned long length);
+
+            /**
+             * Method that decodes data using zstd.
+             *
+             * \param[in] data   Pointer to the encoded data.
+             *
+             * \param[in] length The number of encoded bytes.
+             *
+             * \return Returns true on success.  Returns false on error.
+             */
+            bool zstdDecodeData(const char* data, unsigned long length);
+
+            /**
+             * Method that hands a block of decoded data to the receiver.
+             *
+             * \param[in] length The number of decoded bytes at the start of the output block.
+             *
+             * \return Returns true on success.  Returns false if the limit was exceeded or the receiver asked to
+             *         stop.
+             */
+            bool deliverBlock(unsigned long length);
+
+            ContentDecoder(const ContentDecoder& other) = delete;
+            ContentDecoder& operator=(const ContentDecoder& other) = delete;
+
+            /**
+             * The coding applied to the body.
+             */
+            ContentCoding currentCoding;
+
+            /**
+             * The receiver for the decoded data.
+             */
+            Session::BodyReceiver& currentReceiver;
+
+            /**
+             * The most decoded data we accept, in bytes.
+             */
+            unsigned long long currentMaximumDecodedLength;
+
+            /**
+             * The amount of decoded data produced so far, in bytes.
+             */
+            unsigned long long currentDecodedLength;
+
+            /**
+             * Buffer used to hold each block of decoded data.
+             */
+            QByteArray outputBlock;
+
+            /**
+             * The zlib decoder state.  Null unless the body is deflate or gzip encoded.
+             */
+            z_stream_s* zlibStream;
+
+            /**
+             * The zstd decoder state.  Null unless the body is zstd encoded.
+             */
+            ZSTD_DCtx_s* zstdStream;
+
+            /**
+             * Flag indicating that encoded data has been received.
+             */
+            bool dataReceived;
+
+            /**
+             * Flag indicating that the encoded stream has ended.
+             */
+            bool streamEnded;
+
+            /**
+             * Flag indicating the decoded data exceeded the limit.
+             */
+            bool currentLimitExceeded;
+
+            /**
+             * Flag indicating the encoded data was malformed.
+             */
+            bool currentMalformed;
+    };
+};
+
+#endif
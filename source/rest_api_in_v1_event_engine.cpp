@@ -0,0 +1,137 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::EventEngine class.
+***********************************************************************************************************************/
+
+#include <QtGlobal>
+#include <QList>
+#include <QString>
+
+#if (defined(Q_OS_LINUX))
+#include <unistd.h>
+#endif
+
+#include "rest_api_in_v1_server.h"
+#include "rest_api_in_v1_server_private.h"
+#include "rest_api_in_v1_connection_pool.h"
+#include "rest_api_in_v1_event_thread.h"
+#include "rest_api_in_v1_event_engine.h"
+
+namespace RestApiInV1 {
+    EventEngine::EventEngine(
+            ConnectionPool*  pool,
+            Server::Private* serverPrivate,
+            unsigned long    maximumHeadLength
+        ):currentPool(
+            pool
+        ),currentServerPrivate(
+            serverPrivate
+        ),currentMaximumHeadLength(
+            maximumHeadLength
+        ),nextThreadIndex(
+            0
+        ) {}
+
+
+    EventEngine::~EventEngine() {
+        resize(0);
+    }
+
+
+    bool EventEngine::isSupported() {
+#if (defined(Q_OS_LINUX))
+        return true;
+#else
+        return false;
+#endif
+    }
+
+
+#if (defined(Q_OS_LINUX))
+
+    void EventEngine::resize(unsigned newNumberThreads) {
+        while (static_cast<unsigned>(threads.size()) < newNumberThreads) {
+            EventThread* thread = new EventThread(currentPool, currentServerPrivate, currentMaximumHeadLength);
+            if (thread->isValid()) {
+                threads.append(thread);
+                thread->start();
+            } else {
+                delete thread;
+                currentServerPrivate->sessionError(QString("Could not create I/O thread."));
+
+                newNumberThreads = static_cast<unsigned>(threads.size());
+            }
+        }
+
+        while (static_cast<unsigned>(threads.size()) > newNumberThreads) {
+            EventThread* thread = threads.takeLast();
+            thread->stop();
+            thread->wait();
+
+            // Workers return sockets to the thread that handed them over so the thread must outlive every session
+            // it started.  Sockets returned to a stopped thread are closed when the thread is deleted.
+            thread->waitForSessions();
+            delete thread;
+        }
+
+        nextThreadIndex = 0;
+    }
+
+
+    bool EventEngine::addSocket(qintptr socketDescriptor) {
+        unsigned numberThreads = static_cast<unsigned>(threads.size());
+        unsigned attempts      = 0;
+        bool     success       = false;
+
+        while (!success && attempts < numberThreads) {
+            success = threads.at(nextThreadIndex)->addSocket(socketDescriptor);
+
+            ++nextThreadIndex;
+            if (nextThreadIndex >= numberThreads) {
+                nextThreadIndex = 0;
+            }
+
+            ++attempts;
+        }
+
+        if (!success) {
+            ::close(static_cast<int>(socketDescriptor));
+            currentServerPrivate->sessionError(QString("I/O threads are saturated, connection dropped."));
+        }
+
+        return success;
+    }
+
+#else
+
+    void EventEngine::resize(unsigned /* newNumberThreads */) {}
+
+
+    bool EventEngine::addSocket(qintptr /* socketDescriptor */) {
+        return false;
+    }
+
+#endif
+
+
+    unsigned EventEngine::size() const {
+        return static_cast<unsigned>(threads.size());
+    }
+}
@@ -0,0 +1,117 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::EventEngine class.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_EVENT_ENGINE_H
+#define REST_API_IN_V1_EVENT_ENGINE_H
+
+#include <QList>
+
+#include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_server.h"
+#include "rest_api_in_v1_server_private.h"
+
+namespace RestApiInV1 {
+    class REST_API_V1_PUBLIC_API ConnectionPool;
+    class REST_API_V1_PUBLIC_API EventThread;
+
+    /**
+     * Class that manages a small set of I/O threads, each multiplexing many sockets.  Sockets are spread across the
+     * I/O threads in round-robin order.  The engine is only available on Linux; on other platforms the engine always
+     * reports zero threads and the server hands sockets directly to workers.
+     */
+    class REST_API_V1_PUBLIC_API EventEngine {
+        public:
+            /**
+             * Constructor
+             *
+             * \param[in] pool              The pool used to process complete requests.
+             *
+             * \param[in] serverPrivate     The server instance.
+             *
+             * \param[in] maximumHeadLength The maximum allowed length of a request head, in bytes.
+             */
+            EventEngine(ConnectionPool* pool, Server::Private* serverPrivate, unsigned long maximumHeadLength);
+
+            ~EventEngine();
+
+            /**
+             * Method you can use to determine if the engine is supported on this platform.
+             *
+             * \return Returns true if the engine is supported.  Returns false if the engine is not supported.
+             */
+            static bool isSupported();
+
+            /**
+             * Method you can use to change the number of I/O threads.  Sockets waiting on a request head in threads
+             * that are removed will be closed.  Removing a thread blocks until the workers serving sessions it started
+             * have released it.
+             *
+             * \param[in] newNumberThreads The new number of I/O threads.  A value of 0 disables the engine.
+             */
+            void resize(unsigned newNumberThreads);
+
+            /**
+             * Method you can use to determine the number of I/O threads.
+             *
+             * \return Returns the number of I/O threads.
+             */
+            unsigned size() const;
+
+            /**
+             * Method you can use to hand a newly accepted socket to the engine.  The socket is closed if every I/O
+             * thread is too busy to accept it.
+             *
+             * \param[in] socketDescriptor The socket descriptor to be monitored.
+             *
+             * \return Returns true on success.  Returns false if the socket was closed.
+             */
+            bool addSocket(qintptr socketDescriptor);
+
+        private:
+            /**
+             * The pool used to process complete requests.
+             */
+            ConnectionPool* currentPool;
+
+            /**
+             * The underlying server private instance.
+             */
+            Server::Private* currentServerPrivate;
+
+            /**
+             * The maximum allowed request head length.
+             */
+            unsigned long currentMaximumHeadLength;
+
+            /**
+             * The index of the thread to receive the next socket.
+             */
+            unsigned nextThreadIndex;
+
+            /**
+             * The I/O threads.
+             */
+            QList<EventThread*> threads;
+    };
+};
+
+#endif
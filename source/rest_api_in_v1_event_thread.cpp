@@ -0,0 +1,408 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::EventThread class.
+***********************************************************************************************************************/
+
+#include <QtGlobal>
+
+#if (defined(Q_OS_LINUX))
+
+#include <QThread>
+#include <QByteArray>
+#include <QString>
+#include <QSet>
+#include <QQueue>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <ctime>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "rest_api_in_v1_server.h"
+#include "rest_api_in_v1_server_private.h"
+#include "rest_api_in_v1_handler.h"
+#include "rest_api_in_v1_lock_free_queue.h"
+#include "rest_api_in_v1_request_parser.h"
+#include "rest_api_in_v1_timer_wheel.h"
+#include "rest_api_in_v1_connection.h"
+#include "rest_api_in_v1_connection_pool.h"
+#include "rest_api_in_v1_event_thread.h"
+
+namespace RestApiInV1 {
+    EventThread::PendingSocket::PendingSocket(
+            int           descriptor,
+            unsigned long maximumHeadLength,
+            bool          idle
+        ):socketDescriptor(
+            descriptor
+        ),parser(
+            maximumHeadLength
+        ),idle(
+            idle
+        ) {}
+
+
+    EventThread::EventThread(
+            ConnectionPool*  pool,
+            Server::Private* serverPrivate,
+            unsigned long    maximumHeadLength,
+            QObject*         parent
+        ):QThread(
+            parent
+        ),currentPool(
+            pool
+        ),currentServerPrivate(
+            serverPrivate
+        ),currentMaximumHeadLength(
+            maximumHeadLength
+        ),stopRequested(
+            false
+        ),outstandingSessions(
+            0
+        ),queuedSockets(
+            maximumQueuedSockets
+        ),returnedSockets(
+            maximumQueuedSockets
+        ),timerWheel(
+            monotonicTime()
+        ) {
+        epollDescriptor = ::epoll_create1(EPOLL_CLOEXEC);
+        wakeDescriptor  = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        if (epollDescriptor >= 0 && wakeDescriptor >= 0) {
+            // The wake descriptor is tagged with a null pointer so it can be told apart from client sockets.
+            struct epoll_event event;
+            event.events   = EPOLLIN;
+            event.data.ptr = nullptr;
+
+            if (::epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, wakeDescriptor, &event) != 0) {
+                ::close(wakeDescriptor);
+                wakeDescriptor = -1;
+            }
+        }
+    }
+
+
+    EventThread::~EventThread() {
+        if (isRunning()) {
+            stop();
+            wait();
+        }
+
+        qintptr socketDescriptor;
+        while (queuedSockets.dequeue(socketDescriptor)) {
+            ::close(static_cast<int>(socketDescriptor));
+        }
+
+        while (returnedSockets.dequeue(socketDescriptor)) {
+            ::close(static_cast<int>(socketDescriptor));
+        }
+
+        if (wakeDescriptor >= 0) {
+            ::close(wakeDescriptor);
+        }
+
+        if (epollDescriptor >= 0) {
+            ::close(epollDescriptor);
+        }
+    }
+
+
+    bool EventThread::isValid() const {
+        return epollDescriptor >= 0 && wakeDescriptor >= 0;
+    }
+
+
+    bool EventThread::addSocket(qintptr socketDescriptor) {
+        bool success = queuedSockets.enqueue(socketDescriptor);
+        if (success) {
+            wake();
+        }
+
+        return success;
+    }
+
+
+    bool EventThread::returnSocket(qintptr socketDescriptor) {
+        bool success = returnedSockets.enqueue(socketDescriptor);
+        if (success) {
+            wake();
+        }
+
+        return success;
+    }
+
+
+    void EventThread::sessionEnded() {
+        outstandingSessions.fetch_sub(1, std::memory_order_release);
+    }
+
+
+    void EventThread::waitForSessions() const {
+        while (outstandingSessions.load(std::memory_order_acquire) != 0) {
+            QThread::msleep(sessionPollInterval);
+        }
+    }
+
+
+    void EventThread::stop() {
+        stopRequested.store(true);
+        wake();
+    }
+
+
+    void EventThread::run() {
+        struct epoll_event events[maximumEventsPerWait];
+
+        while (!stopRequested.load(std::memory_order_relaxed)) {
+            int timeout;
+            if (!readySockets.isEmpty()) {
+                timeout = dispatchRetryInterval;
+            } else if (!timerWheel.isEmpty()) {
+                timeout = static_cast<int>(timerWheel.resolution());
+            } else {
+                timeout = -1;
+            }
+
+            int numberEvents = ::epoll_wait(epollDescriptor, events, maximumEventsPerWait, timeout);
+            for (int i=0 ; i<numberEvents ; ++i) {
+                PendingSocket* pendingSocket = static_cast<PendingSocket*>(events[i].data.ptr);
+                if (pendingSocket == nullptr) {
+                    std::uint64_t count;
+                    while (::read(wakeDescriptor, &count, sizeof(count)) > 0) {}
+
+                    registerQueuedSockets();
+                } else {
+                    readSocket(pendingSocket);
+                }
+            }
+
+            dispatchReadySockets();
+            closeStaleSockets(monotonicTime());
+        }
+
+        while (!readySockets.isEmpty()) {
+            PendingSocket* pendingSocket = readySockets.dequeue();
+            ::close(pendingSocket->socketDescriptor);
+            delete pendingSocket;
+        }
+
+        QList<PendingSocket*> remainingSockets = pendingSockets.values();
+        for (unsigned i=0 ; i<static_cast<unsigned>(remainingSockets.size()) ; ++i) {
+            closeSocket(remainingSockets.at(i));
+        }
+    }
+
+
+    void EventThread::registerQueuedSockets() {
+        unsigned requestHeadTimeout = currentServerPrivate->requestHeadTimeout();
+        unsigned keepAliveTimeout   = currentServerPrivate->keepAliveTimeout();
+
+        qintptr socketDescriptor;
+        while (queuedSockets.dequeue(socketDescriptor)) {
+            registerSocket(static_cast<int>(socketDescriptor), requestHeadTimeout, false);
+        }
+
+        while (returnedSockets.dequeue(socketDescriptor)) {
+            registerSocket(static_cast<int>(socketDescriptor), keepAliveTimeout, true);
+        }
+    }
+
+
+    void EventThread::registerSocket(int socketDescriptor, unsigned timeout, bool idle) {
+        int flags = ::fcntl(socketDescriptor, F_GETFL, 0);
+
+        bool success = (flags >= 0 && ::fcntl(socketDescriptor, F_SETFL, flags | O_NONBLOCK) == 0);
+        if (success) {
+            PendingSocket* pendingSocket = new PendingSocket(socketDescriptor, currentMaximumHeadLength, idle);
+
+            struct epoll_event event;
+            event.events   = EPOLLIN;
+            event.data.ptr = pendingSocket;
+
+            success = (::epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, socketDescriptor, &event) == 0);
+            if (success) {
+                pendingSockets.insert(pendingSocket);
+                scheduleTimeout(pendingSocket, timeout);
+
+                // Clients often send the request along with the handshake so try reading right away.
+                readSocket(pendingSocket);
+            } else {
+                delete pendingSocket;
+            }
+        }
+
+        if (!success) {
+            int errorCode = errno;
+            ::close(socketDescriptor);
+
+            currentServerPrivate->sessionError(QString("Could not monitor socket: %1").arg(errorCode));
+        }
+    }
+
+
+    void EventThread::readSocket(PendingSocket* pendingSocket) {
+        bool                 waitForData = false;
+        bool                 socketOpen  = true;
+        RequestParser::State state       = pendingSocket->parser.state();
+
+        while (!waitForData && socketOpen && state != RequestParser::State::COMPLETE) {
+            QByteArray& receivedData = pendingSocket->receivedData;
+            int         currentSize  = receivedData.size();
+
+            receivedData.resize(currentSize + readChunkSize);
+            ssize_t bytesRead = ::recv(
+                pendingSocket->socketDescriptor,
+                receivedData.data() + currentSize,
+                readChunkSize,
+                0
+            );
+
+            if (bytesRead > 0) {
+                receivedData.resize(currentSize + static_cast<int>(bytesRead));
+                if (pendingSocket->idle) {
+                    // The client has started its next request so it now gets the full request head timeout.
+                    pendingSocket->idle = false;
+                    scheduleTimeout(pendingSocket, currentServerPrivate->requestHeadTimeout());
+                }
+
+                state = pendingSocket->parser.parse(receivedData.constData(), receivedData.size());
+
+                if (state == RequestParser::State::FAILED) {
+                    socketOpen = false;
+                    rejectSocket(pendingSocket, pendingSocket->parser.failureStatusCode());
+                }
+            } else {
+                receivedData.resize(currentSize);
+                if (bytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    waitForData = true;
+                } else if (bytesRead == 0 || errno != EINTR) {
+                    socketOpen = false;
+                    closeSocket(pendingSocket);
+                }
+            }
+        }
+
+        if (socketOpen && state == RequestParser::State::COMPLETE) {
+            releaseSocket(pendingSocket);
+            readySockets.enqueue(pendingSocket);
+        }
+    }
+
+
+    void EventThread::scheduleTimeout(EventThread::PendingSocket* pendingSocket, unsigned timeout) {
+        if (timeout > 0) {
+            timerWheel.schedule(pendingSocket, monotonicTime() + timeout);
+        } else {
+            timerWheel.cancel(pendingSocket);
+        }
+    }
+
+
+    void EventThread::dispatchReadySockets() {
+        bool workerAvailable = true;
+        while (workerAvailable && !readySockets.isEmpty()) {
+            PendingSocket* pendingSocket = readySockets.head();
+
+            // Counted first so the worker can never release the session before it is recorded.
+            outstandingSessions.fetch_add(1, std::memory_order_relaxed);
+            workerAvailable = currentPool->tryStartSession(
+                pendingSocket->socketDescriptor,
+                pendingSocket->receivedData,
+                this
+            );
+
+            if (!workerAvailable) {
+                outstandingSessions.fetch_sub(1, std::memory_order_relaxed);
+            } else {
+                readySockets.dequeue();
+                delete pendingSocket;
+            }
+        }
+    }
+
+
+    void EventThread::closeStaleSockets(long long now) {
+        QList<TimerWheel::Timer*> staleSockets;
+        timerWheel.advance(now, staleSockets);
+
+        for (unsigned i=0 ; i<static_cast<unsigned>(staleSockets.size()) ; ++i) {
+            PendingSocket* pendingSocket = static_cast<PendingSocket*>(staleSockets.at(i));
+            if (pendingSocket->idle || pendingSocket->receivedData.isEmpty()) {
+                closeSocket(pendingSocket);
+            } else {
+                rejectSocket(pendingSocket, Handler::StatusCode::REQUEST_TIMEOUT);
+            }
+        }
+    }
+
+
+    void EventThread::rejectSocket(PendingSocket* pendingSocket, Handler::StatusCode statusCode) {
+        QByteArray response = Connection::closingResponse(statusCode);
+
+        // This is best effort.  The socket is non-blocking and we will not wait on a slow client.
+        ::send(pendingSocket->socketDescriptor, response.constData(), response.size(), MSG_NOSIGNAL);
+
+        currentServerPrivate->sessionError(
+            QString("Rejected request head with status %1").arg(static_cast<unsigned>(statusCode))
+        );
+
+        closeSocket(pendingSocket);
+    }
+
+
+    void EventThread::closeSocket(PendingSocket* pendingSocket) {
+        int socketDescriptor = pendingSocket->socketDescriptor;
+        releaseSocket(pendingSocket);
+
+        ::close(socketDescriptor);
+        delete pendingSocket;
+    }
+
+
+    void EventThread::releaseSocket(PendingSocket* pendingSocket) {
+        ::epoll_ctl(epollDescriptor, EPOLL_CTL_DEL, pendingSocket->socketDescriptor, nullptr);
+        pendingSockets.remove(pendingSocket);
+        timerWheel.cancel(pendingSocket);
+    }
+
+
+    void EventThread::wake() {
+        std::uint64_t count = 1;
+        ssize_t       bytesWritten = ::write(wakeDescriptor, &count, sizeof(count));
+        (void) bytesWritten;
+    }
+
+
+    long long EventThread::monotonicTime() {
+        struct timespec now;
+        ::clock_gettime(CLOCK_MONOTONIC, &now);
+
+        return static_cast<long long>(now.tv_sec) * 1000LL + now.tv_nsec / 1000000;
+    }
+}
+
+#endif
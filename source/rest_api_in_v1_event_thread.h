@@ -0,0 +1,338 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::EventThread class.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_EVENT_THREAD_H
+#define REST_API_IN_V1_EVENT_THREAD_H
+
+#include <QtGlobal>
+
+#if (defined(Q_OS_LINUX))
+
+#include <QThread>
+#include <QByteArray>
+#include <QSet>
+#include <QQueue>
+
+#include <atomic>
+
+#include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_server.h"
+#include "rest_api_in_v1_server_private.h"
+#include "rest_api_in_v1_lock_free_queue.h"
+#include "rest_api_in_v1_request_parser.h"
+#include "rest_api_in_v1_timer_wheel.h"
+
+namespace RestApiInV1 {
+    class REST_API_V1_PUBLIC_API ConnectionPool;
+
+    /**
+     * Class that watches many sockets from a single thread using epoll.  Sockets are held here, without tying up a
+     * worker, until a complete request head has arrived.  The socket and the data read so far are then handed to a
+     * worker in the \ref ConnectionPool which runs the handler through the normal \ref Session interface.  Workers
+     * return persistent connections to this thread while they wait for the next request.
+     */
+    class REST_API_V1_PUBLIC_API EventThread:public QThread {
+        public:
+            /**
+             * The maximum number of new sockets that can be queued for this thread at one time.
+             */
+            static constexpr unsigned long maximumQueuedSockets = 4096;
+
+            /**
+             * Constructor
+             *
+             * \param[in] pool              The pool used to process complete requests.
+             *
+             * \param[in] serverPrivate     The server instance.
+             *
+             * \param[in] maximumHeadLength The maximum allowed length of a request head, in bytes.
+             *
+             * \param[in] parent            The pointer to the parent object.
+             */
+            EventThread(
+                ConnectionPool*  pool,
+                Server::Private* serverPrivate,
+                unsigned long    maximumHeadLength,
+                QObject*         parent = nullptr
+            );
+
+            ~EventThread() override;
+
+            /**
+             * Method you can use to determine if this thread was able to allocate its epoll resources.
+             *
+             * \return Returns true if the thread is usable.  Returns false if the thread could not be initialized.
+             */
+            bool isValid() const;
+
+            /**
+             * Method you can use to hand a newly accepted socket to this thread.  This method can be called from any
+             * thread.
+             *
+             * \param[in] socketDescriptor The socket descriptor to be monitored.
+             *
+             * \return Returns true on success.  Returns false if the thread is too busy to take the socket.  The
+             *         caller retains ownership of the socket on failure.
+             */
+            bool addSocket(qintptr socketDescriptor);
+
+            /**
+             * Method you can use to hand an idle persistent connection back to this thread.  The socket is held until
+             * the next request head arrives or until the server's keep-alive timeout expires.  This method can be
+             * called from any thread.
+             *
+             * \param[in] socketDescriptor The socket descriptor to be monitored.
+             *
+             * \return Returns true on success.  Returns false if the thread is too busy to take the socket.  The
+             *         caller retains ownership of the socket on failure.
+             */
+            bool returnSocket(qintptr socketDescriptor);
+
+            /**
+             * Method a worker calls once it has returned or closed a socket handed over by this thread.  The worker
+             * must not use this thread after the call.  This method can be called from any thread.
+             */
+            void sessionEnded();
+
+            /**
+             * Method you can use to wait until every worker has released the sockets this thread handed over.  Call
+             * this after the thread has stopped and before deleting it.
+             */
+            void waitForSessions() const;
+
+            /**
+             * Method you can use to request that this thread exit.  Sockets still waiting on a request head are
+             * closed.  Call QThread::wait to wait for the thread to finish.
+             */
+            void stop();
+
+        private:
+            /**
+             * Type used to track a socket that is waiting on a complete request head.  The socket's deadline is held
+             * in the thread's timer wheel.
+             */
+            struct PendingSocket:public TimerWheel::Timer {
+                /**
+                 * Constructor
+                 *
+                 * \param[in] descriptor        The socket descriptor.
+                 *
+                 * \param[in] maximumHeadLength The maximum allowed length of the request head.
+                 *
+                 * \param[in] idle              If true, the socket is an idle persistent connection.
+                 */
+                PendingSocket(int descriptor, unsigned long maximumHeadLength, bool idle);
+
+                /**
+                 * The socket descriptor.
+                 */
+                int socketDescriptor;
+
+                /**
+                 * The data received so far.
+                 */
+                QByteArray receivedData;
+
+                /**
+                 * The incremental request head parser.
+                 */
+                RequestParser parser;
+
+                /**
+                 * Flag indicating that this is a persistent connection that has not yet started its next request.
+                 * Idle sockets are closed quietly when they time out.
+                 */
+                bool idle;
+            };
+
+            /**
+             * The number of bytes we attempt to read from a socket in a single system call.
+             */
+            static constexpr int readChunkSize = 4096;
+
+            /**
+             * The maximum number of events we process for each call to epoll_wait.
+             */
+            static constexpr int maximumEventsPerWait = 256;
+
+            /**
+             * The interval used to retry dispatch when all workers are busy, in milliseconds.
+             */
+            static constexpr int dispatchRetryInterval = 5;
+
+            /**
+             * The interval used to poll for workers to release this thread, in milliseconds.
+             */
+            static constexpr unsigned long sessionPollInterval = 5;
+
+            /**
+             * Method that runs the event loop.
+             */
+            void run() override;
+
+            /**
+             * Method that registers any sockets queued by \ref addSocket or \ref returnSocket.
+             */
+            void registerQueuedSockets();
+
+            /**
+             * Method that starts monitoring a socket.
+             *
+             * \param[in] socketDescriptor The socket to be monitored.
+             *
+             * \param[in] timeout          The time the socket may wait, in milliseconds.  A value of 0 indicates no
+             *                             limit.
+             *
+             * \param[in] idle             If true, the socket is an idle persistent connection.
+             */
+            void registerSocket(int socketDescriptor, unsigned timeout, bool idle);
+
+            /**
+             * Method that starts or stops a socket's timer.
+             *
+             * \param[in] pendingSocket The socket to be timed.
+             *
+             * \param[in] timeout       The time the socket may wait, in milliseconds.  A value of 0 cancels the
+             *                          timer.
+             */
+            void scheduleTimeout(PendingSocket* pendingSocket, unsigned timeout);
+
+            /**
+             * Method that reads available data from a socket and advances its parser.
+             *
+             * \param[in] pendingSocket The socket to be read.
+             */
+            void readSocket(PendingSocket* pendingSocket);
+
+            /**
+             * Method that hands sockets with complete request heads to the worker pool.
+             */
+            void dispatchReadySockets();
+
+            /**
+             * Method that closes sockets whose timers have expired.  Sockets that have sent nothing are closed
+             * quietly.  Sockets that have sent part of a request head receive a request timeout response.
+             *
+             * \param[in] now The current monotonic time, in milliseconds.
+             */
+            void closeStaleSockets(long long now);
+
+            /**
+             * Method that sends a minimal failure response and closes a socket.
+             *
+             * \param[in] pendingSocket The socket to be closed.
+             *
+             * \param[in] statusCode    The status code to report.
+             */
+            void rejectSocket(PendingSocket* pendingSocket, Handler::StatusCode statusCode);
+
+            /**
+             * Method that stops monitoring a socket, closes it, and releases its resources.
+             *
+             * \param[in] pendingSocket The socket to be closed.
+             */
+            void closeSocket(PendingSocket* pendingSocket);
+
+            /**
+             * Method that stops monitoring a socket and releases its tracking resources without closing it.
+             *
+             * \param[in] pendingSocket The socket to be released.
+             */
+            void releaseSocket(PendingSocket* pendingSocket);
+
+            /**
+             * Method that wakes the event loop.
+             */
+            void wake();
+
+            /**
+             * Method that obtains the current monotonic time.
+             *
+             * \return Returns the current monotonic time, in milliseconds.
+             */
+            static long long monotonicTime();
+
+            /**
+             * The pool used to process complete requests.
+             */
+            ConnectionPool* currentPool;
+
+            /**
+             * The underlying server private instance.
+             */
+            Server::Private* currentServerPrivate;
+
+            /**
+             * The maximum allowed request head length.
+             */
+            unsigned long currentMaximumHeadLength;
+
+            /**
+             * The epoll instance.
+             */
+            int epollDescriptor;
+
+            /**
+             * Event file descriptor used to wake the event loop.
+             */
+            int wakeDescriptor;
+
+            /**
+             * Flag indicating that the thread should exit.
+             */
+            std::atomic<bool> stopRequested;
+
+            /**
+             * The number of sessions handed to workers that have not yet released this thread.
+             */
+            std::atomic<unsigned> outstandingSessions;
+
+            /**
+             * Sockets handed to this thread that have not yet been registered with epoll.
+             */
+            LockFreeQueue<qintptr> queuedSockets;
+
+            /**
+             * Idle persistent connections returned by workers that have not yet been registered with epoll.
+             */
+            LockFreeQueue<qintptr> returnedSockets;
+
+            /**
+             * Sockets being monitored for a complete request head.
+             */
+            QSet<PendingSocket*> pendingSockets;
+
+            /**
+             * Timer wheel holding the deadline of each monitored socket.
+             */
+            TimerWheel timerWheel;
+
+            /**
+             * Sockets with complete request heads waiting for a worker.
+             */
+            QQueue<PendingSocket*> readySockets;
+    };
+};
+
+#endif
+
+#endif
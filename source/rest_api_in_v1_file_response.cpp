@@ -0,0 +1,133 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::FileResponse class.
+***********************************************************************************************************************/
+
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+
+#include <algorithm>
+#include <limits>
+
+#include "rest_api_in_v1_response.h"
+#include "rest_api_in_v1_file_response.h"
+
+namespace RestApiInV1 {
+    const QByteArray FileResponse::defaultContentType("application/octet-stream");
+
+    FileResponse::FileResponse(
+            const QString&    filename,
+            const QByteArray& contentType
+        ):Response(
+            StatusCode::OK,
+            contentType
+        ),currentFile(
+            filename
+        ) {
+        currentFile.open(QFile::OpenModeFlag::ReadOnly);
+        setRange(0, std::numeric_limits<unsigned long long>::max());
+    }
+
+
+    FileResponse::FileResponse(
+            const QString&     filename,
+            unsigned long long offset,
+            unsigned long long length,
+            const QByteArray&  contentType
+        ):Response(
+            StatusCode::OK,
+            contentType
+        ),currentFile(
+            filename
+        ) {
+        currentFile.open(QFile::OpenModeFlag::ReadOnly);
+        setRange(offset, length);
+    }
+
+
+    FileResponse::FileResponse(
+            int                fileDescriptor,
+            unsigned long long offset,
+            unsigned long long length,
+            const QByteArray&  contentType
+        ):Response(
+            StatusCode::OK,
+            contentType
+        ) {
+        currentFile.open(fileDescriptor, QFile::OpenModeFlag::ReadOnly, QFile::FileHandleFlag::AutoCloseHandle);
+        setRange(offset, length);
+    }
+
+
+    FileResponse::~FileResponse() {}
+
+
+    bool FileResponse::isBinaryResponse() const {
+        return true;
+    }
+
+
+    bool FileResponse::isFileResponse() const {
+        return true;
+    }
+
+
+    QByteArray FileResponse::asByteArray() const {
+        QByteArray result;
+
+        if (currentFile.isOpen() && currentFile.seek(static_cast<qint64>(currentOffset))) {
+            result = currentFile.read(static_cast<qint64>(currentLength));
+        }
+
+        return result;
+    }
+
+
+    bool FileResponse::isOpen() const {
+        return currentFile.isOpen();
+    }
+
+
+    int FileResponse::fileDescriptor() const {
+        return currentFile.handle();
+    }
+
+
+    unsigned long long FileResponse::offset() const {
+        return currentOffset;
+    }
+
+
+    unsigned long long FileResponse::length() const {
+        return currentLength;
+    }
+
+
+    void FileResponse::setRange(unsigned long long offset, unsigned long long length) {
+        unsigned long long fileSize = 0;
+        if (currentFile.isOpen()) {
+            fileSize = static_cast<unsigned long long>(currentFile.size());
+        }
+
+        currentOffset = std::min(offset, fileSize);
+        currentLength = std::min(length, fileSize - currentOffset);
+    }
+}
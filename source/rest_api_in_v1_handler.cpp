@@ -32,9 +32,25 @@ namespace RestApiInV1 {
     const QByteArray Handler::xRealIPString("x-real-ip");
     const QByteArray Handler::xForwardedForString("x-forwarded-for");
     const QByteArray Handler::connectionCloseString("close");
+    const QByteArray Handler::connectionKeepAliveString("keep-alive");
+    const QByteArray Handler::transferEncodingString("transfer-encoding");
+    const QByteArray Handler::transferEncodingChunkedString("chunked");
+    const QByteArray Handler::expectString("expect");
+    const QByteArray Handler::expectContinueString("100-continue");
+    const QByteArray Handler::rangeString("range");
+    const QByteArray Handler::ifRangeString("if-range");
+    const QByteArray Handler::acceptRangesString("accept-ranges");
+    const QByteArray Handler::acceptRangesBytesString("bytes");
+    const QByteArray Handler::contentRangeString("content-range");
+    const QByteArray Handler::etagString("etag");
+    const QByteArray Handler::lastModifiedString("last-modified");
+    const QByteArray Handler::acceptEncodingString("accept-encoding");
+    const QByteArray Handler::contentEncodingString("content-encoding");
+    const QByteArray Handler::varyString("vary");
     const QByteArray Handler::serverString("server");
     const QByteArray Handler::userAgentString("user-agent");
     const QByteArray Handler::inesonicBotString("InesonicBot");
+    const QByteArray Handler::xInesonicWindowString("x-inesonic-window");
     const QByteArray Handler::textPlainString("text/plain");
     const QByteArray Handler::textHtmlString("text/html");
     const QByteArray Handler::applicationJsonString("application/json");
@@ -47,4 +63,19 @@ namespace RestApiInV1 {
 
 
     Handler::~Handler() {}
+
+
+    unsigned long long Handler::maximumBodySize() const {
+        return 0;
+    }
+
+
+    Handler::StatusCode Handler::checkRequestHead(const Session&) const {
+        return StatusCode::OK;
+    }
+
+
+    bool Handler::compressResponses() const {
+        return false;
+    }
 }
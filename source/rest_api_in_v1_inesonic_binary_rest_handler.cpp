@@ -28,6 +28,7 @@
 #include <QJsonValue>
 #include <QDateTime>
 
+#include <algorithm>
 #include <cstring>
 #include <cstdint>
 
@@ -36,12 +37,85 @@
 #include "rest_api_in_v1_response.h"
 #include "rest_api_in_v1_json_response.h"
 #include "rest_api_in_v1_binary_response.h"
+#include "rest_api_in_v1_streaming_response.h"
+#include "rest_api_in_v1_file_response.h"
 #include "rest_api_in_v1_authentication_helpers.h"
 #include "rest_api_in_v1_inesonic_rest_handler_base.h"
 #include "rest_api_in_v1_inesonic_rest_handler_base_private.h"
 #include "rest_api_in_v1_inesonic_binary_rest_handler.h"
 
 namespace RestApiInV1 {
+    namespace {
+        /**
+         * Receiver that collects the payload while hashing it.  The trailing hash is held back from the calculation
+         * until the end of the body is known.
+         */
+        class PayloadReceiver:public Session::BodyReceiver {
+            public:
+                /**
+                 * Constructor
+                 *
+                 * \param[in] verifier     The hash verifier, set up for the time windows to be checked.
+                 *
+                 * \param[in] expectedSize The expected body size, in bytes, used to size the payload up front.
+                 */
+                PayloadReceiver(
+                        const HashVerifier& verifier,
+                        unsigned long long  expectedSize
+                    ):verifier(
+                        verifier
+                    ),hashedLength(
+                        0
+                    ) {
+                    payload.reserve(static_cast<int>(expectedSize));
+                }
+
+                bool receiveBodyData(const char* data, unsigned long length) override {
+                    payload.append(data, static_cast<int>(length));
+
+                    int hashableLength = payload.size() - static_cast<int>(inesonicHashLength);
+                    if (hashableLength > hashedLength) {
+                        verifier.addData(payload.constData() + hashedLength, hashableLength - hashedLength);
+                        hashedLength = hashableLength;
+                    }
+
+                    return true;
+                }
+
+                /**
+                 * Method that splits the trailing hash from the payload and checks it.
+                 *
+                 * \return Returns true if the hash is correct.  Returns false if the hash is incorrect.
+                 */
+                bool checkHash() {
+                    bool success = (payload.size() >= static_cast<int>(inesonicHashLength));
+                    if (success) {
+                        success = verifier.checkHash(payload.mid(hashedLength));
+                        payload.truncate(hashedLength);
+                    }
+
+                    return success;
+                }
+
+                /**
+                 * The received payload, less the hash once \ref checkHash has been called.
+                 */
+                QByteArray payload;
+
+            private:
+                /**
+                 * The incremental hash calculation.
+                 */
+                HashVerifier verifier;
+
+                /**
+                 * The number of payload bytes added to the hash calculation.
+                 */
+                int hashedLength;
+        };
+    }
+
+
     InesonicBinaryRestHandler::InesonicBinaryRestHandler(const QByteArray& secret):InesonicRestHandlerBase(secret) {}
 
 
@@ -53,55 +127,89 @@ namespace RestApiInV1 {
     }
 
 
-    void InesonicBinaryRestHandler::session(Session& session) {
-        QString path = session.requestUri().path();
-
-        QByteArray contentType = session.headers().value(contentTypeString);
-        if (contentType == applicationOctetStreamString) {
-            bool               success;
-            QByteArray         contentLengthArray = session.headers().value(contentLengthString);
-            unsigned long long contentLength      = contentLengthArray.toULongLong(&success);
-            unsigned long      maximumBufferSize  = InesonicBinaryRestHandler::maximumPayloadSize();
-
-            if (contentLength <= maximumBufferSize) {
-                QByteArray receivedData;
-                while (success && static_cast<unsigned long long>(receivedData.size()) < contentLength) {
-                    success = session.readData(receivedData, maximumBufferSize);
-                }
-
-                if (success) {
-                    QByteArray rawHash = receivedData.right(RestApiInV1::inesonicHashLength);
-                    QByteArray rawData = receivedData.left(receivedData.size() - inesonicHashLength);
-
-                    if (impl->checkHash(rawData, rawHash)) {
-                        Response* response = processAuthenticatedRequest(path, rawData, session.threadId());
-                        if (response != nullptr) {
-                            QByteArray responsePayload = response->asByteArray();
-
-                            Headers headers;
-                            headers.insert(serverString, inesonicBotString);
-                            headers.insert(contentTypeString, response->contentType());
-                            headers.insert(contentLengthString, QByteArray::number(responsePayload.size()));
-                            headers.insert(connectionString, connectionCloseString);
+    unsigned long long InesonicBinaryRestHandler::maximumBodySize() const {
+        return maximumPayloadSize();
+    }
 
-                            success = session.sendResponseHeader(response->statusCode(), headers);
-                            if (success) {
-                                success = session.sendData(responsePayload);
-                            }
 
-                            delete response;
+    void InesonicBinaryRestHandler::session(Session& session) {
+        QString path = session.path();
+
+        // The content type has already been vetted by checkRequestHead.  The hash is calculated while the body is
+        // still arriving.  Compressed bodies are decoded first so clients hash the payload, not the encoding.
+        unsigned long long contentLength = std::min(
+            session.header(contentLengthString).toULongLong(),
+            maximumPayloadSize()
+        );
+
+        // A client that reports its time window lets us calculate a single HMAC.  Malformed values have already
+        // been rejected by checkRequestHead.
+        QByteArray         windowHint = session.header(xInesonicWindowString);
+        unsigned long long timeWindow = 0;
+        bool               hasWindow  = !windowHint.isEmpty() && parseTimeWindow(windowHint, timeWindow);
+
+        PayloadReceiver receiver(
+              hasWindow
+            ? HashVerifier(impl->secret(), timeWindow, macAlgorithm())
+            : HashVerifier(impl->secret(), macAlgorithm()),
+            contentLength
+        );
+
+        bool success = session.readBody(receiver);
+        if (success) {
+            if (receiver.checkHash()) {
+                Response* response = processAuthenticatedRequest(path, receiver.payload, session.threadId());
+                if (response != nullptr) {
+                    Headers headers;
+                    headers.insert(serverString, inesonicBotString);
+                    headers.insert(contentTypeString, response->contentType());
+
+                    if (response->isStreamingResponse()) {
+                        success = session.sendStreamedResponse(
+                            response->statusCode(),
+                            headers,
+                            *static_cast<StreamingResponse*>(response)
+                        );
+                    } else if (response->isFileResponse()) {
+                        const FileResponse* fileResponse = static_cast<const FileResponse*>(response);
+                        if (fileResponse->isOpen()) {
+                            success = session.sendFileResponse(
+                                response->statusCode(),
+                                headers,
+                                fileResponse->fileDescriptor(),
+                                fileResponse->offset(),
+                                fileResponse->length()
+                            );
                         } else {
                             session.sendFailedResponse(StatusCode::INTERNAL_SERVER_ERROR);
                         }
                     } else {
-                        session.sendFailedResponse(StatusCode::UNAUTHORIZED);
+                        QByteArray responsePayload = response->asByteArray();
+                        success = session.sendResponse(response->statusCode(), headers, responsePayload);
                     }
+
+                    delete response;
+                } else {
+                    session.sendFailedResponse(StatusCode::INTERNAL_SERVER_ERROR);
                 }
             } else {
-                session.sendFailedResponse(StatusCode::PRECONDITION_FAILED);
+                session.sendFailedResponse(StatusCode::UNAUTHORIZED);
             }
-        } else {
-            session.sendFailedResponse(StatusCode::PRECONDITION_FAILED);
         }
     }
+
+
+    Handler::StatusCode InesonicBinaryRestHandler::checkRequestHead(const Session& session) const {
+        StatusCode         result     = StatusCode::OK;
+        QByteArray         windowHint = session.header(xInesonicWindowString);
+        unsigned long long timeWindow;
+
+        if (session.header(contentTypeString) != applicationOctetStreamString) {
+            result = StatusCode::PRECONDITION_FAILED;
+        } else if (!windowHint.isEmpty() && !parseTimeWindow(windowHint, timeWindow)) {
+            result = StatusCode::BAD_REQUEST;
+        }
+
+        return result;
+    }
 }
@@ -35,6 +35,7 @@
 #include "rest_api_in_v1_customer_data.h"
 #include "rest_api_in_v1_binary_response.h"
 #include "rest_api_in_v1_authentication_helpers.h"
+#include "rest_api_in_v1_base64.h"
 #include "rest_api_in_v1_handler.h"
 #include "rest_api_in_v1_inesonic_customer_binary_rest_handler.h"
 #include "rest_api_in_v1_inesonic_customer_binary_rest_handler_private.h"
@@ -50,103 +51,116 @@ namespace RestApiInV1 {
     InesonicCustomerBinaryRestHandler::~InesonicCustomerBinaryRestHandler() {}
 
 
+    MacAlgorithm InesonicCustomerBinaryRestHandler::macAlgorithm() const {
+        return MacAlgorithm::HMAC_SHA256;
+    }
+
+
+    unsigned long long InesonicCustomerBinaryRestHandler::maximumBodySize() const {
+        return defaultMaximumPayloadSize;
+    }
+
+
     void InesonicCustomerBinaryRestHandler::session(Session& session) {
         StatusCode statusCode = StatusCode::BAD_REQUEST;
         QByteArray payload;
         QString    responseContentType;
+        bool       success = true;
+
+        QString path = session.path();
+
+        // The content type has already been vetted by checkRequestHead.
+        QByteArray receivedData;
+        success = session.readBody(receivedData);
+        if (success) {
+            QJsonParseError jsonParseError;
+            QJsonDocument   document = QJsonDocument::fromJson(receivedData, &jsonParseError);
+            if (jsonParseError.error == QJsonParseError::ParseError::NoError && document.isObject()) {
+                QJsonObject jsonObject = document.object();
+                bool        hasWindow  = jsonObject.contains("window");
+                if (jsonObject.size() == (hasWindow ? 4 : 3)) {
+                    QJsonValue         cidValue   = jsonObject.value("cid");
+                    QJsonValue         dataValue  = jsonObject.value("data");
+                    QJsonValue         hashValue  = jsonObject.value("hash");
+                    unsigned           threadId   = session.threadId();
+                    unsigned long long timeWindow = 0;
+
+                    if (cidValue.isString()                                                        &&
+                        dataValue.isString()                                                       &&
+                        hashValue.isString()                                                       &&
+                        (!hasWindow || parseTimeWindow(jsonObject.value("window"), timeWindow))    ) {
+                        QString cid = cidValue.toString();
+                        unsigned long customerId = impl->customerId(cid, threadId);
+                        if (customerId != 0) {
+                            QByteArray secret = impl->customerSecret(customerId, threadId);
+
+                            QByteArray decodedHash;
+                            if (decodeBase64(hashValue.toString(), decodedHash)) {
+                                QByteArray decodedData;
+                                if (decodeBase64(dataValue.toString(), decodedData)) {
+                                    bool authenticated;
+                                    if (hasWindow) {
+                                        authenticated = checkHash(
+                                            decodedData,
+                                            decodedHash,
+                                            secret,
+                                            timeWindow,
+                                            macAlgorithm()
+                                        );
+                                    } else {
+                                        authenticated = checkHash(decodedData, decodedHash, secret, macAlgorithm());
+                                    }
 
-        QString path = session.requestUri().path();
-
-        QByteArray contentType = session.headers().value(contentTypeString);
-        if (contentType == applicationJsonString) {
-            bool               success;
-            QByteArray         contentLengthArray = session.headers().value(contentLengthString);
-            unsigned long long contentLength      = contentLengthArray.toULongLong(&success);
-
-            QByteArray receivedData;
-            while (success && static_cast<unsigned long long>(receivedData.size()) < contentLength) {
-                success = session.readData(receivedData);
-            }
-
-            if (success) {
-                QJsonParseError jsonParseError;
-                QJsonDocument   document = QJsonDocument::fromJson(receivedData, &jsonParseError);
-                if (jsonParseError.error == QJsonParseError::ParseError::NoError && document.isObject()) {
-                    QJsonObject jsonObject = document.object();
-                    if (jsonObject.size() == 3) {
-                        QJsonValue cidValue  = jsonObject.value("cid");
-                        QJsonValue dataValue = jsonObject.value("data");
-                        QJsonValue hashValue = jsonObject.value("hash");
-                        unsigned   threadId  = session.threadId();
-
-                        if (cidValue.isString() && dataValue.isString() && hashValue.isString()) {
-                            QString cid = cidValue.toString();
-                            unsigned long customerId = impl->customerId(cid, threadId);
-                            if (customerId != 0) {
-                                QByteArray secret = impl->customerSecret(customerId, threadId);
-
-                                QByteArray::FromBase64Result decodedHash = QByteArray::fromBase64Encoding(
-                                    hashValue.toString().toUtf8(),
-                                    QByteArray::Base64Option::Base64Encoding | QByteArray::AbortOnBase64DecodingErrors
-                                );
-
-                                if (decodedHash.decodingStatus == QByteArray::Base64DecodingStatus::Ok) {
-                                    QByteArray::FromBase64Result decodedData = QByteArray::fromBase64Encoding(
-                                        dataValue.toString().toUtf8(),
-                                          QByteArray::Base64Option::Base64Encoding
-                                        | QByteArray::AbortOnBase64DecodingErrors
-                                    );
-
-                                    if (decodedData.decodingStatus == QByteArray::Base64DecodingStatus::Ok) {
-                                        if (checkHash(*decodedData, *decodedHash, secret)) {
-                                            QJsonParseError jsonParseError;
-                                            QJsonDocument   jsonMessage = QJsonDocument::fromJson(
-                                                *decodedData,
-                                                &jsonParseError
+                                    if (authenticated) {
+                                        QJsonParseError jsonParseError;
+                                        QJsonDocument   jsonMessage = QJsonDocument::fromJson(
+                                            decodedData,
+                                            &jsonParseError
+                                        );
+                                        if (jsonParseError.error == QJsonParseError::ParseError::NoError) {
+                                            BinaryResponse response = processAuthenticatedRequest(
+                                                path,
+                                                customerId,
+                                                jsonMessage,
+                                                threadId
                                             );
-                                            if (jsonParseError.error == QJsonParseError::ParseError::NoError) {
-                                                BinaryResponse response = processAuthenticatedRequest(
-                                                    path,
-                                                    customerId,
-                                                    jsonMessage,
-                                                    threadId
-                                                );
-
-                                                statusCode          = response.statusCode();
-                                                responseContentType = response.contentType();
-                                                payload             = response.asByteArray();
-                                            }
-                                        } else {
-                                            statusCode = StatusCode::UNAUTHORIZED;
+
+                                            statusCode          = response.statusCode();
+                                            responseContentType = response.contentType();
+                                            payload             = response.asByteArray();
                                         }
+                                    } else {
+                                        statusCode = StatusCode::UNAUTHORIZED;
                                     }
                                 }
-                            } else {
-                                statusCode = StatusCode::FORBIDDEN;
                             }
+                        } else {
+                            statusCode = StatusCode::FORBIDDEN;
                         }
                     }
                 }
-            } else {
-                statusCode = StatusCode::INTERNAL_SERVER_ERROR;
             }
-        } else {
-            statusCode = StatusCode::PRECONDITION_FAILED;
         }
 
         if (statusCode == StatusCode::OK) {
             Headers headers;
             headers.insert(serverString, inesonicBotString);
             headers.insert(contentTypeString, responseContentType.toUtf8());
-            headers.insert(contentLengthString, QByteArray::number(payload.size()));
-            headers.insert(connectionString, connectionCloseString);
 
-            bool success = session.sendResponseHeader(statusCode, headers);
-            if (success) {
-                session.sendData(payload);
-            }
-        } else {
+            session.sendResponse(statusCode, headers, payload);
+        } else if (success) {
+            // A failed body read has already been answered by the session.
             session.sendFailedResponse(statusCode);
         }
     }
+
+
+    Handler::StatusCode InesonicCustomerBinaryRestHandler::checkRequestHead(const Session& session) const {
+        StatusCode result = StatusCode::OK;
+        if (session.header(contentTypeString) != applicationJsonString) {
+            result = StatusCode::PRECONDITION_FAILED;
+        }
+
+        return result;
+    }
 }
@@ -33,6 +33,7 @@
 
 #include "rest_api_in_v1_handler.h"
 #include "rest_api_in_v1_authentication_helpers.h"
+#include "rest_api_in_v1_base64.h"
 #include "rest_api_in_v1_customer_data.h"
 #include "rest_api_in_v1_json_response.h"
 #include "rest_api_in_v1_rest_handler.h"
@@ -50,6 +51,11 @@ namespace RestApiInV1 {
     InesonicCustomerRestHandler::~InesonicCustomerRestHandler() {}
 
 
+    MacAlgorithm InesonicCustomerRestHandler::macAlgorithm() const {
+        return MacAlgorithm::HMAC_SHA256;
+    }
+
+
     JsonResponse InesonicCustomerRestHandler::processRequest(
             const QString&       path,
             const QJsonDocument& request,
@@ -59,33 +65,43 @@ namespace RestApiInV1 {
 
         if (request.isObject()) {
             QJsonObject jsonObject = request.object();
-            if (jsonObject.size() == 3) {
-                QJsonValue cidValue  = jsonObject.value("cid");
-                QJsonValue dataValue = jsonObject.value("data");
-                QJsonValue hashValue = jsonObject.value("hash");
+            bool        hasWindow  = jsonObject.contains("window");
+            if (jsonObject.size() == (hasWindow ? 4 : 3)) {
+                QJsonValue         cidValue   = jsonObject.value("cid");
+                QJsonValue         dataValue  = jsonObject.value("data");
+                QJsonValue         hashValue  = jsonObject.value("hash");
+                unsigned long long timeWindow = 0;
 
-                if (cidValue.isString() && dataValue.isString() && hashValue.isString()) {
+                if (cidValue.isString()                                                        &&
+                    dataValue.isString()                                                       &&
+                    hashValue.isString()                                                       &&
+                    (!hasWindow || parseTimeWindow(jsonObject.value("window"), timeWindow))    ) {
                     QString cid = cidValue.toString();
                     unsigned long customerId = impl->customerId(cid, threadId);
                     if (customerId != 0) {
                         QByteArray secret = impl->customerSecret(customerId, threadId);
 
-                        QByteArray::FromBase64Result decodedHash = QByteArray::fromBase64Encoding(
-                            hashValue.toString().toUtf8(),
-                            QByteArray::Base64Option::Base64Encoding | QByteArray::AbortOnBase64DecodingErrors
-                        );
-
-                        if (decodedHash.decodingStatus == QByteArray::Base64DecodingStatus::Ok) {
-                            QByteArray::FromBase64Result decodedData = QByteArray::fromBase64Encoding(
-                                dataValue.toString().toUtf8(),
-                                QByteArray::Base64Option::Base64Encoding | QByteArray::AbortOnBase64DecodingErrors
-                            );
+                        QByteArray decodedHash;
+                        if (decodeBase64(hashValue.toString(), decodedHash)) {
+                            QByteArray decodedData;
+                            if (decodeBase64(dataValue.toString(), decodedData)) {
+                                bool authenticated;
+                                if (hasWindow) {
+                                    authenticated = checkHash(
+                                        decodedData,
+                                        decodedHash,
+                                        secret,
+                                        timeWindow,
+                                        macAlgorithm()
+                                    );
+                                } else {
+                                    authenticated = checkHash(decodedData, decodedHash, secret, macAlgorithm());
+                                }
 
-                            if (decodedData.decodingStatus == QByteArray::Base64DecodingStatus::Ok) {
-                                if (checkHash(*decodedData, *decodedHash, secret)) {
+                                if (authenticated) {
                                     QJsonParseError jsonParseError;
                                     QJsonDocument   jsonMessage = QJsonDocument::fromJson(
-                                        *decodedData,
+                                        decodedData,
                                         &jsonParseError
                                     );
                                     if (jsonParseError.error == QJsonParseError::ParseError::NoError) {
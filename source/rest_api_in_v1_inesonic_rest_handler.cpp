@@ -33,6 +33,8 @@
 
 #include "rest_api_in_v1_handler.h"
 #include "rest_api_in_v1_json_response.h"
+#include "rest_api_in_v1_authentication_helpers.h"
+#include "rest_api_in_v1_base64.h"
 #include "rest_api_in_v1_inesonic_rest_handler_base.h"
 #include "rest_api_in_v1_inesonic_rest_handler_base_private.h"
 #include "rest_api_in_v1_inesonic_rest_handler.h"
@@ -57,26 +59,29 @@ namespace RestApiInV1 {
 
         if (request.isObject()) {
             QJsonObject jsonObject = request.object();
-            if (jsonObject.size() == 2) {
-                QJsonValue dataValue = jsonObject.value("data");
-                QJsonValue hashValue = jsonObject.value("hash");
+            bool        hasWindow  = jsonObject.contains("window");
+            if (jsonObject.size() == (hasWindow ? 3 : 2)) {
+                QJsonValue         dataValue  = jsonObject.value("data");
+                QJsonValue         hashValue  = jsonObject.value("hash");
+                unsigned long long timeWindow = 0;
 
-                if (dataValue.isString() && hashValue.isString()) {
-                    QByteArray::FromBase64Result decodedHash = QByteArray::fromBase64Encoding(
-                        hashValue.toString().toUtf8(),
-                        QByteArray::Base64Option::Base64Encoding | QByteArray::AbortOnBase64DecodingErrors
-                    );
-
-                    if (decodedHash.decodingStatus == QByteArray::Base64DecodingStatus::Ok) {
-                        QByteArray::FromBase64Result decodedData = QByteArray::fromBase64Encoding(
-                            dataValue.toString().toUtf8(),
-                            QByteArray::Base64Option::Base64Encoding | QByteArray::AbortOnBase64DecodingErrors
-                        );
+                if (dataValue.isString()                                                    &&
+                    hashValue.isString()                                                    &&
+                    (!hasWindow || parseTimeWindow(jsonObject.value("window"), timeWindow))    ) {
+                    QByteArray decodedHash;
+                    if (decodeBase64(hashValue.toString(), decodedHash)) {
+                        QByteArray decodedData;
+                        if (decodeBase64(dataValue.toString(), decodedData)) {
+                            bool authenticated;
+                            if (hasWindow) {
+                                authenticated = impl->checkHash(decodedData, decodedHash, timeWindow, macAlgorithm());
+                            } else {
+                                authenticated = impl->checkHash(decodedData, decodedHash, macAlgorithm());
+                            }
 
-                        if (decodedData.decodingStatus == QByteArray::Base64DecodingStatus::Ok) {
-                            if (impl->checkHash(*decodedData, *decodedHash)) {
+                            if (authenticated) {
                                 QJsonParseError jsonParseError;
-                                QJsonDocument   jsonMessage = QJsonDocument::fromJson(*decodedData, &jsonParseError);
+                                QJsonDocument   jsonMessage = QJsonDocument::fromJson(decodedData, &jsonParseError);
                                 if (jsonParseError.error == QJsonParseError::ParseError::NoError) {
                                     response = processAuthenticatedRequest(path, jsonMessage, threadId);
                                 }
@@ -51,4 +51,9 @@ namespace RestApiInV1 {
     void InesonicRestHandlerBase::setSecret(const QByteArray& newSecret) {
         impl->setSecret(newSecret);
     }
+
+
+    MacAlgorithm InesonicRestHandlerBase::macAlgorithm() const {
+        return MacAlgorithm::HMAC_SHA256;
+    }
 }
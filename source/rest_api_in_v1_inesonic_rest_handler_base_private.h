@@ -62,13 +62,47 @@ namespace RestApiInV1 {
              *
              * \param[in] receivedHash The received hash to be checked.
              *
+             * \param[in] algorithm    The message authentication code used by the client.
+             *
              * \return Returns true if the hash is correct.  Returns false if the hash is incorrect.
              */
             inline bool checkHash(
                     const QByteArray& receivedData,
-                    const QByteArray& receivedHash
+                    const QByteArray& receivedHash,
+                    MacAlgorithm      algorithm
+                ) const {
+                return RestApiInV1::checkHash(receivedData, receivedHash, currentSecret, algorithm);
+            }
+
+            /**
+             * Method that checks our hash against the single time window the client says it used.
+             *
+             * \param[in] receivedData The raw data to be checked.
+             *
+             * \param[in] receivedHash The received hash to be checked.
+             *
+             * \param[in] timeWindow   The time window used by the client.
+             *
+             * \param[in] algorithm    The message authentication code used by the client.
+             *
+             * \return Returns true if the hash is correct.  Returns false if the hash is incorrect.
+             */
+            inline bool checkHash(
+                    const QByteArray&  receivedData,
+                    const QByteArray&  receivedHash,
+                    unsigned long long timeWindow,
+                    MacAlgorithm       algorithm
                 ) const {
-                return RestApiInV1::checkHash(receivedData, receivedHash, currentSecret);
+                return RestApiInV1::checkHash(receivedData, receivedHash, currentSecret, timeWindow, algorithm);
+            }
+
+            /**
+             * Method you can use to obtain the padded secret, typically to construct a \ref HashVerifier.
+             *
+             * \return Returns the padded secret.
+             */
+            inline const QByteArray& secret() const {
+                return currentSecret;
             }
 
         private:
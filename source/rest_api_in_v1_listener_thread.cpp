@@ -0,0 +1,349 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::ListenerThread class.
+***********************************************************************************************************************/
+
+#include <QtGlobal>
+#include <QThread>
+#include <QString>
+#include <QByteArray>
+#include <QHostAddress>
+#include <QAbstractSocket>
+
+#include <atomic>
+
+#if (defined(Q_OS_LINUX))
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "rest_api_in_v1_server.h"
+#include "rest_api_in_v1_server_private.h"
+#include "rest_api_in_v1_connection_pool.h"
+#include "rest_api_in_v1_event_engine.h"
+#include "rest_api_in_v1_listener_thread.h"
+
+namespace RestApiInV1 {
+    ListenerThread::ListenerThread(
+            Server::Private*        serverPrivate,
+            unsigned                shardIndex,
+            unsigned                numberWorkers,
+            unsigned                firstThreadId,
+            unsigned                numberIoThreads,
+            unsigned long           maximumBufferSize,
+            Server::LoggingFunction loggingFunction,
+            QObject*                parent
+        ):QThread(
+            parent
+        ),currentServerPrivate(
+            serverPrivate
+        ),currentShardIndex(
+            shardIndex
+        ),listenDescriptor(
+            -1
+        ),wakeDescriptor(
+            -1
+        ),currentCpu(
+            -1
+        ),stopRequested(
+            false
+        ) {
+        connectionPool = new ConnectionPool(serverPrivate, maximumBufferSize, firstThreadId);
+        connectionPool->setLoggingFunction(loggingFunction);
+        connectionPool->resize(numberWorkers);
+
+        eventEngine = new EventEngine(connectionPool, serverPrivate, maximumBufferSize);
+        eventEngine->resize(numberIoThreads);
+    }
+
+
+    ListenerThread::~ListenerThread() {
+        if (isRunning()) {
+            stop();
+            wait();
+        }
+
+#if (defined(Q_OS_LINUX))
+        if (listenDescriptor >= 0) {
+            ::close(listenDescriptor);
+        }
+
+        if (wakeDescriptor >= 0) {
+            ::close(wakeDescriptor);
+        }
+#endif
+
+        delete eventEngine;
+        delete connectionPool;
+    }
+
+
+    bool ListenerThread::isSupported() {
+#if (defined(Q_OS_LINUX))
+        return true;
+#else
+        return false;
+#endif
+    }
+
+
+    QString ListenerThread::errorString() const {
+        return currentErrorString;
+    }
+
+
+    void ListenerThread::setLoggingFunction(Server::LoggingFunction newLoggingFunction) {
+        connectionPool->setLoggingFunction(newLoggingFunction);
+    }
+
+
+#if (defined(Q_OS_LINUX))
+
+    bool ListenerThread::listen(const QHostAddress& hostAddress, unsigned short port, bool useIncomingCpu) {
+        struct sockaddr_storage socketAddress;
+        socklen_t               socketAddressLength;
+        bool                    dualStack = false;
+
+        std::memset(&socketAddress, 0, sizeof(socketAddress));
+        if (hostAddress.protocol() == QAbstractSocket::IPv4Protocol) {
+            struct sockaddr_in* ipv4Address = reinterpret_cast<struct sockaddr_in*>(&socketAddress);
+            ipv4Address->sin_family      = AF_INET;
+            ipv4Address->sin_port        = htons(port);
+            ipv4Address->sin_addr.s_addr = htonl(hostAddress.toIPv4Address());
+
+            socketAddressLength = sizeof(struct sockaddr_in);
+        } else {
+            struct sockaddr_in6* ipv6Address = reinterpret_cast<struct sockaddr_in6*>(&socketAddress);
+            ipv6Address->sin6_family = AF_INET6;
+            ipv6Address->sin6_port   = htons(port);
+
+            if (hostAddress.protocol() == QAbstractSocket::AnyIPProtocol) {
+                ipv6Address->sin6_addr = in6addr_any;
+                dualStack              = true;
+            } else {
+                std::memcpy(&ipv6Address->sin6_addr, hostAddress.toIPv6Address().c, 16);
+            }
+
+            socketAddressLength = sizeof(struct sockaddr_in6);
+        }
+
+        listenDescriptor = ::socket(socketAddress.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenDescriptor < 0 && dualStack && errno == EAFNOSUPPORT) {
+            // No IPv6 on this host.  Fall back to listening on every IPv4 address.
+            struct sockaddr_in* ipv4Address = reinterpret_cast<struct sockaddr_in*>(&socketAddress);
+            std::memset(&socketAddress, 0, sizeof(socketAddress));
+            ipv4Address->sin_family      = AF_INET;
+            ipv4Address->sin_port        = htons(port);
+            ipv4Address->sin_addr.s_addr = htonl(INADDR_ANY);
+
+            socketAddressLength = sizeof(struct sockaddr_in);
+            dualStack           = false;
+            listenDescriptor    = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        }
+
+        bool success = (listenDescriptor >= 0);
+        if (!success) {
+            recordError("socket");
+        }
+
+        int enable  = 1;
+        int disable = 0;
+        if (success && ::setsockopt(listenDescriptor, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) != 0) {
+            success = false;
+            recordError("SO_REUSEADDR");
+        }
+
+        if (success && ::setsockopt(listenDescriptor, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) != 0) {
+            success = false;
+            recordError("SO_REUSEPORT");
+        }
+
+        if (success && dualStack) {
+            if (::setsockopt(listenDescriptor, IPPROTO_IPV6, IPV6_V6ONLY, &disable, sizeof(disable)) != 0) {
+                success = false;
+                recordError("IPV6_V6ONLY");
+            }
+        }
+
+        if (success && useIncomingCpu) {
+            int numberCpus = QThread::idealThreadCount();
+            if (numberCpus > 0) {
+                currentCpu = static_cast<int>(currentShardIndex % static_cast<unsigned>(numberCpus));
+
+#if (defined(SO_INCOMING_CPU))
+                // This is a locality hint only.  Older kernels lack the option so failures are not fatal.
+                ::setsockopt(listenDescriptor, SOL_SOCKET, SO_INCOMING_CPU, &currentCpu, sizeof(currentCpu));
+#endif
+            }
+        }
+
+        if (success) {
+            const struct sockaddr* address = reinterpret_cast<const struct sockaddr*>(&socketAddress);
+            if (::bind(listenDescriptor, address, socketAddressLength) != 0) {
+                success = false;
+                recordError("bind");
+            }
+        }
+
+        if (success && ::listen(listenDescriptor, listenBacklog) != 0) {
+            success = false;
+            recordError("listen");
+        }
+
+        if (success) {
+            wakeDescriptor = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (wakeDescriptor < 0) {
+                success = false;
+                recordError("eventfd");
+            }
+        }
+
+        if (!success && listenDescriptor >= 0) {
+            ::close(listenDescriptor);
+            listenDescriptor = -1;
+        }
+
+        return success;
+    }
+
+
+    void ListenerThread::stop() {
+        stopRequested.store(true);
+
+        if (wakeDescriptor >= 0) {
+            std::uint64_t count        = 1;
+            ssize_t       bytesWritten = ::write(wakeDescriptor, &count, sizeof(count));
+            (void) bytesWritten;
+        }
+    }
+
+
+    void ListenerThread::run() {
+        if (currentCpu >= 0) {
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            CPU_SET(currentCpu, &cpuSet);
+
+            ::pthread_setaffinity_np(::pthread_self(), sizeof(cpuSet), &cpuSet);
+        }
+
+        struct pollfd descriptors[2];
+        descriptors[0].fd     = listenDescriptor;
+        descriptors[0].events = POLLIN;
+        descriptors[1].fd     = wakeDescriptor;
+        descriptors[1].events = POLLIN;
+
+        while (!stopRequested.load(std::memory_order_relaxed)) {
+            descriptors[0].revents = 0;
+            descriptors[1].revents = 0;
+
+            int numberReady = ::poll(descriptors, 2, -1);
+            if (numberReady > 0 && (descriptors[0].revents & POLLIN) != 0) {
+                acceptConnections();
+            }
+        }
+    }
+
+
+    void ListenerThread::acceptConnections() {
+        bool moreConnections = true;
+        while (moreConnections && !stopRequested.load(std::memory_order_relaxed)) {
+            int socketDescriptor = ::accept4(listenDescriptor, nullptr, nullptr, SOCK_CLOEXEC);
+            if (socketDescriptor >= 0) {
+                if (eventEngine->size() > 0) {
+                    eventEngine->addSocket(socketDescriptor);
+                } else {
+                    // Waiting in short steps lets a stop request through while every worker is busy.
+                    bool started = false;
+                    while (!started && !stopRequested.load(std::memory_order_relaxed)) {
+                        started = connectionPool->tryStartSession(
+                            socketDescriptor,
+                            QByteArray(),
+                            nullptr,
+                            workerWaitInterval
+                        );
+                    }
+
+                    if (!started) {
+                        ::close(socketDescriptor);
+                    }
+                }
+            } else if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                currentServerPrivate->sessionError(
+                    QString("Shard %1 could not accept connection: %2")
+                    .arg(currentShardIndex)
+                    .arg(QString::fromLocal8Bit(std::strerror(errno)))
+                );
+
+                QThread::msleep(acceptBackoffInterval);
+                moreConnections = false;
+            } else if (errno != EINTR && errno != ECONNABORTED) {
+                moreConnections = false;
+            }
+        }
+    }
+
+
+    void ListenerThread::recordError(const char* operation) {
+        currentErrorString = QString("%1 failed: %2")
+                             .arg(QString::fromLatin1(operation))
+                             .arg(QString::fromLocal8Bit(std::strerror(errno)));
+    }
+
+#else
+
+    bool ListenerThread::listen(
+            const QHostAddress& /* hostAddress */,
+            unsigned short      /* port */,
+            bool                /* useIncomingCpu */
+        ) {
+        currentErrorString = QString("Sharded listeners are not supported on this platform.");
+        return false;
+    }
+
+
+    void ListenerThread::stop() {
+        stopRequested.store(true);
+    }
+
+
+    void ListenerThread::run() {}
+
+
+    void ListenerThread::acceptConnections() {}
+
+
+    void ListenerThread::recordError(const char* operation) {
+        currentErrorString = QString("%1 failed").arg(QString::fromLatin1(operation));
+    }
+
+#endif
+}
@@ -0,0 +1,206 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::ListenerThread class.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_LISTENER_THREAD_H
+#define REST_API_IN_V1_LISTENER_THREAD_H
+
+#include <QtGlobal>
+#include <QThread>
+#include <QString>
+#include <QHostAddress>
+
+#include <atomic>
+
+#include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_server.h"
+#include "rest_api_in_v1_server_private.h"
+
+namespace RestApiInV1 {
+    class REST_API_V1_PUBLIC_API ConnectionPool;
+    class REST_API_V1_PUBLIC_API EventEngine;
+
+    /**
+     * Class that owns one shard of a sharded server.  Each shard has its own listening socket, bound to the shared
+     * port using SO_REUSEPORT, its own accept loop running in this thread, and its own set of worker and I/O threads.
+     * The kernel spreads incoming connections across the shards so accept throughput scales with the number of
+     * shards rather than being limited by a single event loop.
+     *
+     * Shards are only supported on Linux.
+     */
+    class REST_API_V1_PUBLIC_API ListenerThread:public QThread {
+        public:
+            /**
+             * Constructor
+             *
+             * \param[in] serverPrivate     The server instance.
+             *
+             * \param[in] shardIndex        The zero based index of this shard.
+             *
+             * \param[in] numberWorkers     The number of worker threads owned by this shard.
+             *
+             * \param[in] firstThreadId     The thread ID to assign to the first worker in this shard.
+             *
+             * \param[in] numberIoThreads   The number of I/O threads owned by this shard.
+             *
+             * \param[in] maximumBufferSize The maximum amount of data a worker is allowed to read at once.
+             *
+             * \param[in] loggingFunction   The logging function handed to workers.
+             *
+             * \param[in] parent            The pointer to the parent object.
+             */
+            ListenerThread(
+                Server::Private*        serverPrivate,
+                unsigned                shardIndex,
+                unsigned                numberWorkers,
+                unsigned                firstThreadId,
+                unsigned                numberIoThreads,
+                unsigned long           maximumBufferSize,
+                Server::LoggingFunction loggingFunction,
+                QObject*                parent = nullptr
+            );
+
+            ~ListenerThread() override;
+
+            /**
+             * Method you can use to determine if shards are supported on this platform.
+             *
+             * \return Returns true if shards are supported.  Returns false if shards are not supported.
+             */
+            static bool isSupported();
+
+            /**
+             * Method you can use to create and bind this shard's listening socket.  Call QThread::start after this
+             * method succeeds to begin accepting connections.
+             *
+             * \param[in] hostAddress       The host address to be monitored.
+             *
+             * \param[in] port              The port to be monitored.
+             *
+             * \param[in] useIncomingCpu    If true, the socket will prefer connections whose packets are processed
+             *                              on the CPU matching this shard and the accept loop will be pinned to that
+             *                              CPU.
+             *
+             * \return Returns true on success.  Returns false on error.
+             */
+            bool listen(const QHostAddress& hostAddress, unsigned short port, bool useIncomingCpu);
+
+            /**
+             * Method you can use to obtain a description of the last error reported by \ref listen.
+             *
+             * \return Returns the error description.
+             */
+            QString errorString() const;
+
+            /**
+             * Method you can use to set the logging function handed to this shard's workers.
+             *
+             * \param[in] newLoggingFunction The new logging function to be used.
+             */
+            void setLoggingFunction(Server::LoggingFunction newLoggingFunction);
+
+            /**
+             * Method you can use to request that the accept loop exit.  Call QThread::wait to wait for the thread to
+             * finish.
+             */
+            void stop();
+
+        private:
+            /**
+             * The time we back off when the process runs out of file descriptors, in milliseconds.
+             */
+            static constexpr unsigned long acceptBackoffInterval = 10;
+
+            /**
+             * The time we wait for an idle worker before checking for a stop request, in milliseconds.
+             */
+            static constexpr int workerWaitInterval = 10;
+
+            /**
+             * The listen backlog for each shard.
+             */
+            static constexpr int listenBacklog = 1024;
+
+            /**
+             * Method that runs the accept loop.
+             */
+            void run() override;
+
+            /**
+             * Method that accepts every pending connection on the listening socket.
+             */
+            void acceptConnections();
+
+            /**
+             * Method that records the last system error.
+             *
+             * \param[in] operation A short description of the failed operation.
+             */
+            void recordError(const char* operation);
+
+            /**
+             * The underlying server private instance.
+             */
+            Server::Private* currentServerPrivate;
+
+            /**
+             * The index of this shard.
+             */
+            unsigned currentShardIndex;
+
+            /**
+             * The listening socket.
+             */
+            int listenDescriptor;
+
+            /**
+             * Event file descriptor used to wake the accept loop.
+             */
+            int wakeDescriptor;
+
+            /**
+             * The CPU this shard's accept loop is pinned to.  A negative value indicates no pinning.
+             */
+            int currentCpu;
+
+            /**
+             * The last error reported by \ref listen.
+             */
+            QString currentErrorString;
+
+            /**
+             * Flag indicating that the thread should exit.
+             */
+            std::atomic<bool> stopRequested;
+
+            /**
+             * The workers owned by this shard.
+             */
+            ConnectionPool* connectionPool;
+
+            /**
+             * The I/O threads owned by this shard.
+             */
+            EventEngine* eventEngine;
+    };
+};
+
+#endif
@@ -0,0 +1,215 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::LockFreeQueue template class.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_LOCK_FREE_QUEUE_H
+#define REST_API_IN_V1_LOCK_FREE_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+#include "rest_api_in_v1_common.h"
+
+namespace RestApiInV1 {
+    /**
+     * Bounded multiple-producer, multiple-consumer queue.  The queue never takes a lock.  Each slot carries a sequence
+     * number that tells producers and consumers whether the slot is ready for them, so a single compare-and-swap on
+     * the head or tail position is all that is needed to claim a slot.
+     *
+     * The capacity is fixed at construction and is always rounded up to a power of two.
+     *
+     * \param T The type of value held in the queue.  The type must be default constructible and copyable.
+     */
+    template<typename T> class LockFreeQueue {
+        public:
+            /**
+             * Constructor
+             *
+             * \param[in] minimumCapacity The minimum number of entries the queue must be able to hold.
+             */
+            LockFreeQueue(unsigned long minimumCapacity) {
+                unsigned long capacity = 2;
+                while (capacity < minimumCapacity) {
+                    capacity <<= 1;
+                }
+
+                currentMask = capacity - 1;
+                cells       = new Cell[capacity];
+
+                for (unsigned long i=0 ; i<capacity ; ++i) {
+                    cells[i].sequence.store(i, std::memory_order_relaxed);
+                }
+
+                enqueuePosition.store(0, std::memory_order_relaxed);
+                dequeuePosition.store(0, std::memory_order_relaxed);
+            }
+
+            ~LockFreeQueue() {
+                delete[] cells;
+            }
+
+            /**
+             * Method you can use to determine the capacity of this queue.
+             *
+             * \return Returns the queue capacity.
+             */
+            inline unsigned long capacity() const {
+                return currentMask + 1;
+            }
+
+            /**
+             * Method you can use to add a value to the queue.
+             *
+             * \param[in] value The value to be added.
+             *
+             * \return Returns true on success.  Returns false if the queue is full.
+             */
+            bool enqueue(const T& value) {
+                bool          success  = false;
+                bool          full     = false;
+                Cell*         cell     = nullptr;
+                unsigned long position = enqueuePosition.load(std::memory_order_relaxed);
+
+                while (!success && !full) {
+                    cell = cells + (position & currentMask);
+
+                    unsigned long sequence   = cell->sequence.load(std::memory_order_acquire);
+                    long          difference = static_cast<long>(sequence) - static_cast<long>(position);
+
+                    if (difference == 0) {
+                        success = enqueuePosition.compare_exchange_weak(
+                            position,
+                            position + 1,
+                            std::memory_order_relaxed
+                        );
+                    } else if (difference < 0) {
+                        full = true;
+                    } else {
+                        position = enqueuePosition.load(std::memory_order_relaxed);
+                    }
+                }
+
+                if (success) {
+                    cell->value = value;
+                    cell->sequence.store(position + 1, std::memory_order_release);
+                }
+
+                return success;
+            }
+
+            /**
+             * Method you can use to remove the oldest value from the queue.
+             *
+             * \param[out] value The value removed from the queue.  The value is left untouched if the queue is empty.
+             *
+             * \return Returns true on success.  Returns false if the queue is empty.
+             */
+            bool dequeue(T& value) {
+                bool          success  = false;
+                bool          empty    = false;
+                Cell*         cell     = nullptr;
+                unsigned long position = dequeuePosition.load(std::memory_order_relaxed);
+
+                while (!success && !empty) {
+                    cell = cells + (position & currentMask);
+
+                    unsigned long sequence   = cell->sequence.load(std::memory_order_acquire);
+                    long          difference = static_cast<long>(sequence) - static_cast<long>(position + 1);
+
+                    if (difference == 0) {
+                        success = dequeuePosition.compare_exchange_weak(
+                            position,
+                            position + 1,
+                            std::memory_order_relaxed
+                        );
+                    } else if (difference < 0) {
+                        empty = true;
+                    } else {
+                        position = dequeuePosition.load(std::memory_order_relaxed);
+                    }
+                }
+
+                if (success) {
+                    value = cell->value;
+                    cell->value = T();
+                    cell->sequence.store(position + currentMask + 1, std::memory_order_release);
+                }
+
+                return success;
+            }
+
+        private:
+            /**
+             * Size of a cache line.  Used to keep the producer and consumer positions from sharing a line.
+             */
+            static constexpr std::size_t cacheLineSize = 64;
+
+            /**
+             * A single queue slot.
+             */
+            struct Cell {
+                /**
+                 * The slot sequence number.
+                 */
+                std::atomic<unsigned long> sequence;
+
+                /**
+                 * The value held in the slot.
+                 */
+                T value;
+            };
+
+            LockFreeQueue(const LockFreeQueue& other) = delete;
+            LockFreeQueue& operator=(const LockFreeQueue& other) = delete;
+
+            /**
+             * The slot array.
+             */
+            Cell* cells;
+
+            /**
+             * Mask used to map positions to slots.
+             */
+            unsigned long currentMask;
+
+            /**
+             * Padding used to keep the positions below off the line holding the slot array pointer.
+             */
+            char padding1[cacheLineSize];
+
+            /**
+             * The next position to be written.
+             */
+            std::atomic<unsigned long> enqueuePosition;
+
+            /**
+             * Padding used to keep the producer and consumer positions on separate cache lines.
+             */
+            char padding2[cacheLineSize];
+
+            /**
+             * The next position to be read.
+             */
+            std::atomic<unsigned long> dequeuePosition;
+    };
+};
+
+#endif
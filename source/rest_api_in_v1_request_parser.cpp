@@ -0,0 +1,185 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::RequestParser class.
+***********************************************************************************************************************/
+
+#include <QVector>
+
+#include <cstring>
+
+#include "rest_api_in_v1_handler.h"
+#include "rest_api_in_v1_request_parser.h"
+
+namespace RestApiInV1 {
+    RequestParser::RequestParser(unsigned long maximumHeadLength):currentMaximumHeadLength(maximumHeadLength) {
+        reset();
+    }
+
+
+    RequestParser::~RequestParser() {}
+
+
+    void RequestParser::reset() {
+        currentState             = State::REQUEST_LINE;
+        lineOffset               = 0;
+        scanOffset               = 0;
+        currentHeadLength        = 0;
+        currentFailureStatusCode = Handler::StatusCode::BAD_REQUEST;
+        currentMethod            = Span { 0, 0 };
+        currentTarget            = Span { 0, 0 };
+        currentVersion           = Span { 0, 0 };
+
+        currentFields.clear();
+    }
+
+
+    RequestParser::State RequestParser::parse(const char* buffer, unsigned long length) {
+        bool moreData = true;
+        while (moreData && (currentState == State::REQUEST_LINE || currentState == State::HEADERS)) {
+            const char* terminator = nullptr;
+            if (scanOffset < length) {
+                terminator = static_cast<const char*>(std::memchr(buffer + scanOffset, '\n', length - scanOffset));
+            }
+
+            if (terminator != nullptr) {
+                unsigned long terminatorOffset = static_cast<unsigned long>(terminator - buffer);
+                unsigned long lineLength       = terminatorOffset - lineOffset;
+                if (lineLength > 0 && buffer[terminatorOffset - 1] == '\r') {
+                    --lineLength;
+                }
+
+                if (currentState == State::REQUEST_LINE) {
+                    if (parseRequestLine(buffer, lineOffset, lineLength)) {
+                        currentState = State::HEADERS;
+                    } else {
+                        fail(Handler::StatusCode::BAD_REQUEST);
+                    }
+                } else if (!parseField(buffer, lineOffset, lineLength)) {
+                    currentState      = State::COMPLETE;
+                    currentHeadLength = terminatorOffset + 1;
+                }
+
+                lineOffset = terminatorOffset + 1;
+                scanOffset = lineOffset;
+
+                if (lineOffset > currentMaximumHeadLength && currentState != State::FAILED) {
+                    fail(Handler::StatusCode::BAD_REQUEST);
+                }
+            } else {
+                scanOffset = length;
+                moreData   = false;
+
+                if (length > currentMaximumHeadLength) {
+                    if (currentState == State::REQUEST_LINE) {
+                        fail(Handler::StatusCode::REQUEST_URI_TOO_LONG);
+                    } else {
+                        fail(Handler::StatusCode::BAD_REQUEST);
+                    }
+                }
+            }
+        }
+
+        return currentState;
+    }
+
+
+    bool RequestParser::parseRequestLine(const char* buffer, unsigned long offset, unsigned long length) {
+        Span          parts[3];
+        unsigned      numberParts = 0;
+        unsigned long index       = offset;
+        unsigned long end         = offset + length;
+        bool          success     = true;
+
+        while (success && index < end) {
+            while (index < end && buffer[index] == ' ') {
+                ++index;
+            }
+
+            if (index < end) {
+                unsigned long partStart = index;
+                while (index < end && buffer[index] != ' ') {
+                    ++index;
+                }
+
+                if (numberParts < 3) {
+                    parts[numberParts] = Span { partStart, index - partStart };
+                    ++numberParts;
+                } else {
+                    success = false;
+                }
+            }
+        }
+
+        if (success && numberParts == 3) {
+            currentMethod  = parts[0];
+            currentTarget  = parts[1];
+            currentVersion = parts[2];
+        } else {
+            success = false;
+        }
+
+        return success;
+    }
+
+
+    bool RequestParser::parseField(const char* buffer, unsigned long offset, unsigned long length) {
+        unsigned long start = offset;
+        unsigned long end   = offset + length;
+
+        while (start < end && isWhitespace(buffer[start])) {
+            ++start;
+        }
+
+        while (end > start && isWhitespace(buffer[end - 1])) {
+            --end;
+        }
+
+        bool isField = (start < end);
+        if (isField) {
+            const char* colon = static_cast<const char*>(std::memchr(buffer + start, ':', end - start));
+
+            Field field;
+            if (colon != nullptr) {
+                unsigned long colonOffset = static_cast<unsigned long>(colon - buffer);
+                unsigned long valueStart  = colonOffset + 1;
+
+                while (valueStart < end && isWhitespace(buffer[valueStart])) {
+                    ++valueStart;
+                }
+
+                field.name  = Span { start, colonOffset - start };
+                field.value = Span { valueStart, end - valueStart };
+            } else {
+                field.name  = Span { start, end - start };
+                field.value = Span { end, 0 };
+            }
+
+            currentFields.append(field);
+        }
+
+        return isField;
+    }
+
+
+    void RequestParser::fail(Handler::StatusCode statusCode) {
+        currentState             = State::FAILED;
+        currentFailureStatusCode = statusCode;
+    }
+}
@@ -0,0 +1,289 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::RequestParser class.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_REQUEST_PARSER_H
+#define REST_API_IN_V1_REQUEST_PARSER_H
+
+#include <QVector>
+
+#include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_handler.h"
+
+namespace RestApiInV1 {
+    /**
+     * Incremental parser for the head of an HTTP request, that is, the request line and the header fields up to and
+     * including the terminating blank line.
+     *
+     * The parser is fed the entire receive buffer, starting at the first byte of the request, each time more data
+     * arrives.  It remembers where it stopped so bytes are only examined once.  Results are recorded as offsets into
+     * the buffer rather than as copies so the buffer may be reallocated between calls.
+     */
+    class REST_API_V1_PUBLIC_API RequestParser {
+        public:
+            /**
+             * The parser state.
+             */
+            enum class State {
+                /**
+                 * Waiting for the request line.
+                 */
+                REQUEST_LINE,
+
+                /**
+                 * Waiting for header fields.
+                 */
+                HEADERS,
+
+                /**
+                 * The request head has been fully received.
+                 */
+                COMPLETE,
+
+                /**
+                 * The request head is malformed or too long.
+                 */
+                FAILED
+            };
+
+            /**
+             * Type used to identify a range of bytes within the receive buffer.
+             */
+            struct Span {
+                /**
+                 * The offset to the first byte.
+                 */
+                unsigned long offset;
+
+                /**
+                 * The number of bytes.
+                 */
+                unsigned long length;
+            };
+
+            /**
+             * Type used to identify a single header field.
+             */
+            struct Field {
+                /**
+                 * The field name, as received.
+                 */
+                Span name;
+
+                /**
+                 * The field value with leading and trailing whitespace removed.
+                 */
+                Span value;
+            };
+
+            /**
+             * The default maximum request head length, in bytes.
+             */
+            static constexpr unsigned long defaultMaximumHeadLength = 65536;
+
+            /**
+             * Constructor
+             *
+             * \param[in] maximumHeadLength The maximum allowed length of the request head, in bytes.
+             */
+            RequestParser(unsigned long maximumHeadLength = defaultMaximumHeadLength);
+
+            ~RequestParser();
+
+            /**
+             * Method you can use to prepare the parser for a new request.
+             */
+            void reset();
+
+            /**
+             * Method you can use to parse newly received data.
+             *
+             * \param[in] buffer The receive buffer, starting at the first byte of the request.
+             *
+             * \param[in] length The number of valid bytes in the receive buffer.
+             *
+             * \return Returns the parser state after the new data has been examined.
+             */
+            State parse(const char* buffer, unsigned long length);
+
+            /**
+             * Method you can use to obtain the current parser state.
+             *
+             * \return Returns the current parser state.
+             */
+            inline State state() const {
+                return currentState;
+            }
+
+            /**
+             * Method you can use to determine the length of the request head.  The value is only meaningful once
+             * the parser reaches \ref State::COMPLETE.
+             *
+             * \return Returns the number of bytes occupied by the request head.
+             */
+            inline unsigned long headLength() const {
+                return currentHeadLength;
+            }
+
+            /**
+             * Method you can use to obtain the status code that should be reported when the parser fails.
+             *
+             * \return Returns the status code to report.
+             */
+            inline Handler::StatusCode failureStatusCode() const {
+                return currentFailureStatusCode;
+            }
+
+            /**
+             * Method you can use to obtain the location of the request method.
+             *
+             * \return Returns the span holding the request method.
+             */
+            inline const Span& method() const {
+                return currentMethod;
+            }
+
+            /**
+             * Method you can use to obtain the location of the request target.
+             *
+             * \return Returns the span holding the request target.
+             */
+            inline const Span& target() const {
+                return currentTarget;
+            }
+
+            /**
+             * Method you can use to obtain the location of the HTTP version.
+             *
+             * \return Returns the span holding the HTTP version.
+             */
+            inline const Span& version() const {
+                return currentVersion;
+            }
+
+            /**
+             * Method you can use to obtain the location of the header fields.
+             *
+             * \return Returns the header fields, in the order they were received.
+             */
+            inline const QVector<Field>& fields() const {
+                return currentFields;
+            }
+
+        private:
+            /**
+             * Method that parses the request line.
+             *
+             * \param[in] buffer The receive buffer.
+             *
+             * \param[in] offset The offset to the start of the line.
+             *
+             * \param[in] length The length of the line, excluding the line terminator.
+             *
+             * \return Returns true on success.  Returns false if the line is malformed.
+             */
+            bool parseRequestLine(const char* buffer, unsigned long offset, unsigned long length);
+
+            /**
+             * Method that parses a single header line.
+             *
+             * \param[in] buffer The receive buffer.
+             *
+             * \param[in] offset The offset to the start of the line.
+             *
+             * \param[in] length The length of the line, excluding the line terminator.
+             *
+             * \return Returns true if the line was a header field.  Returns false if the line was blank, marking the
+             *         end of the request head.
+             */
+            bool parseField(const char* buffer, unsigned long offset, unsigned long length);
+
+            /**
+             * Method that marks the parse as failed.
+             *
+             * \param[in] statusCode The status code to report.
+             */
+            void fail(Handler::StatusCode statusCode);
+
+            /**
+             * Method that determines if a character is considered whitespace.  Matches QByteArray::trimmed.
+             *
+             * \param[in] c The character to be tested.
+             *
+             * \return Returns true if the character is whitespace.
+             */
+            static inline bool isWhitespace(char c) {
+                return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+            }
+
+            /**
+             * The maximum allowed head length.
+             */
+            unsigned long currentMaximumHeadLength;
+
+            /**
+             * The current parser state.
+             */
+            State currentState;
+
+            /**
+             * Offset to the start of the line currently being received.
+             */
+            unsigned long lineOffset;
+
+            /**
+             * Offset where the search for the next line terminator resumes.
+             */
+            unsigned long scanOffset;
+
+            /**
+             * The length of the request head.
+             */
+            unsigned long currentHeadLength;
+
+            /**
+             * The status code to report on failure.
+             */
+            Handler::StatusCode currentFailureStatusCode;
+
+            /**
+             * The request method.
+             */
+            Span currentMethod;
+
+            /**
+             * The request target.
+             */
+            Span currentTarget;
+
+            /**
+             * The HTTP version.
+             */
+            Span currentVersion;
+
+            /**
+             * The header fields.
+             */
+            QVector<Field> currentFields;
+    };
+};
+
+#endif
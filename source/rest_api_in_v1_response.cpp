@@ -24,4 +24,14 @@
 
 namespace RestApiInV1 {
     Response::~Response() {}
+
+
+    bool Response::isStreamingResponse() const {
+        return false;
+    }
+
+
+    bool Response::isFileResponse() const {
+        return false;
+    }
 }
@@ -37,43 +37,48 @@ namespace RestApiInV1 {
     RestHandler::~RestHandler() {}
 
 
+    unsigned long long RestHandler::maximumBodySize() const {
+        return defaultMaximumPayloadSize;
+    }
+
+
     void RestHandler::session(Session& session) {
-        QString path = session.requestUri().path();
-
-        QByteArray contentType = session.headers().value(contentTypeString);
-        if (contentType == applicationJsonString || contentType == textPlainString) {
-            QByteArray receivedData;
-            bool success = session.readData(receivedData);
-            if (success) {
-                QJsonParseError jsonParseError;
-                QJsonDocument   request = QJsonDocument::fromJson(receivedData, &jsonParseError);
-
-                if (jsonParseError.error == QJsonParseError::ParseError::NoError) {
-                    JsonResponse response = processRequest(path, request, session.threadId());
-                    if (response.statusCode() == StatusCode::OK) {
-                        QByteArray responsePayload = response.toJson(QJsonDocument::JsonFormat::Compact);
-
-                        Headers headers;
-                        headers.insert(serverString, inesonicBotString);
-                        headers.insert(contentTypeString, response.contentType());
-                        headers.insert(contentLengthString, QByteArray::number(responsePayload.size()));
-                        headers.insert(connectionString, connectionCloseString);
-
-                        success = session.sendResponseHeader(response.statusCode(), headers);
-                        if (success) {
-                            session.sendData(responsePayload);
-                        }
-                    } else {
-                        session.sendResponseHeader(response.statusCode());
-                    }
+        QString path = session.path();
+
+        // The content type has already been vetted by checkRequestHead.
+        QByteArray receivedData;
+        bool success = session.readBody(receivedData);
+        if (success) {
+            QJsonParseError jsonParseError;
+            QJsonDocument   request = QJsonDocument::fromJson(receivedData, &jsonParseError);
+
+            if (jsonParseError.error == QJsonParseError::ParseError::NoError) {
+                JsonResponse response = processRequest(path, request, session.threadId());
+                if (response.statusCode() == StatusCode::OK) {
+                    QByteArray responsePayload = response.toJson(QJsonDocument::JsonFormat::Compact);
+
+                    Headers headers;
+                    headers.insert(serverString, inesonicBotString);
+                    headers.insert(contentTypeString, response.contentType());
+
+                    session.sendResponse(response.statusCode(), headers, responsePayload);
                 } else {
-                    session.sendFailedResponse(StatusCode::BAD_REQUEST);
+                    session.sendResponse(response.statusCode(), Headers(), QByteArray());
                 }
             } else {
-                session.sendFailedResponse(StatusCode::INTERNAL_SERVER_ERROR);
+                session.sendFailedResponse(StatusCode::BAD_REQUEST);
             }
-        } else {
-            session.sendFailedResponse(StatusCode::PRECONDITION_FAILED);
         }
     }
+
+
+    Handler::StatusCode RestHandler::checkRequestHead(const Session& session) const {
+        StatusCode result      = StatusCode::OK;
+        QByteArray contentType = session.header(contentTypeString);
+        if (contentType != applicationJsonString && contentType != textPlainString) {
+            result = StatusCode::PRECONDITION_FAILED;
+        }
+
+        return result;
+    }
 }
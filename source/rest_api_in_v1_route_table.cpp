@@ -0,0 +1,141 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::RouteTable class.
+***********************************************************************************************************************/
+
+#include <QString>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <atomic>
+
+#include "rest_api_in_v1_handler.h"
+#include "rest_api_in_v1_router.h"
+#include "rest_api_in_v1_route_table.h"
+
+namespace RestApiInV1 {
+    RouteTable::Reader::Reader():hazard(nullptr) {}
+
+
+    RouteTable::RouteTable():currentSnapshot(new Router) {}
+
+
+    RouteTable::~RouteTable() {
+        for (unsigned i=0 ; i<static_cast<unsigned>(readers.size()) ; ++i) {
+            delete readers.at(i);
+        }
+
+        for (unsigned i=0 ; i<static_cast<unsigned>(retiredSnapshots.size()) ; ++i) {
+            delete retiredSnapshots.at(i);
+        }
+
+        delete currentSnapshot.load();
+    }
+
+
+    bool RouteTable::insert(Handler::Method method, const QString& pattern, Handler* handler) {
+        QMutexLocker locker(&writerMutex);
+
+        Router* snapshot = new Router(*currentSnapshot.load(std::memory_order_relaxed));
+        bool    success  = snapshot->insert(method, pattern, handler);
+        if (success) {
+            retiredSnapshots.append(currentSnapshot.exchange(snapshot, std::memory_order_seq_cst));
+            reclaim();
+        } else {
+            delete snapshot;
+        }
+
+        return success;
+    }
+
+
+    Handler* RouteTable::handler(Handler::Method method, const QString& path) const {
+        QMutexLocker locker(&writerMutex);
+        return currentSnapshot.load(std::memory_order_relaxed)->handler(method, path);
+    }
+
+
+    void RouteTable::synchronize() {
+        writerMutex.lock();
+        reclaim();
+        QList<const Router*> pending = retiredSnapshots;
+        writerMutex.unlock();
+
+        while (!pending.isEmpty()) {
+            QThread::msleep(synchronizeInterval);
+
+            writerMutex.lock();
+            reclaim();
+
+            // Snapshots retired after we started can not hold handlers removed before we started.
+            QList<const Router*>::iterator it = pending.begin();
+            while (it != pending.end()) {
+                if (retiredSnapshots.contains(*it)) {
+                    ++it;
+                } else {
+                    it = pending.erase(it);
+                }
+            }
+
+            writerMutex.unlock();
+        }
+    }
+
+
+    RouteTable::Reader* RouteTable::addReader() {
+        QMutexLocker locker(&writerMutex);
+
+        Reader* reader = new Reader;
+        readers.append(reader);
+
+        return reader;
+    }
+
+
+    void RouteTable::removeReader(RouteTable::Reader* reader) {
+        QMutexLocker locker(&writerMutex);
+
+        readers.removeOne(reader);
+        delete reader;
+    }
+
+
+    void RouteTable::reclaim() {
+        QList<const Router*> inUse;
+        for (unsigned i=0 ; i<static_cast<unsigned>(readers.size()) ; ++i) {
+            const Router* snapshot = readers.at(i)->hazard.load(std::memory_order_seq_cst);
+            if (snapshot != nullptr) {
+                inUse.append(snapshot);
+            }
+        }
+
+        QList<const Router*>::iterator it = retiredSnapshots.begin();
+        while (it != retiredSnapshots.end()) {
+            if (inUse.contains(*it)) {
+                ++it;
+            } else {
+                delete *it;
+                it = retiredSnapshots.erase(it);
+            }
+        }
+    }
+}
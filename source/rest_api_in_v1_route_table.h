@@ -0,0 +1,181 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::RouteTable class.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_ROUTE_TABLE_H
+#define REST_API_IN_V1_ROUTE_TABLE_H
+
+#include <QString>
+#include <QList>
+#include <QMutex>
+
+#include <atomic>
+
+#include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_handler.h"
+#include "rest_api_in_v1_router.h"
+
+namespace RestApiInV1 {
+    /**
+     * Class that publishes the server's routing table so handlers can be registered, replaced, and removed while
+     * requests are being serviced.
+     *
+     * The table is held as an immutable \ref Router snapshot behind an atomic pointer.  Changes are applied to a copy
+     * of the current snapshot, which is then swapped in.  Readers never take a lock.  Each reader owns a hazard slot
+     * announcing the snapshot it is using; replaced snapshots are deleted by writers once no slot refers to them.
+     */
+    class REST_API_V1_PUBLIC_API RouteTable {
+        public:
+            /**
+             * Type used to hold a single reader's hazard slot.  Obtain one using \ref addReader.
+             */
+            class Reader {
+                friend class RouteTable;
+
+                private:
+                    Reader();
+
+                    /**
+                     * The snapshot currently in use by the reader.  A null pointer indicates no snapshot is in use.
+                     */
+                    std::atomic<const Router*> hazard;
+            };
+
+            RouteTable();
+
+            ~RouteTable();
+
+            /**
+             * Method you can use to add, replace, or remove a handler.  This method is safe to call from any thread
+             * while requests are being serviced.
+             *
+             * \param[in] method  The method required to trigger the handler.
+             *
+             * \param[in] pattern The path pattern.  See \ref Router for the supported syntax.
+             *
+             * \param[in] handler The handler to be triggered.  A null pointer removes the handler.
+             *
+             * \return Returns true on success.  Returns false if the pattern is malformed.
+             */
+            bool insert(Handler::Method method, const QString& pattern, Handler* handler);
+
+            /**
+             * Method you can use to locate the handler for a path from any thread.  This method takes a lock and is
+             * intended for use outside of the request path.
+             *
+             * \param[in] method The request method.
+             *
+             * \param[in] path   The path to get the handler for.
+             *
+             * \return Returns a pointer to the handler.  A null pointer is returned if no pattern matches.
+             */
+            Handler* handler(Handler::Method method, const QString& path) const;
+
+            /**
+             * Method you can use to wait until no reader is using a snapshot that was replaced before this call.
+             * Handlers removed or replaced before this call are no longer referenced by any reader once this method
+             * returns.  Calling this method while holding a snapshot will never return.
+             */
+            void synchronize();
+
+            /**
+             * Method you can use to obtain a hazard slot for a thread that will read the table.
+             *
+             * \return Returns the new slot.
+             */
+            Reader* addReader();
+
+            /**
+             * Method you can use to dispose of a hazard slot.  The slot must not hold a snapshot.
+             *
+             * \param[in] reader The slot to be disposed of.
+             */
+            void removeReader(Reader* reader);
+
+            /**
+             * Method you can use to obtain the current snapshot.  The snapshot remains valid until \ref release is
+             * called on the same slot.  Each slot can hold one snapshot at a time.
+             *
+             * \param[in] reader The caller's hazard slot.
+             *
+             * \return Returns the current snapshot.
+             */
+            inline const Router* acquire(Reader& reader) const {
+                const Router* snapshot = currentSnapshot.load(std::memory_order_acquire);
+                const Router* announced;
+
+                // Re-check after announcing so a writer that swapped the table before seeing our slot cannot free
+                // the snapshot we are about to use.
+                do {
+                    reader.hazard.store(snapshot, std::memory_order_seq_cst);
+                    announced = snapshot;
+                    snapshot  = currentSnapshot.load(std::memory_order_seq_cst);
+                } while (snapshot != announced);
+
+                return snapshot;
+            }
+
+            /**
+             * Method you can use to indicate that a reader is done with its snapshot.
+             *
+             * \param[in] reader The caller's hazard slot.
+             */
+            inline void release(Reader& reader) const {
+                reader.hazard.store(nullptr, std::memory_order_release);
+            }
+
+        private:
+            /**
+             * The time we wait between checks in \ref synchronize, in milliseconds.
+             */
+            static constexpr unsigned long synchronizeInterval = 1;
+
+            RouteTable(const RouteTable& other) = delete;
+            RouteTable& operator=(const RouteTable& other) = delete;
+
+            /**
+             * Method that deletes every retired snapshot that no reader is using.  The writer lock must be held.
+             */
+            void reclaim();
+
+            /**
+             * The current snapshot.
+             */
+            std::atomic<const Router*> currentSnapshot;
+
+            /**
+             * Lock serializing writers and changes to the reader list.
+             */
+            mutable QMutex writerMutex;
+
+            /**
+             * The readers' hazard slots.
+             */
+            QList<Reader*> readers;
+
+            /**
+             * Snapshots that have been replaced but may still be in use.
+             */
+            QList<const Router*> retiredSnapshots;
+    };
+};
+
+#endif
@@ -0,0 +1,324 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::Router class.
+***********************************************************************************************************************/
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+
+#include <cstring>
+
+#include "rest_api_in_v1_handler.h"
+#include "rest_api_in_v1_router.h"
+
+namespace RestApiInV1 {
+    const QByteArray Router::wildcardName("*");
+
+    Router::Node::Node():parameterChild(nullptr) {
+        for (unsigned i=0 ; i<numberMethods ; ++i) {
+            handlers[i]         = nullptr;
+            wildcardHandlers[i] = nullptr;
+        }
+    }
+
+
+    Router::Node::Node(
+            const Router::Node& other
+        ):children(
+            other.children
+        ),parameterChild(
+            nullptr
+        ),parameterName(
+            other.parameterName
+        ) {
+        for (QVector<Child>::iterator it=children.begin(),end=children.end() ; it!=end ; ++it) {
+            it->node = new Node(*it->node);
+        }
+
+        if (other.parameterChild != nullptr) {
+            parameterChild = new Node(*other.parameterChild);
+        }
+
+        for (unsigned i=0 ; i<numberMethods ; ++i) {
+            handlers[i]         = other.handlers[i];
+            wildcardHandlers[i] = other.wildcardHandlers[i];
+        }
+    }
+
+
+    Router::Node::~Node() {
+        for (QVector<Child>::const_iterator it=children.constBegin(),end=children.constEnd() ; it!=end ; ++it) {
+            delete it->node;
+        }
+
+        delete parameterChild;
+    }
+
+
+    Router::Router() {
+        root = new Node;
+    }
+
+
+    Router::Router(const Router& other) {
+        root = new Node(*other.root);
+    }
+
+
+    Router::~Router() {
+        delete root;
+    }
+
+
+    bool Router::insert(Handler::Method method, const QString& pattern, Handler* handler) {
+        QByteArray    utf8Pattern      = pattern.toUtf8();
+        const char*   data             = utf8Pattern.constData();
+        unsigned long offset           = 0;
+        unsigned long end              = static_cast<unsigned long>(utf8Pattern.size());
+        unsigned      numberParameters = 0;
+        bool          wildcard         = false;
+        bool          success          = (method != Handler::Method::NUMBER_METHODS);
+        Node*         node             = root;
+
+        if (end > 0 && data[0] == '/') {
+            offset = 1;
+        }
+
+        if (end > offset && data[end - 1] == '/') {
+            --end;
+        }
+
+        while (success && offset < end) {
+            const char*   slash      = static_cast<const char*>(std::memchr(data + offset, '/', end - offset));
+            unsigned long segmentEnd = end;
+            if (slash != nullptr) {
+                segmentEnd = static_cast<unsigned long>(slash - data);
+            }
+
+            const char*   segment       = data + offset;
+            unsigned long segmentLength = segmentEnd - offset;
+
+            if (wildcard) {
+                // Nothing may follow the wildcard.
+                success = false;
+            } else if (segmentLength == 1 && segment[0] == '*') {
+                wildcard = true;
+                ++numberParameters;
+            } else if (segmentLength > 2 && segment[0] == '{' && segment[segmentLength - 1] == '}') {
+                QByteArray parameterName(segment + 1, static_cast<int>(segmentLength - 2));
+                if (node->parameterChild == nullptr) {
+                    node->parameterChild                = new Node;
+                    node->parameterChild->parameterName = parameterName;
+                    node                                = node->parameterChild;
+                } else if (node->parameterChild->parameterName == parameterName) {
+                    node = node->parameterChild;
+                } else {
+                    success = false;
+                }
+
+                ++numberParameters;
+            } else if (std::memchr(segment, '{', segmentLength) != nullptr ||
+                       std::memchr(segment, '}', segmentLength) != nullptr    ) {
+                success = false;
+            } else {
+                bool found;
+                int  index = findChild(node, segment, segmentLength, found);
+                if (!found) {
+                    Child child;
+                    child.segment = QByteArray(segment, static_cast<int>(segmentLength));
+                    child.node    = new Node;
+
+                    node->children.insert(index, child);
+                }
+
+                node = node->children.at(index).node;
+            }
+
+            offset = segmentEnd + 1;
+        }
+
+        if (success && numberParameters > maximumNumberParameters) {
+            success = false;
+        }
+
+        if (success) {
+            if (wildcard) {
+                node->wildcardHandlers[static_cast<unsigned>(method)] = handler;
+            } else {
+                node->handlers[static_cast<unsigned>(method)] = handler;
+            }
+        }
+
+        return success;
+    }
+
+
+    Handler* Router::lookup(
+            Handler::Method method,
+            const char*     path,
+            unsigned long   pathLength,
+            const char*     host,
+            unsigned long   hostLength,
+            Router::Match&  match
+        ) const {
+        Handler*      result = nullptr;
+        unsigned long offset = 0;
+        unsigned long end    = pathLength;
+
+        match.numberParameters = 0;
+
+        if (end > 0 && path[0] == '/') {
+            offset = 1;
+        }
+
+        if (end > offset && path[end - 1] == '/') {
+            --end;
+        }
+
+        if (method != Handler::Method::NUMBER_METHODS) {
+            unsigned methodIndex = static_cast<unsigned>(method);
+            result = matchNode(root, methodIndex, path, offset, end, match);
+
+            if (result == nullptr && hostLength > 0) {
+                bool found;
+                int  index = findChild(root, host, hostLength, found);
+                if (found) {
+                    match.numberParameters = 0;
+                    result = matchNode(root->children.at(index).node, methodIndex, path, offset, end, match);
+                }
+            }
+        }
+
+        return result;
+    }
+
+
+    Handler* Router::handler(Handler::Method method, const QString& path) const {
+        QByteArray utf8Path = path.toUtf8();
+        Match      match;
+
+        return lookup(method, utf8Path.constData(), static_cast<unsigned long>(utf8Path.size()), nullptr, 0, match);
+    }
+
+
+    int Router::compareSegment(const QByteArray& segment, const char* data, unsigned long length) {
+        unsigned long segmentLength = static_cast<unsigned long>(segment.size());
+        unsigned long commonLength  = segmentLength;
+        if (length < commonLength) {
+            commonLength = length;
+        }
+
+        int result = std::memcmp(segment.constData(), data, commonLength);
+        if (result == 0) {
+            if (segmentLength < length) {
+                result = -1;
+            } else if (segmentLength > length) {
+                result = 1;
+            }
+        }
+
+        return result;
+    }
+
+
+    int Router::findChild(const Router::Node* node, const char* data, unsigned long length, bool& found) {
+        int low  = 0;
+        int high = node->children.size();
+
+        found = false;
+        while (!found && low < high) {
+            int middle     = low + (high - low) / 2;
+            int comparison = compareSegment(node->children.at(middle).segment, data, length);
+            if (comparison < 0) {
+                low = middle + 1;
+            } else if (comparison > 0) {
+                high = middle;
+            } else {
+                low   = middle;
+                found = true;
+            }
+        }
+
+        return low;
+    }
+
+
+    Handler* Router::matchNode(
+            const Router::Node* node,
+            unsigned            method,
+            const char*         path,
+            unsigned long       offset,
+            unsigned long       end,
+            Router::Match&      match
+        ) {
+        Handler* result = nullptr;
+
+        if (offset >= end) {
+            result = node->handlers[method];
+        } else {
+            const char*   slash      = static_cast<const char*>(std::memchr(path + offset, '/', end - offset));
+            unsigned long segmentEnd = end;
+            if (slash != nullptr) {
+                segmentEnd = static_cast<unsigned long>(slash - path);
+            }
+
+            unsigned long nextOffset = segmentEnd + 1;
+            if (nextOffset > end) {
+                nextOffset = end;
+            }
+
+            bool found;
+            int  index = findChild(node, path + offset, segmentEnd - offset, found);
+            if (found) {
+                result = matchNode(node->children.at(index).node, method, path, nextOffset, end, match);
+            }
+
+            if (result == nullptr && node->parameterChild != nullptr && segmentEnd > offset) {
+                unsigned   parameterIndex = match.numberParameters;
+                Parameter& parameter      = match.parameters[parameterIndex];
+
+                parameter.name   = &node->parameterChild->parameterName;
+                parameter.offset = offset;
+                parameter.length = segmentEnd - offset;
+
+                match.numberParameters = parameterIndex + 1;
+                result = matchNode(node->parameterChild, method, path, nextOffset, end, match);
+
+                if (result == nullptr) {
+                    match.numberParameters = parameterIndex;
+                }
+            }
+        }
+
+        if (result == nullptr && node->wildcardHandlers[method] != nullptr) {
+            Parameter& parameter = match.parameters[match.numberParameters];
+
+            parameter.name   = &wildcardName;
+            parameter.offset = offset;
+            parameter.length = end - offset;
+
+            ++match.numberParameters;
+            result = node->wildcardHandlers[method];
+        }
+
+        return result;
+    }
+}
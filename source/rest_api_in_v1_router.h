@@ -0,0 +1,279 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::Router class.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_ROUTER_H
+#define REST_API_IN_V1_ROUTER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+
+#include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_handler.h"
+
+namespace RestApiInV1 {
+    /**
+     * Routing table used to map request paths to handlers.  Patterns are compiled into a trie of path segments when
+     * they are registered so a lookup walks the request path once, without allocating memory.
+     *
+     * A pattern segment may be a literal, a parameter written as "{name}" that matches any single non-empty segment,
+     * or a final "*" that matches the remainder of the path, including an empty remainder.  Literals are preferred
+     * over parameters and parameters over wildcards.  Values captured by parameters are reported as offsets into the
+     * path so the caller's buffer may move between the lookup and the use of the values.
+     */
+    class REST_API_V1_PUBLIC_API Router {
+        public:
+            /**
+             * The maximum number of parameters, including a trailing wildcard, allowed in a single pattern.
+             */
+            static constexpr unsigned maximumNumberParameters = 8;
+
+            /**
+             * Type used to describe a single captured parameter.
+             */
+            struct Parameter {
+                /**
+                 * The parameter name.  The wildcard is reported under the name "*".
+                 */
+                const QByteArray* name;
+
+                /**
+                 * The offset to the first byte of the value, relative to the start of the path.
+                 */
+                unsigned long offset;
+
+                /**
+                 * The length of the value, in bytes.
+                 */
+                unsigned long length;
+            };
+
+            /**
+             * Type used to report the parameters captured by a lookup.
+             */
+            struct Match {
+                /**
+                 * The number of captured parameters.
+                 */
+                unsigned numberParameters;
+
+                /**
+                 * The captured parameters, in the order they appear in the path.
+                 */
+                Parameter parameters[maximumNumberParameters];
+            };
+
+            Router();
+
+            /**
+             * Copy constructor.  The trie is copied so the new table can be modified without affecting this one.
+             *
+             * \param[in] other The instance to be copied.
+             */
+            Router(const Router& other);
+
+            ~Router();
+
+            /**
+             * Method you can use to add a pattern to the table.  If a handler for the pattern and method already
+             * exists, it will be replaced.
+             *
+             * \param[in] method  The method required to trigger the handler.
+             *
+             * \param[in] pattern The path pattern.  Leading and trailing slashes are optional.
+             *
+             * \param[in] handler The handler to be triggered.
+             *
+             * \return Returns true on success.  Returns false if the pattern is malformed, places the wildcard
+             *         anywhere other than the last segment, has too many parameters, or names a parameter differently
+             *         from an existing pattern sharing the same prefix.
+             */
+            bool insert(Handler::Method method, const QString& pattern, Handler* handler);
+
+            /**
+             * Method you can use to locate the handler for a request path.
+             *
+             * \param[in]  method     The request method.
+             *
+             * \param[in]  path       The decoded request path.
+             *
+             * \param[in]  pathLength The length of the request path, in bytes.
+             *
+             * \param[in]  host       The host named in an absolute request target.  When the path has no handler,
+             *                        the path is tried again below a leading segment matching the host so that
+             *                        requests relayed by a proxy reach handlers registered as "/host/path".
+             *
+             * \param[in]  hostLength The length of the host, in bytes.  A value of 0 disables the host lookup.
+             *
+             * \param[out] match      Receives the captured parameters.
+             *
+             * \return Returns a pointer to the handler.  A null pointer is returned if no pattern matches.
+             */
+            Handler* lookup(
+                Handler::Method method,
+                const char*     path,
+                unsigned long   pathLength,
+                const char*     host,
+                unsigned long   hostLength,
+                Match&          match
+            ) const;
+
+            /**
+             * Method you can use to locate the handler for a path.
+             *
+             * \param[in] method The request method.
+             *
+             * \param[in] path   The path to get the handler for.
+             *
+             * \return Returns a pointer to the handler.  A null pointer is returned if no pattern matches.
+             */
+            Handler* handler(Handler::Method method, const QString& path) const;
+
+        private:
+            /**
+             * The number of supported methods.
+             */
+            static constexpr unsigned numberMethods = static_cast<unsigned>(Handler::Method::NUMBER_METHODS);
+
+            struct Node;
+
+            /**
+             * Type used to tie a literal segment to the node that follows it.
+             */
+            struct Child {
+                /**
+                 * The literal segment.
+                 */
+                QByteArray segment;
+
+                /**
+                 * The node reached through the segment.
+                 */
+                Node* node;
+            };
+
+            /**
+             * Type used to represent a single node in the trie.
+             */
+            struct Node {
+                Node();
+
+                Node(const Node& other);
+
+                ~Node();
+
+                /**
+                 * The literal children, sorted by segment so they can be binary searched.
+                 */
+                QVector<Child> children;
+
+                /**
+                 * The child reached through a parameter segment.  A null pointer indicates no parameter child.
+                 */
+                Node* parameterChild;
+
+                /**
+                 * The name of the parameter that leads to this node.  Only used by parameter children.
+                 */
+                QByteArray parameterName;
+
+                /**
+                 * The handlers for a path ending at this node, indexed by method.
+                 */
+                Handler* handlers[numberMethods];
+
+                /**
+                 * The handlers for a wildcard following this node, indexed by method.
+                 */
+                Handler* wildcardHandlers[numberMethods];
+            };
+
+            /**
+             * Method that compares a segment against a span of bytes.
+             *
+             * \param[in] segment The segment to compare.
+             *
+             * \param[in] data    The bytes to compare against.
+             *
+             * \param[in] length  The number of bytes to compare against.
+             *
+             * \return Returns a negative value, zero, or a positive value if the segment sorts before, equal to, or
+             *         after the bytes.
+             */
+            static int compareSegment(const QByteArray& segment, const char* data, unsigned long length);
+
+            /**
+             * Method that locates the position of a literal child.
+             *
+             * \param[in]  node   The node to search.
+             *
+             * \param[in]  data   The segment to locate.
+             *
+             * \param[in]  length The length of the segment, in bytes.
+             *
+             * \param[out] found  Holds true if the segment was found.
+             *
+             * \return Returns the index of the child, or the index where the child should be inserted.
+             */
+            static int findChild(const Node* node, const char* data, unsigned long length, bool& found);
+
+            /**
+             * Method that walks the trie from a node, backtracking from literals to parameters to wildcards.
+             *
+             * \param[in]     node   The node to start from.
+             *
+             * \param[in]     method The request method index.
+             *
+             * \param[in]     path   The path being matched.
+             *
+             * \param[in]     offset The offset to the first unmatched byte of the path.
+             *
+             * \param[in]     end    The offset just past the last byte of the path.
+             *
+             * \param[in,out] match  The captured parameters.  Entries added by failed branches are removed.
+             *
+             * \return Returns a pointer to the handler.  A null pointer is returned if no pattern matches.
+             */
+            static Handler* matchNode(
+                const Node*   node,
+                unsigned      method,
+                const char*   path,
+                unsigned long offset,
+                unsigned long end,
+                Match&        match
+            );
+
+            Router& operator=(const Router& other) = delete;
+
+            /**
+             * The name reported for wildcard values.
+             */
+            static const QByteArray wildcardName;
+
+            /**
+             * The root of the trie.
+             */
+            Node* root;
+    };
+};
+
+#endif
@@ -23,6 +23,7 @@
 #include <QtGlobal>
 #include <QCoreApplication>
 #include <QObject>
+#include <QThread>
 #include <QHostAddress>
 #include <QString>
 #include <QHash>
@@ -33,6 +34,8 @@
 #include <QJsonObject>
 #include <QJsonParseError>
 
+#include <algorithm>
+
 #include "rest_api_in_v1_handler.h"
 #include "rest_api_in_v1_server.h"
 #include "rest_api_in_v1_server_private.h"
@@ -40,7 +43,20 @@
 namespace RestApiInV1 {
     const QHostAddress   Server::defaultHostAddress                    = QHostAddress::Any;
     const unsigned short Server::defaultPort                           = 8080;
-    const unsigned       Server::defaultMaximumSimultaneousConnections = 4;
+    const unsigned       Server::defaultMaximumSimultaneousConnections = static_cast<unsigned>(
+        std::max(4, QThread::idealThreadCount())
+    );
+    const unsigned       Server::defaultNumberIoThreads                = 0;
+    const unsigned       Server::defaultNumberListenerThreads          = 0;
+    const unsigned       Server::defaultKeepAliveTimeout               = 5000;
+    const unsigned       Server::defaultMaximumRequestsPerConnection   = 100;
+    const unsigned       Server::defaultRequestHeadTimeout             = 10000;
+    const unsigned       Server::defaultRequestBodyTimeout             = 30000;
+    const unsigned       Server::defaultRequestTimeout                 = 60000;
+    const unsigned       Server::defaultMaximumOutboundBufferSize      = 262144;
+    const unsigned       Server::defaultResponseCompressionThreshold   = 1024;
+    const unsigned       Server::defaultCompressionCacheSize           = 32;
+    const unsigned       Server::defaultMaximumDecodedBodySize         = 67108864;
 
     Server::Server(QObject* parent):QObject(parent) {
         impl = new Private(defaultMaximumSimultaneousConnections);
@@ -79,6 +95,126 @@ namespace RestApiInV1 {
     }
 
 
+    void Server::setNumberIoThreads(unsigned newNumberIoThreads) {
+        impl->setNumberIoThreads(newNumberIoThreads);
+    }
+
+
+    unsigned Server::numberIoThreads() const {
+        return impl->numberIoThreads();
+    }
+
+
+    void Server::setNumberListenerThreads(unsigned newNumberListenerThreads) {
+        impl->setNumberListenerThreads(newNumberListenerThreads);
+    }
+
+
+    unsigned Server::numberListenerThreads() const {
+        return impl->numberListenerThreads();
+    }
+
+
+    void Server::setIncomingCpuAffinityEnabled(bool nowEnabled) {
+        impl->setIncomingCpuAffinityEnabled(nowEnabled);
+    }
+
+
+    bool Server::incomingCpuAffinityEnabled() const {
+        return impl->incomingCpuAffinityEnabled();
+    }
+
+
+    void Server::setKeepAliveTimeout(unsigned newKeepAliveTimeout) {
+        impl->setKeepAliveTimeout(newKeepAliveTimeout);
+    }
+
+
+    unsigned Server::keepAliveTimeout() const {
+        return impl->keepAliveTimeout();
+    }
+
+
+    void Server::setMaximumRequestsPerConnection(unsigned newMaximumRequestsPerConnection) {
+        impl->setMaximumRequestsPerConnection(newMaximumRequestsPerConnection);
+    }
+
+
+    unsigned Server::maximumRequestsPerConnection() const {
+        return impl->maximumRequestsPerConnection();
+    }
+
+
+    void Server::setRequestHeadTimeout(unsigned newRequestHeadTimeout) {
+        impl->setRequestHeadTimeout(newRequestHeadTimeout);
+    }
+
+
+    unsigned Server::requestHeadTimeout() const {
+        return impl->requestHeadTimeout();
+    }
+
+
+    void Server::setRequestBodyTimeout(unsigned newRequestBodyTimeout) {
+        impl->setRequestBodyTimeout(newRequestBodyTimeout);
+    }
+
+
+    unsigned Server::requestBodyTimeout() const {
+        return impl->requestBodyTimeout();
+    }
+
+
+    void Server::setRequestTimeout(unsigned newRequestTimeout) {
+        impl->setRequestTimeout(newRequestTimeout);
+    }
+
+
+    unsigned Server::requestTimeout() const {
+        return impl->requestTimeout();
+    }
+
+
+    void Server::setMaximumOutboundBufferSize(unsigned newMaximumOutboundBufferSize) {
+        impl->setMaximumOutboundBufferSize(newMaximumOutboundBufferSize);
+    }
+
+
+    unsigned Server::maximumOutboundBufferSize() const {
+        return impl->maximumOutboundBufferSize();
+    }
+
+
+    void Server::setResponseCompressionThreshold(unsigned newResponseCompressionThreshold) {
+        impl->setResponseCompressionThreshold(newResponseCompressionThreshold);
+    }
+
+
+    unsigned Server::responseCompressionThreshold() const {
+        return impl->responseCompressionThreshold();
+    }
+
+
+    void Server::setCompressionCacheSize(unsigned newCompressionCacheSize) {
+        impl->setCompressionCacheSize(newCompressionCacheSize);
+    }
+
+
+    unsigned Server::compressionCacheSize() const {
+        return impl->compressionCacheSize();
+    }
+
+
+    void Server::setMaximumDecodedBodySize(unsigned newMaximumDecodedBodySize) {
+        impl->setMaximumDecodedBodySize(newMaximumDecodedBodySize);
+    }
+
+
+    unsigned Server::maximumDecodedBodySize() const {
+        return impl->maximumDecodedBodySize();
+    }
+
+
     bool Server::reconfigure(const QHostAddress& hostAddress, unsigned short port) {
         return impl->reconfigure(hostAddress, port);
     }
@@ -89,6 +225,16 @@ namespace RestApiInV1 {
     }
 
 
+    void Server::unregisterHandler(Handler::Method method, const QString& path) {
+        impl->unregisterHandler(method, path);
+    }
+
+
+    void Server::synchronizeHandlers() {
+        impl->synchronizeHandlers();
+    }
+
+
     Handler* Server::handler(Handler::Method method, const QString& path) const {
         return impl->handler(method, path);
     }
@@ -22,38 +22,85 @@
 
 #include <QString>
 #include <QTcpServer>
-#include <QQueue>
-#include <QSemaphore>
 #include <QMutex>
 #include <QMutexLocker>
-#include <QQueue>
 
+#include <algorithm>
 #include <iostream>
 
 #include "rest_api_in_v1_connection.h"
+#include "rest_api_in_v1_connection_pool.h"
+#include "rest_api_in_v1_event_engine.h"
+#include "rest_api_in_v1_listener_thread.h"
 #include "rest_api_in_v1_server.h"
 #include "rest_api_in_v1_server_private.h"
 
 namespace RestApiInV1 {
     QMutex Server::Private::loggingMutex;
 
-    Server::Private::Private(unsigned maximumNumberSimultanousConnections, QObject* parent):QTcpServer(parent) {
-        for (unsigned i=0 ; i<static_cast<unsigned>(Handler::Method::NUMBER_METHODS) ; ++i) {
-            currentHandlersByPathByMethod.append(QHash<QString, Handler*>());
-        }
+    Server::Private::Private(
+            unsigned maximumNumberSimultanousConnections,
+            QObject* parent
+        ):QTcpServer(
+            parent
+        ),currentMaximumSimultaneousConnections(
+            maximumNumberSimultanousConnections
+        ),currentNumberIoThreads(
+            Server::defaultNumberIoThreads
+        ),currentNumberListenerThreads(
+            Server::defaultNumberListenerThreads
+        ),currentIncomingCpuAffinityEnabled(
+            false
+        ),currentPort(
+            0
+        ),currentKeepAliveTimeout(
+            Server::defaultKeepAliveTimeout
+        ),currentMaximumRequestsPerConnection(
+            Server::defaultMaximumRequestsPerConnection
+        ),currentRequestHeadTimeout(
+            Server::defaultRequestHeadTimeout
+        ),currentRequestBodyTimeout(
+            Server::defaultRequestBodyTimeout
+        ),currentRequestTimeout(
+            Server::defaultRequestTimeout
+        ),currentMaximumOutboundBufferSize(
+            Server::defaultMaximumOutboundBufferSize
+        ),currentResponseCompressionThreshold(
+            Server::defaultResponseCompressionThreshold
+        ),currentMaximumDecodedBodySize(
+            Server::defaultMaximumDecodedBodySize
+        ),currentCompressionCache(
+            Server::defaultCompressionCacheSize
+        ) {
+        currentLoggingFunction = &Server::Private::logWrite;
 
-        currentMaximumAllowedConnections = 0;
-        setMaximumSimultaneousConnections(maximumNumberSimultanousConnections);
+        connectionPool = new ConnectionPool(this, maximumBufferSize);
+        connectionPool->setLoggingFunction(currentLoggingFunction);
+        connectionPool->resize(maximumNumberSimultanousConnections);
 
-        currentLoggingFunction = &Server::Private::logWrite;
+        eventEngine = new EventEngine(connectionPool, this, maximumBufferSize);
+        eventEngine->resize(currentNumberIoThreads);
     }
 
 
-    Server::Private::~Private() {}
+    Server::Private::~Private() {
+        close();
+        stopListeners();
+
+        // Deleting the engine stops the I/O threads and waits for the workers to release them before the pool
+        // goes away.
+        delete eventEngine;
+        delete connectionPool;
+    }
 
 
     void Server::Private::setLoggingFunction(Server::LoggingFunction newLoggingFunction) {
         currentLoggingFunction = newLoggingFunction;
+        connectionPool->setLoggingFunction(newLoggingFunction);
+
+        for (unsigned i=0 ; i<static_cast<unsigned>(listeners.size()) ; ++i) {
+            listeners.at(i)->setLoggingFunction(newLoggingFunction);
+        }
     }
 
 
@@ -63,41 +110,157 @@ namespace RestApiInV1 {
 
 
     void Server::Private::setMaximumSimultaneousConnections(unsigned newMaximumNumberConnections) {
-        if (newMaximumNumberConnections > currentMaximumAllowedConnections) {
-            unsigned numberAdditionalConnections = newMaximumNumberConnections - currentMaximumAllowedConnections;
-
-            threadIdQueueMutex.lock();
-            for (  unsigned threadId = currentMaximumAllowedConnections
-                 ; threadId < newMaximumNumberConnections
-                 ; ++threadId
-                ) {
-                threadIdQueue.enqueue(threadId);
-            }
-            threadIdQueueMutex.unlock();
+        currentMaximumSimultaneousConnections = newMaximumNumberConnections;
 
-            availableConnectionSemaphore.release(numberAdditionalConnections);
-
-            currentMaximumAllowedConnections = newMaximumNumberConnections;
-        } else if (newMaximumNumberConnections < currentMaximumAllowedConnections) {
+        if (!listeners.isEmpty()) {
+            // Shards own contiguous thread ID ranges so we rebuild them rather than resizing in place.
+            stopListeners();
+            startListeners();
+        } else if (newMaximumNumberConnections < connectionPool->size()) {
             pauseAccepting();
+            connectionPool->resize(newMaximumNumberConnections);
+            resumeAccepting();
+        } else {
+            connectionPool->resize(newMaximumNumberConnections);
+        }
+    }
+
+
+    unsigned Server::Private::maximumSimultaneousConnections() const {
+        return currentMaximumSimultaneousConnections;
+    }
 
-            while (currentMaximumAllowedConnections > newMaximumNumberConnections) {
-                availableConnectionSemaphore.acquire();
 
-                threadIdQueueMutex.lock();
-                threadIdQueue.dequeue();
-                threadIdQueueMutex.unlock();
+    void Server::Private::setNumberIoThreads(unsigned newNumberIoThreads) {
+        if (EventEngine::isSupported()) {
+            currentNumberIoThreads = newNumberIoThreads;
 
-                --currentMaximumAllowedConnections;
+            if (!listeners.isEmpty()) {
+                stopListeners();
+                startListeners();
+            } else {
+                pauseAccepting();
+                eventEngine->resize(newNumberIoThreads);
+                resumeAccepting();
             }
+        }
+    }
 
-            resumeAccepting();
+
+    unsigned Server::Private::numberIoThreads() const {
+        return currentNumberIoThreads;
+    }
+
+
+    void Server::Private::setNumberListenerThreads(unsigned newNumberListenerThreads) {
+        if (ListenerThread::isSupported()) {
+            currentNumberListenerThreads = newNumberListenerThreads;
         }
     }
 
 
-    unsigned Server::Private::maximumSimultaneousConnections() const {
-        return currentMaximumAllowedConnections;
+    unsigned Server::Private::numberListenerThreads() const {
+        return currentNumberListenerThreads;
+    }
+
+
+    void Server::Private::setIncomingCpuAffinityEnabled(bool nowEnabled) {
+        currentIncomingCpuAffinityEnabled = nowEnabled;
+    }
+
+
+    bool Server::Private::incomingCpuAffinityEnabled() const {
+        return currentIncomingCpuAffinityEnabled;
+    }
+
+
+    void Server::Private::setKeepAliveTimeout(unsigned newKeepAliveTimeout) {
+        currentKeepAliveTimeout.store(newKeepAliveTimeout, std::memory_order_relaxed);
+    }
+
+
+    unsigned Server::Private::keepAliveTimeout() const {
+        return currentKeepAliveTimeout.load(std::memory_order_relaxed);
+    }
+
+
+    void Server::Private::setMaximumRequestsPerConnection(unsigned newMaximumRequestsPerConnection) {
+        currentMaximumRequestsPerConnection.store(newMaximumRequestsPerConnection, std::memory_order_relaxed);
+    }
+
+
+    unsigned Server::Private::maximumRequestsPerConnection() const {
+        return currentMaximumRequestsPerConnection.load(std::memory_order_relaxed);
+    }
+
+
+    void Server::Private::setRequestHeadTimeout(unsigned newRequestHeadTimeout) {
+        currentRequestHeadTimeout.store(newRequestHeadTimeout, std::memory_order_relaxed);
+    }
+
+
+    unsigned Server::Private::requestHeadTimeout() const {
+        return currentRequestHeadTimeout.load(std::memory_order_relaxed);
+    }
+
+
+    void Server::Private::setRequestBodyTimeout(unsigned newRequestBodyTimeout) {
+        currentRequestBodyTimeout.store(newRequestBodyTimeout, std::memory_order_relaxed);
+    }
+
+
+    unsigned Server::Private::requestBodyTimeout() const {
+        return currentRequestBodyTimeout.load(std::memory_order_relaxed);
+    }
+
+
+    void Server::Private::setRequestTimeout(unsigned newRequestTimeout) {
+        currentRequestTimeout.store(newRequestTimeout, std::memory_order_relaxed);
+    }
+
+
+    unsigned Server::Private::requestTimeout() const {
+        return currentRequestTimeout.load(std::memory_order_relaxed);
+    }
+
+
+    void Server::Private::setMaximumOutboundBufferSize(unsigned newMaximumOutboundBufferSize) {
+        currentMaximumOutboundBufferSize.store(newMaximumOutboundBufferSize, std::memory_order_relaxed);
+    }
+
+
+    unsigned Server::Private::maximumOutboundBufferSize() const {
+        return currentMaximumOutboundBufferSize.load(std::memory_order_relaxed);
+    }
+
+
+    void Server::Private::setResponseCompressionThreshold(unsigned newResponseCompressionThreshold) {
+        currentResponseCompressionThreshold.store(newResponseCompressionThreshold, std::memory_order_relaxed);
+    }
+
+
+    unsigned Server::Private::responseCompressionThreshold() const {
+        return currentResponseCompressionThreshold.load(std::memory_order_relaxed);
+    }
+
+
+    void Server::Private::setCompressionCacheSize(unsigned newCompressionCacheSize) {
+        currentCompressionCache.setCapacity(newCompressionCacheSize);
+    }
+
+
+    unsigned Server::Private::compressionCacheSize() const {
+        return currentCompressionCache.capacity();
+    }
+
+
+    void Server::Private::setMaximumDecodedBodySize(unsigned newMaximumDecodedBodySize) {
+        currentMaximumDecodedBodySize.store(newMaximumDecodedBodySize, std::memory_order_relaxed);
+    }
+
+
+    unsigned Server::Private::maximumDecodedBodySize() const {
+        return currentMaximumDecodedBodySize.load(std::memory_order_relaxed);
     }
 
 
@@ -106,56 +269,133 @@ namespace RestApiInV1 {
             close();
         }
 
-        return listen(hostAddress, port);
+        stopListeners();
+
+        bool success;
+        if (currentNumberListenerThreads > 0) {
+            // Each shard brings its own workers and I/O threads so the shared ones are released.
+            eventEngine->resize(0);
+            connectionPool->resize(0);
+
+            currentHostAddress = hostAddress;
+            currentPort        = port;
+
+            success = startListeners();
+        } else {
+            connectionPool->resize(currentMaximumSimultaneousConnections);
+            eventEngine->resize(currentNumberIoThreads);
+
+            success = listen(hostAddress, port);
+        }
+
+        return success;
     }
 
 
     void Server::Private::incomingConnection(qintptr socketDescriptor) {
-        availableConnectionSemaphore.acquire();
-
-        threadIdQueueMutex.lock();
-        unsigned nextThreadId = threadIdQueue.dequeue();
-        threadIdQueueMutex.unlock();
-
-        Connection* connection = new Connection(
-            this,
-            socketDescriptor,
-            nextThreadId,
-            maximumBufferSize,
-            currentLoggingFunction,
-            this
-        );
-
-        connect(connection, &Connection::finished, this, &Server::Private::sessionFinished);
-        connection->start();
+        if (eventEngine->size() > 0) {
+            eventEngine->addSocket(socketDescriptor);
+        } else {
+            connectionPool->startSession(socketDescriptor);
+        }
     }
 
 
-    void Server::Private::sessionFinished() {
-        Connection* finishedConnection = dynamic_cast<Connection*>(sender());
-        unsigned    threadId           = finishedConnection->threadId();
+    void Server::Private::registerHandler(Handler* handler, Handler::Method method, const QString& path) {
+        if (!currentRouteTable.insert(method, path, handler)) {
+            sessionError(QString("Invalid handler path: %1").arg(path));
+        }
+    }
 
-        threadIdQueueMutex.lock();
-        threadIdQueue.enqueue(threadId);
-        threadIdQueueMutex.unlock();
 
-        availableConnectionSemaphore.release();
+    void Server::Private::unregisterHandler(Handler::Method method, const QString& path) {
+        if (!currentRouteTable.insert(method, path, nullptr)) {
+            sessionError(QString("Invalid handler path: %1").arg(path));
+        }
+    }
 
-        finishedConnection->deleteLater();
+
+    void Server::Private::synchronizeHandlers() {
+        currentRouteTable.synchronize();
     }
 
 
-    QString Server::Private::cleanPath(const QString& path) {
-        QString cleanedPath = path;
-        if (path.endsWith('/')) {
-            cleanedPath = cleanedPath.left(cleanedPath.length() - 1);
+    bool Server::Private::startListeners() {
+        // Every shard needs at least one worker.  Capping the shards keeps thread IDs below the connection limit.
+        unsigned numberShards      = std::min(
+            currentNumberListenerThreads,
+            std::max(currentMaximumSimultaneousConnections, 1U)
+        );
+        unsigned workersPerShard   = currentMaximumSimultaneousConnections / numberShards;
+        unsigned extraWorkers      = currentMaximumSimultaneousConnections % numberShards;
+        unsigned ioThreadsPerShard = currentNumberIoThreads / numberShards;
+        unsigned extraIoThreads    = currentNumberIoThreads % numberShards;
+        unsigned firstThreadId     = 0;
+        unsigned shardIndex        = 0;
+        bool     success           = true;
+
+        while (success && shardIndex < numberShards) {
+            unsigned numberWorkers = workersPerShard;
+            if (shardIndex < extraWorkers) {
+                ++numberWorkers;
+            }
+
+            if (numberWorkers == 0) {
+                // Only reached with a connection limit of 0.
+                numberWorkers = 1;
+            }
+
+            unsigned numberIoThreads = ioThreadsPerShard;
+            if (shardIndex < extraIoThreads) {
+                ++numberIoThreads;
+            }
+
+            if (numberIoThreads == 0 && currentNumberIoThreads > 0) {
+                numberIoThreads = 1;
+            }
+
+            ListenerThread* listener = new ListenerThread(
+                this,
+                shardIndex,
+                numberWorkers,
+                firstThreadId,
+                numberIoThreads,
+                maximumBufferSize,
+                currentLoggingFunction
+            );
+
+            success = listener->listen(currentHostAddress, currentPort, currentIncomingCpuAffinityEnabled);
+            if (success) {
+                listeners.append(listener);
+                listener->start();
+            } else {
+                sessionError(QString("Could not start listener thread: %1").arg(listener->errorString()));
+                delete listener;
+            }
+
+            firstThreadId += numberWorkers;
+            ++shardIndex;
         }
 
-        if (!path.startsWith('/')) {
-            cleanedPath = QString("/") + cleanedPath;
+        if (!success) {
+            stopListeners();
         }
 
-        return cleanedPath;
+        return success;
+    }
+
+
+    void Server::Private::stopListeners() {
+        for (unsigned i=0 ; i<static_cast<unsigned>(listeners.size()) ; ++i) {
+            listeners.at(i)->stop();
+        }
+
+        while (!listeners.isEmpty()) {
+            ListenerThread* listener = listeners.takeLast();
+            listener->wait();
+
+            delete listener;
+        }
     }
 
 
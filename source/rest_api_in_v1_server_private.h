@@ -30,16 +30,22 @@
 #include <QByteArray>
 #include <QHostAddress>
 #include <QList>
-#include <QQueue>
-#include <QSemaphore>
 #include <QMutex>
 
+#include <atomic>
+
 #include "rest_api_in_v1_common.h"
 #include "rest_api_in_v1_server.h"
+#include "rest_api_in_v1_router.h"
+#include "rest_api_in_v1_route_table.h"
+#include "rest_api_in_v1_compression_cache.h"
 
 namespace RestApiInV1 {
     class REST_API_V1_PUBLIC_API Handler;
     class REST_API_V1_PUBLIC_API Connection;
+    class REST_API_V1_PUBLIC_API ConnectionPool;
+    class REST_API_V1_PUBLIC_API EventEngine;
+    class REST_API_V1_PUBLIC_API ListenerThread;
 
     /**
      * Private class used to accept and process incoming TCP connections.
@@ -87,6 +93,211 @@ namespace RestApiInV1 {
              */
             unsigned maximumSimultaneousConnections() const;
 
+            /**
+             * Method you can use to set the number of I/O threads.  The value is ignored on platforms that do not
+             * support the I/O threads.
+             *
+             * \param[in] newNumberIoThreads The new number of I/O threads.  A value of 0 disables the I/O threads.
+             */
+            void setNumberIoThreads(unsigned newNumberIoThreads);
+
+            /**
+             * Method you can use to determine the current number of I/O threads.
+             *
+             * \return Returns the current number of I/O threads.
+             */
+            unsigned numberIoThreads() const;
+
+            /**
+             * Method you can use to set the number of listener threads.  The new value takes effect on the next call
+             * to \ref reconfigure.
+             *
+             * \param[in] newNumberListenerThreads The new number of listener threads.  A value of 0 disables the
+             *                                     listener threads.
+             */
+            void setNumberListenerThreads(unsigned newNumberListenerThreads);
+
+            /**
+             * Method you can use to determine the number of listener threads.
+             *
+             * \return Returns the number of listener threads.
+             */
+            unsigned numberListenerThreads() const;
+
+            /**
+             * Method you can use to ask each listener thread to favor connections arriving on its own CPU.  The new
+             * value takes effect on the next call to \ref reconfigure.
+             *
+             * \param[in] nowEnabled If true, CPU affinity will be used.  If false, CPU affinity will not be used.
+             */
+            void setIncomingCpuAffinityEnabled(bool nowEnabled);
+
+            /**
+             * Method you can use to determine if listener threads favor connections arriving on their own CPU.
+             *
+             * \return Returns true if CPU affinity is enabled.  Returns false if CPU affinity is disabled.
+             */
+            bool incomingCpuAffinityEnabled() const;
+
+            /**
+             * Method you can use to set how long an idle persistent connection is held open.  This method can be
+             * called at any time.  The new value applies to the next idle period of each connection.
+             *
+             * \param[in] newKeepAliveTimeout The new keep-alive timeout, in milliseconds.  A value of 0 disables
+             *                                persistent connections.
+             */
+            void setKeepAliveTimeout(unsigned newKeepAliveTimeout);
+
+            /**
+             * Method you can use to determine how long an idle persistent connection is held open.  This method is
+             * safe to call from any thread.
+             *
+             * \return Returns the keep-alive timeout, in milliseconds.
+             */
+            unsigned keepAliveTimeout() const;
+
+            /**
+             * Method you can use to set the maximum number of requests serviced on a single persistent connection.
+             *
+             * \param[in] newMaximumRequestsPerConnection The new maximum number of requests.  A value of 0 indicates
+             *                                            no limit.
+             */
+            void setMaximumRequestsPerConnection(unsigned newMaximumRequestsPerConnection);
+
+            /**
+             * Method you can use to determine the maximum number of requests serviced on a single persistent
+             * connection.  This method is safe to call from any thread.
+             *
+             * \return Returns the maximum number of requests.  A value of 0 indicates no limit.
+             */
+            unsigned maximumRequestsPerConnection() const;
+
+            /**
+             * Method you can use to set how long a client is given to send a complete request head.  Clients that
+             * have sent part of a head when the time runs out receive a request timeout response.  Clients that have
+             * sent nothing are disconnected.
+             *
+             * \param[in] newRequestHeadTimeout The new request head timeout, in milliseconds.  A value of 0 indicates
+             *                                  no limit.
+             */
+            void setRequestHeadTimeout(unsigned newRequestHeadTimeout);
+
+            /**
+             * Method you can use to determine how long a client is given to send a complete request head.  This
+             * method is safe to call from any thread.
+             *
+             * \return Returns the request head timeout, in milliseconds.  A value of 0 indicates no limit.
+             */
+            unsigned requestHeadTimeout() const;
+
+            /**
+             * Method you can use to set how long a client is given to send a request body, measured from the end of
+             * the request head.  If no response has been sent when the time runs out, the client receives a request
+             * timeout response.  The connection is then closed.
+             *
+             * \param[in] newRequestBodyTimeout The new request body timeout, in milliseconds.  A value of 0 indicates
+             *                                  no limit.
+             */
+            void setRequestBodyTimeout(unsigned newRequestBodyTimeout);
+
+            /**
+             * Method you can use to determine how long a client is given to send a request body.  This method is
+             * safe to call from any thread.
+             *
+             * \return Returns the request body timeout, in milliseconds.  A value of 0 indicates no limit.
+             */
+            unsigned requestBodyTimeout() const;
+
+            /**
+             * Method you can use to set the total time allowed to receive a request and deliver its response.  The
+             * limit bounds every wait on the client, including waits for the client to accept response data.  If no
+             * response has been sent when the time runs out, the client receives a request timeout response.
+             * Otherwise the connection is dropped.  Time spent inside a handler that is not waiting on the client is
+             * counted but can not be interrupted.
+             *
+             * \param[in] newRequestTimeout The new request timeout, in milliseconds.  A value of 0 indicates no
+             *                              limit.
+             */
+            void setRequestTimeout(unsigned newRequestTimeout);
+
+            /**
+             * Method you can use to determine the total time allowed to receive a request and deliver its response.
+             * This method is safe to call from any thread.
+             *
+             * \return Returns the request timeout, in milliseconds.  A value of 0 indicates no limit.
+             */
+            unsigned requestTimeout() const;
+
+            /**
+             * Method you can use to set the most response data buffered for a single connection.
+             *
+             * \param[in] newMaximumOutboundBufferSize The new limit, in bytes.  A value of 0 indicates no limit.
+             */
+            void setMaximumOutboundBufferSize(unsigned newMaximumOutboundBufferSize);
+
+            /**
+             * Method you can use to determine the most response data buffered for a single connection.  This method
+             * is safe to call from any thread.
+             *
+             * \return Returns the limit, in bytes.  A value of 0 indicates no limit.
+             */
+            unsigned maximumOutboundBufferSize() const;
+
+            /**
+             * Method you can use to set the smallest response body we compress.
+             *
+             * \param[in] newResponseCompressionThreshold The new threshold, in bytes.
+             */
+            void setResponseCompressionThreshold(unsigned newResponseCompressionThreshold);
+
+            /**
+             * Method you can use to determine the smallest response body we compress.  This method is safe to call
+             * from any thread.
+             *
+             * \return Returns the threshold, in bytes.
+             */
+            unsigned responseCompressionThreshold() const;
+
+            /**
+             * Method you can use to set the number of compressed response bodies kept for reuse.
+             *
+             * \param[in] newCompressionCacheSize The new number of cached bodies.  A value of 0 disables the cache.
+             */
+            void setCompressionCacheSize(unsigned newCompressionCacheSize);
+
+            /**
+             * Method you can use to determine the number of compressed response bodies kept for reuse.
+             *
+             * \return Returns the number of cached bodies.
+             */
+            unsigned compressionCacheSize() const;
+
+            /**
+             * Method you can use to set the largest request body we accept once a "Content-Encoding" is removed.
+             *
+             * \param[in] newMaximumDecodedBodySize The new limit, in bytes.  A value of 0 leaves only the handler's
+             *                                      limit.
+             */
+            void setMaximumDecodedBodySize(unsigned newMaximumDecodedBodySize);
+
+            /**
+             * Method you can use to determine the largest request body we accept once a "Content-Encoding" is
+             * removed.  This method is safe to call from any thread.
+             *
+             * \return Returns the limit, in bytes.  A value of 0 indicates only the handler's limit applies.
+             */
+            unsigned maximumDecodedBodySize() const;
+
+            /**
+             * Method you can use to obtain the cache of compressed response bodies.  The cache is safe to use from
+             * any thread.
+             *
+             * \return Returns a reference to the cache.
+             */
+            inline CompressionCache& compressionCache() {
+                return currentCompressionCache;
+            }
+
             /**
              * Method you can use to reconfigure this server instance.
              *
@@ -104,17 +315,34 @@ namespace RestApiInV1 {
 
             /**
              * Method you can use to register an handler with this server.  If a handler for the path already exists,
-             * it will be replaced.
+             * it will be replaced.  Malformed paths are reported through \ref sessionError and ignored.  This method
+             * is safe to call while requests are being serviced.
              *
              * \param[in] handler A pointer the REST API handler.  Not that this class will *not* take ownership.
              *
              * \param[in] method  The method required to trigger this handler.
              *
-             * \param[in] path    The path under the server that will trigger this handler.
+             * \param[in] path    The path pattern under the server that will trigger this handler.  See
+             *                    \ref Router for the supported syntax.
              */
-            inline void registerHandler(Handler* handler, Handler::Method method, const QString& path) {
-                currentHandlersByPathByMethod[static_cast<unsigned>(method)].insert(cleanPath(path), handler);
-            }
+            void registerHandler(Handler* handler, Handler::Method method, const QString& path);
+
+            /**
+             * Method you can use to remove a handler from this server.  This method is safe to call while requests
+             * are being serviced.  Requests already routed to the handler may still be running when this method
+             * returns.  Use \ref synchronizeHandlers to wait for them.
+             *
+             * \param[in] method The method that triggers the handler.
+             *
+             * \param[in] path   The path the handler was registered under.
+             */
+            void unregisterHandler(Handler::Method method, const QString& path);
+
+            /**
+             * Method you can use to wait until no request is using a handler that was removed or replaced before this
+             * call.  This method must not be called from a handler.
+             */
+            void synchronizeHandlers();
 
             /**
              * Method that gets the handler for a given path.
@@ -127,12 +355,67 @@ namespace RestApiInV1 {
              *         requested handler.
              */
             inline Handler* handler(Handler::Method method, const QString& path) const {
-                return currentHandlersByPathByMethod.at(
-                    static_cast<unsigned>(method)
-                ).value(
-                    cleanPath(path),
-                    nullptr
-                );
+                return currentRouteTable.handler(method, path);
+            }
+
+            /**
+             * Method that obtains a hazard slot used by a worker to route requests.
+             *
+             * \return Returns the new slot.
+             */
+            inline RouteTable::Reader* addRouteReader() {
+                return currentRouteTable.addReader();
+            }
+
+            /**
+             * Method that disposes of a worker's hazard slot.
+             *
+             * \param[in] reader The slot to be disposed of.
+             */
+            inline void removeRouteReader(RouteTable::Reader* reader) {
+                currentRouteTable.removeReader(reader);
+            }
+
+            /**
+             * Method that routes a request to its handler.  This method does not allocate memory or take a lock.  The
+             * routing table, and with it the parameter names in the match, remain valid until \ref releaseRoutes is
+             * called.
+             *
+             * \param[in]  reader     The worker's hazard slot.
+             *
+             * \param[in]  method     The request method.
+             *
+             * \param[in]  path       The decoded request path.
+             *
+             * \param[in]  pathLength The length of the request path, in bytes.
+             *
+             * \param[in]  host       The host named in an absolute request target.
+             *
+             * \param[in]  hostLength The length of the host, in bytes.  A value of 0 indicates no host.
+             *
+             * \param[out] match      Receives the path parameters.
+             *
+             * \return Returns a pointer to the handler.  A null pointer is returned if there is no matching handler.
+             */
+            inline Handler* route(
+                    RouteTable::Reader& reader,
+                    Handler::Method     method,
+                    const char*         path,
+                    unsigned long       pathLength,
+                    const char*         host,
+                    unsigned long       hostLength,
+                    Router::Match&      match
+                ) const {
+                return currentRouteTable.acquire(reader)->lookup(method, path, pathLength, host, hostLength, match);
+            }
+
+            /**
+             * Method that indicates a worker is done with the routing table obtained by \ref route.
+             *
+             * \param[in] reader The worker's hazard slot.
+             */
+            inline void releaseRoutes(RouteTable::Reader& reader) const {
+                currentRouteTable.release(reader);
             }
 
         signals:
@@ -143,12 +426,6 @@ namespace RestApiInV1 {
              */
             void sessionError(const QString& errorReason);
 
-        public slots:
-            /**
-             * Slot that is triggered when a session has finished.
-             */
-            void sessionFinished();
-
         protected:
             /**
              * Slot you can trigger when a new connection is available.
@@ -164,13 +441,18 @@ namespace RestApiInV1 {
             static constexpr unsigned long maximumBufferSize = 65536;
 
             /**
-             * Method that cleans a path.
+             * Method that creates and starts the listener threads, dividing the workers and I/O threads evenly
+             * between them.
              *
-             * \param[in] path The path to be cleaned.
-             *
-             * \return Returns the path with a forced leading slash and ending slashes removed.
+             * \return Returns true on success.  Returns false if any listener could not be started.
+             */
+            bool startListeners();
+
+            /**
+             * Method that stops and destroys the listener threads.  Blocks until every shard's workers have finished
+             * their current sessions.
              */
-            static QString cleanPath(const QString& path);
+            void stopListeners();
 
             /**
              * Function you can use to write a log entry.
@@ -182,29 +464,99 @@ namespace RestApiInV1 {
             static void logWrite(const QString& message, bool error = false);
 
             /**
-             * Queue used to keep track of available thread IDs.
+             * The pool of worker threads used to service connections.
+             */
+            ConnectionPool* connectionPool;
+
+            /**
+             * The I/O threads used to wait on request heads.  Unused when the engine has no threads.
+             */
+            EventEngine* eventEngine;
+
+            /**
+             * The listener threads used when the server is sharded.
+             */
+            QList<ListenerThread*> listeners;
+
+            /**
+             * The requested maximum number of simultaneous connections.
+             */
+            unsigned currentMaximumSimultaneousConnections;
+
+            /**
+             * The requested number of I/O threads.
+             */
+            unsigned currentNumberIoThreads;
+
+            /**
+             * The requested number of listener threads.
+             */
+            unsigned currentNumberListenerThreads;
+
+            /**
+             * Flag indicating if listener threads should favor connections arriving on their own CPU.
+             */
+            bool currentIncomingCpuAffinityEnabled;
+
+            /**
+             * The host address the listener threads are bound to.
+             */
+            QHostAddress currentHostAddress;
+
+            /**
+             * The port the listener threads are bound to.
+             */
+            unsigned short currentPort;
+
+            /**
+             * The keep-alive timeout, in milliseconds.  Read by worker and I/O threads.
+             */
+            std::atomic<unsigned> currentKeepAliveTimeout;
+
+            /**
+             * The maximum number of requests per persistent connection.  Read by worker threads.
+             */
+            std::atomic<unsigned> currentMaximumRequestsPerConnection;
+
+            /**
+             * The request head timeout, in milliseconds.  Read by worker and I/O threads.
+             */
+            std::atomic<unsigned> currentRequestHeadTimeout;
+
+            /**
+             * The request body timeout, in milliseconds.  Read by worker threads.
+             */
+            std::atomic<unsigned> currentRequestBodyTimeout;
+
+            /**
+             * The total request timeout, in milliseconds.  Read by worker threads.
+             */
+            std::atomic<unsigned> currentRequestTimeout;
+
+            /**
+             * The per-connection outbound buffer limit, in bytes.  Read by worker threads.
              */
-            QQueue<unsigned> threadIdQueue;
+            std::atomic<unsigned> currentMaximumOutboundBufferSize;
 
             /**
-             * Mutex used to guarantee atomic access to the thread ID queue.
+             * The smallest response body we compress, in bytes.  Read by worker threads.
              */
-            QMutex threadIdQueueMutex;
+            std::atomic<unsigned> currentResponseCompressionThreshold;
 
             /**
-             * A list of underlying handlers.
+             * The largest decoded request body, in bytes.  Read by worker threads.
              */
-            QList<QHash<QString, Handler*>> currentHandlersByPathByMethod;
+            std::atomic<unsigned> currentMaximumDecodedBodySize;
 
             /**
-             * Semaphore used to track the available connections.
+             * The cache of compressed response bodies.
              */
-            QSemaphore availableConnectionSemaphore;
+            CompressionCache currentCompressionCache;
 
             /**
-             * The current count of allowed connections.
+             * The routing table used to locate handlers.
              */
-            unsigned currentMaximumAllowedConnections;
+            RouteTable currentRouteTable;
 
             /**
              * The current logging function.
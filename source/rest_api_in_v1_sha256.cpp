@@ -0,0 +1,521 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::Sha256 class.
+***********************************************************************************************************************/
+
+#include <QByteArray>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__x86_64__) && defined(__GNUC__))
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#include "rest_api_in_v1_sha256.h"
+
+namespace RestApiInV1 {
+    static const std::uint32_t roundConstants[64] = {
+        0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+        0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+        0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+        0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+        0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+        0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+        0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+        0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+    };
+
+    constexpr unsigned Sha256::blockLength;
+    constexpr unsigned Sha256::digestLength;
+    constexpr unsigned Sha256::maximumLanes;
+
+    const Sha256::State Sha256::initialState = {
+        { 0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19 }
+    };
+
+    static inline std::uint32_t rotateRight(std::uint32_t value, unsigned count) {
+        return (value >> count) | (value << (32 - count));
+    }
+
+
+    static inline std::uint32_t loadBigEndian(const unsigned char* data) {
+        return (
+              (static_cast<std::uint32_t>(data[0]) << 24)
+            | (static_cast<std::uint32_t>(data[1]) << 16)
+            | (static_cast<std::uint32_t>(data[2]) <<  8)
+            | (static_cast<std::uint32_t>(data[3])      )
+        );
+    }
+
+
+    Sha256::Sha256():currentState(initialState),currentLength(0),pendingLength(0) {}
+
+
+    Sha256::Sha256(
+            const State&       midstate,
+            unsigned long long bytesHashed
+        ):currentState(
+            midstate
+        ),currentLength(
+            bytesHashed
+        ),pendingLength(
+            0
+        ) {}
+
+
+    void Sha256::addData(const char* data, unsigned long length) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        currentLength += length;
+
+        if (pendingLength > 0) {
+            unsigned long count = std::min(static_cast<unsigned long>(blockLength - pendingLength), length);
+            std::memcpy(pendingData + pendingLength, bytes, count);
+
+            pendingLength += static_cast<unsigned>(count);
+            bytes         += count;
+            length        -= count;
+
+            if (pendingLength == blockLength) {
+                compress(currentState, pendingData, 1);
+                pendingLength = 0;
+            }
+        }
+
+        // Whole blocks are hashed in place.
+        unsigned long numberBlocks = length / blockLength;
+        if (numberBlocks > 0) {
+            compress(currentState, bytes, numberBlocks);
+
+            bytes  += numberBlocks * blockLength;
+            length -= numberBlocks * blockLength;
+        }
+
+        if (length > 0) {
+            std::memcpy(pendingData, bytes, length);
+            pendingLength = static_cast<unsigned>(length);
+        }
+    }
+
+
+    void Sha256::result(unsigned char* digest) {
+        unsigned long long bitLength = currentLength * 8;
+
+        // Padding is a single one bit, zeros, then the message length in bits.  The length needs the last 8 bytes of
+        // a block.
+        pendingData[pendingLength++] = 0x80;
+        if (pendingLength > blockLength - 8) {
+            std::memset(pendingData + pendingLength, 0, blockLength - pendingLength);
+            compress(currentState, pendingData, 1);
+            pendingLength = 0;
+        }
+
+        std::memset(pendingData + pendingLength, 0, blockLength - 8 - pendingLength);
+        storeBigEndian(static_cast<std::uint32_t>(bitLength >> 32), pendingData + blockLength - 8);
+        storeBigEndian(static_cast<std::uint32_t>(bitLength),       pendingData + blockLength - 4);
+        compress(currentState, pendingData, 1);
+        pendingLength = 0;
+
+        for (unsigned i=0 ; i<8 ; ++i) {
+            storeBigEndian(currentState.words[i], digest + 4 * i);
+        }
+    }
+
+
+    QByteArray Sha256::result() {
+        QByteArray digest(static_cast<int>(digestLength), 0);
+        result(reinterpret_cast<unsigned char*>(digest.data()));
+
+        return digest;
+    }
+
+
+    void Sha256::compress(State& state, const unsigned char* data, unsigned long numberBlocks) {
+        compressLanes(&state, 1, data, numberBlocks);
+    }
+
+
+    /**
+     * Method that expands one block into the message schedule with the round constants added.
+     *
+     * \param[in]  block    The block to be expanded.
+     *
+     * \param[out] schedule Receives the 64 schedule words.
+     */
+    static inline void expandBlock(const unsigned char* block, std::uint32_t* schedule) {
+        std::uint32_t words[64];
+
+        for (unsigned i=0 ; i<16 ; ++i) {
+            words[i] = loadBigEndian(block + 4 * i);
+        }
+
+        for (unsigned i=16 ; i<64 ; ++i) {
+            std::uint32_t s0 = rotateRight(words[i - 15], 7) ^ rotateRight(words[i - 15], 18) ^ (words[i - 15] >> 3);
+            std::uint32_t s1 = rotateRight(words[i - 2], 17) ^ rotateRight(words[i - 2], 19) ^ (words[i - 2] >> 10);
+
+            words[i] = words[i - 16] + s0 + words[i - 7] + s1;
+        }
+
+        for (unsigned i=0 ; i<64 ; ++i) {
+            schedule[i] = words[i] + roundConstants[i];
+        }
+    }
+
+
+    /**
+     * Portable lane compression.  The message schedule is shared by all lanes.
+     *
+     * \param[in,out] states       The lane states.
+     *
+     * \param[in]     numberLanes  The number of lanes.
+     *
+     * \param[in]     data         Pointer to the blocks to be hashed.
+     *
+     * \param[in]     numberBlocks The number of blocks to be hashed.
+     */
+    static void compressLanesPortable(
+            Sha256::State*       states,
+            unsigned             numberLanes,
+            const unsigned char* data,
+            unsigned long        numberBlocks
+        ) {
+        std::uint32_t schedule[64];
+
+        for (unsigned long block=0 ; block<numberBlocks ; ++block) {
+            expandBlock(data + block * Sha256::blockLength, schedule);
+
+            for (unsigned lane=0 ; lane<numberLanes ; ++lane) {
+                std::uint32_t* words = states[lane].words;
+
+                std::uint32_t a = words[0];
+                std::uint32_t b = words[1];
+                std::uint32_t c = words[2];
+                std::uint32_t d = words[3];
+                std::uint32_t e = words[4];
+                std::uint32_t f = words[5];
+                std::uint32_t g = words[6];
+                std::uint32_t h = words[7];
+
+                for (unsigned i=0 ; i<64 ; ++i) {
+                    std::uint32_t s1     = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+                    std::uint32_t choose = (e & f) ^ (~e & g);
+                    std::uint32_t t1     = h + s1 + choose + schedule[i];
+                    std::uint32_t s0     = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+                    std::uint32_t major  = (a & b) ^ (a & c) ^ (b & c);
+                    std::uint32_t t2     = s0 + major;
+
+                    h = g;
+                    g = f;
+                    f = e;
+                    e = d + t1;
+                    d = c;
+                    c = b;
+                    b = a;
+                    a = t1 + t2;
+                }
+
+                words[0] += a;
+                words[1] += b;
+                words[2] += c;
+                words[3] += d;
+                words[4] += e;
+                words[5] += f;
+                words[6] += g;
+                words[7] += h;
+            }
+        }
+    }
+
+#if (defined(__x86_64__) && defined(__GNUC__))
+
+    static inline __m128i rotateRightLanes(__m128i value, int count) {
+        return _mm_or_si128(_mm_srli_epi32(value, count), _mm_slli_epi32(value, 32 - count));
+    }
+
+
+    /**
+     * SSE2 lane compression.  Each lane occupies one 32-bit element of the vector registers.  SSE2 is part of the
+     * x86-64 baseline so no dispatch is needed.
+     *
+     * \param[in,out] states       The lane states.
+     *
+     * \param[in]     numberLanes  The number of lanes, up to \ref Sha256::maximumLanes.
+     *
+     * \param[in]     data         Pointer to the blocks to be hashed.
+     *
+     * \param[in]     numberBlocks The number of blocks to be hashed.
+     */
+    static void compressLanesSse2(
+            Sha256::State*       states,
+            unsigned             numberLanes,
+            const unsigned char* data,
+            unsigned long        numberBlocks
+        ) {
+        alignas(16) std::uint32_t transposed[8][Sha256::maximumLanes];
+        std::uint32_t             schedule[64];
+
+        // Unused lanes repeat lane 0 and are discarded.
+        for (unsigned i=0 ; i<8 ; ++i) {
+            for (unsigned lane=0 ; lane<Sha256::maximumLanes ; ++lane) {
+                transposed[i][lane] = states[lane < numberLanes ? lane : 0].words[i];
+            }
+        }
+
+        __m128i state[8];
+        for (unsigned i=0 ; i<8 ; ++i) {
+            state[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(transposed[i]));
+        }
+
+        for (unsigned long block=0 ; block<numberBlocks ; ++block) {
+            expandBlock(data + block * Sha256::blockLength, schedule);
+
+            __m128i a = state[0];
+            __m128i b = state[1];
+            __m128i c = state[2];
+            __m128i d = state[3];
+            __m128i e = state[4];
+            __m128i f = state[5];
+            __m128i g = state[6];
+            __m128i h = state[7];
+
+            for (unsigned i=0 ; i<64 ; ++i) {
+                __m128i s1     = _mm_xor_si128(
+                    _mm_xor_si128(rotateRightLanes(e, 6), rotateRightLanes(e, 11)),
+                    rotateRightLanes(e, 25)
+                );
+                __m128i choose = _mm_xor_si128(_mm_and_si128(e, f), _mm_andnot_si128(e, g));
+                __m128i t1     = _mm_add_epi32(
+                    _mm_add_epi32(h, s1),
+                    _mm_add_epi32(choose, _mm_set1_epi32(static_cast<int>(schedule[i])))
+                );
+                __m128i s0     = _mm_xor_si128(
+                    _mm_xor_si128(rotateRightLanes(a, 2), rotateRightLanes(a, 13)),
+                    rotateRightLanes(a, 22)
+                );
+                __m128i major  = _mm_xor_si128(_mm_and_si128(a, b), _mm_and_si128(c, _mm_xor_si128(a, b)));
+                __m128i t2     = _mm_add_epi32(s0, major);
+
+                h = g;
+                g = f;
+                f = e;
+                e = _mm_add_epi32(d, t1);
+                d = c;
+                c = b;
+                b = a;
+                a = _mm_add_epi32(t1, t2);
+            }
+
+            state[0] = _mm_add_epi32(state[0], a);
+            state[1] = _mm_add_epi32(state[1], b);
+            state[2] = _mm_add_epi32(state[2], c);
+            state[3] = _mm_add_epi32(state[3], d);
+            state[4] = _mm_add_epi32(state[4], e);
+            state[5] = _mm_add_epi32(state[5], f);
+            state[6] = _mm_add_epi32(state[6], g);
+            state[7] = _mm_add_epi32(state[7], h);
+        }
+
+        for (unsigned i=0 ; i<8 ; ++i) {
+            _mm_store_si128(reinterpret_cast<__m128i*>(transposed[i]), state[i]);
+        }
+
+        for (unsigned lane=0 ; lane<numberLanes ; ++lane) {
+            for (unsigned i=0 ; i<8 ; ++i) {
+                states[lane].words[i] = transposed[i][lane];
+            }
+        }
+    }
+
+
+    /**
+     * SHA extensions compression for a single state.
+     *
+     * \param[in,out] state        The state to be updated.
+     *
+     * \param[in]     data         Pointer to the blocks to be hashed.
+     *
+     * \param[in]     numberBlocks The number of blocks to be hashed.
+     */
+    __attribute__((target("sha,sse4.1")))
+    static void compressShaExtensions(Sha256::State& state, const unsigned char* data, unsigned long numberBlocks) {
+        const __m128i byteSwap = _mm_set_epi64x(0x0C0D0E0F08090A0BULL, 0x0405060700010203ULL);
+
+        // The instructions expect the state as ABEF and CDGH.
+        __m128i abcd   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.words));
+        __m128i efgh   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.words + 4));
+        __m128i cdab   = _mm_shuffle_epi32(abcd, 0xB1);
+        __m128i hgfe   = _mm_shuffle_epi32(efgh, 0x1B);
+        __m128i state0 = _mm_alignr_epi8(cdab, hgfe, 8);
+        __m128i state1 = _mm_blend_epi16(hgfe, cdab, 0xF0);
+
+        for (unsigned long block=0 ; block<numberBlocks ; ++block) {
+            const unsigned char* blockData = data + block * Sha256::blockLength;
+            __m128i              saved0    = state0;
+            __m128i              saved1    = state1;
+            __m128i              messages[4];
+
+            for (unsigned i=0 ; i<16 ; ++i) {
+                if (i < 4) {
+                    messages[i] = _mm_shuffle_epi8(
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(blockData + 16 * i)),
+                        byteSwap
+                    );
+                } else {
+                    __m128i message = _mm_sha256msg1_epu32(messages[i % 4], messages[(i + 1) % 4]);
+                    message = _mm_add_epi32(message, _mm_alignr_epi8(messages[(i + 3) % 4], messages[(i + 2) % 4], 4));
+                    messages[i % 4] = _mm_sha256msg2_epu32(message, messages[(i + 3) % 4]);
+                }
+
+                __m128i message = _mm_add_epi32(
+                    messages[i % 4],
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(roundConstants + 4 * i))
+                );
+
+                state1  = _mm_sha256rnds2_epu32(state1, state0, message);
+                message = _mm_shuffle_epi32(message, 0x0E);
+                state0  = _mm_sha256rnds2_epu32(state0, state1, message);
+            }
+
+            state0 = _mm_add_epi32(state0, saved0);
+            state1 = _mm_add_epi32(state1, saved1);
+        }
+
+        __m128i feba = _mm_shuffle_epi32(state0, 0x1B);
+        __m128i dchg = _mm_shuffle_epi32(state1, 0xB1);
+        abcd = _mm_blend_epi16(feba, dchg, 0xF0);
+        efgh = _mm_alignr_epi8(dchg, feba, 8);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(state.words), abcd);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(state.words + 4), efgh);
+    }
+
+
+    /**
+     * SHA extensions lane compression.  The instructions finish a block faster than any vector kernel so the lanes
+     * are processed one after another while each block is still in the L1 cache.
+     *
+     * \param[in,out] states       The lane states.
+     *
+     * \param[in]     numberLanes  The number of lanes.
+     *
+     * \param[in]     data         Pointer to the blocks to be hashed.
+     *
+     * \param[in]     numberBlocks The number of blocks to be hashed.
+     */
+    static void compressLanesShaExtensions(
+            Sha256::State*       states,
+            unsigned             numberLanes,
+            const unsigned char* data,
+            unsigned long        numberBlocks
+        ) {
+        for (unsigned long block=0 ; block<numberBlocks ; ++block) {
+            for (unsigned lane=0 ; lane<numberLanes ; ++lane) {
+                compressShaExtensions(states[lane], data + block * Sha256::blockLength, 1);
+            }
+        }
+    }
+
+
+    /**
+     * Method that checks for the SHA extensions along with the SSSE3 and SSE4.1 instructions the kernel uses.
+     *
+     * \return Returns true if the SHA extensions can be used.
+     */
+    static bool hasShaExtensions() {
+        unsigned eax;
+        unsigned ebx;
+        unsigned ecx;
+        unsigned edx;
+        bool     result = false;
+
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSSE3) != 0 && (ecx & bit_SSE4_1) != 0) {
+            result = __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_SHA) != 0;
+        }
+
+        return result;
+    }
+
+#endif
+
+    void Sha256::compressLanes(
+            State*               states,
+            unsigned             numberLanes,
+            const unsigned char* data,
+            unsigned long        numberBlocks
+        ) {
+        Kernel kernel;
+        if (kernelSupported(Kernel::SHA_EXTENSIONS)) {
+            kernel = Kernel::SHA_EXTENSIONS;
+        } else if (numberLanes > 1 && kernelSupported(Kernel::SSE2)) {
+            kernel = Kernel::SSE2;
+        } else {
+            kernel = Kernel::PORTABLE;
+        }
+
+        compressLanes(kernel, states, numberLanes, data, numberBlocks);
+    }
+
+
+    void Sha256::compressLanes(
+            Kernel               kernel,
+            State*               states,
+            unsigned             numberLanes,
+            const unsigned char* data,
+            unsigned long        numberBlocks
+        ) {
+#if (defined(__x86_64__) && defined(__GNUC__))
+        if (kernel == Kernel::SHA_EXTENSIONS) {
+            if (numberLanes == 1) {
+                compressShaExtensions(*states, data, numberBlocks);
+            } else {
+                compressLanesShaExtensions(states, numberLanes, data, numberBlocks);
+            }
+        } else if (kernel == Kernel::SSE2) {
+            compressLanesSse2(states, numberLanes, data, numberBlocks);
+        } else {
+            compressLanesPortable(states, numberLanes, data, numberBlocks);
+        }
+#else
+        (void) kernel;
+        compressLanesPortable(states, numberLanes, data, numberBlocks);
+#endif
+    }
+
+
+    bool Sha256::kernelSupported(Kernel kernel) {
+        bool result;
+
+#if (defined(__x86_64__) && defined(__GNUC__))
+        static const bool useShaExtensions = hasShaExtensions();
+
+        if (kernel == Kernel::SHA_EXTENSIONS) {
+            result = useShaExtensions;
+        } else {
+            result = true;
+        }
+#else
+        result = (kernel == Kernel::PORTABLE);
+#endif
+
+        return result;
+    }
+}
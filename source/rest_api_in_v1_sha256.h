@@ -0,0 +1,222 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::Sha256 class.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_SHA256_H
+#define REST_API_IN_V1_SHA256_H
+
+#include <QByteArray>
+
+#include <cstdint>
+
+#include "rest_api_in_v1_common.h"
+
+namespace RestApiInV1 {
+    /**
+     * SHA-256 implementation that exposes the intermediate hash state.  The state after any whole number of blocks,
+     * the midstate, can be saved and used to start later calculations.  HMAC uses this to avoid hashing the padded
+     * key for every message.
+     */
+    class REST_API_V1_PUBLIC_API Sha256 {
+        public:
+            /**
+             * The SHA-256 block length, in bytes.
+             */
+            static constexpr unsigned blockLength = 64;
+
+            /**
+             * The SHA-256 digest length, in bytes.
+             */
+            static constexpr unsigned digestLength = 32;
+
+            /**
+             * The largest number of lanes \ref compressLanes can take.
+             */
+            static constexpr unsigned maximumLanes = 4;
+
+            /**
+             * Enumeration of the block compression kernels.  \ref compressLanes normally picks the kernel itself.
+             * The kernels are named so each can be checked against the portable kernel.
+             */
+            enum class Kernel {
+                /**
+                 * Plain C++, available everywhere.
+                 */
+                PORTABLE,
+
+                /**
+                 * SSE2, one lane per vector element.  Available on x86-64.
+                 */
+                SSE2,
+
+                /**
+                 * The x86 SHA extensions.
+                 */
+                SHA_EXTENSIONS
+            };
+
+            /**
+             * Type used to hold the intermediate hash state.
+             */
+            struct State {
+                /**
+                 * The eight working hash values.
+                 */
+                std::uint32_t words[8];
+            };
+
+            /**
+             * The state before any data is hashed.
+             */
+            static const State initialState;
+
+            Sha256();
+
+            /**
+             * Constructor
+             *
+             * \param[in] midstate     The state to resume from.
+             *
+             * \param[in] bytesHashed The number of bytes, a multiple of \ref blockLength, that produced the state.
+             */
+            Sha256(const State& midstate, unsigned long long bytesHashed);
+
+            /**
+             * Method you can use to add data to the hash calculation.
+             *
+             * \param[in] data   Pointer to the data to be added.
+             *
+             * \param[in] length The number of bytes to be added.
+             */
+            void addData(const char* data, unsigned long length);
+
+            /**
+             * Method you can use to complete the hash calculation.  No data can be added afterwards.
+             *
+             * \param[out] digest Receives the \ref digestLength byte digest.
+             */
+            void result(unsigned char* digest);
+
+            /**
+             * Method you can use to complete the hash calculation.  No data can be added afterwards.
+             *
+             * \return Returns the digest.
+             */
+            QByteArray result();
+
+            /**
+             * Method that hashes whole blocks into a state.
+             *
+             * \param[in,out] state        The state to be updated.
+             *
+             * \param[in]     data         Pointer to the blocks to be hashed.
+             *
+             * \param[in]     numberBlocks The number of \ref blockLength byte blocks to be hashed.
+             */
+            static void compress(State& state, const unsigned char* data, unsigned long numberBlocks);
+
+            /**
+             * Method that hashes the same blocks into several independent states, one per lane.  The fastest
+             * implementation for the processor is selected when first used.
+             *
+             * \param[in,out] states       The states to be updated.
+             *
+             * \param[in]     numberLanes  The number of states, up to \ref maximumLanes.
+             *
+             * \param[in]     data         Pointer to the blocks to be hashed.
+             *
+             * \param[in]     numberBlocks The number of \ref blockLength byte blocks to be hashed.
+             */
+            static void compressLanes(
+                State*               states,
+                unsigned             numberLanes,
+                const unsigned char* data,
+                unsigned long        numberBlocks
+            );
+
+            /**
+             * Method that hashes the same blocks into several independent states using a specific kernel.
+             *
+             * \param[in]     kernel       The kernel to use.  The kernel must be supported by the processor.
+             *
+             * \param[in,out] states       The states to be updated.
+             *
+             * \param[in]     numberLanes  The number of states, up to \ref maximumLanes.
+             *
+             * \param[in]     data         Pointer to the blocks to be hashed.
+             *
+             * \param[in]     numberBlocks The number of \ref blockLength byte blocks to be hashed.
+             */
+            static void compressLanes(
+                Kernel               kernel,
+                State*               states,
+                unsigned             numberLanes,
+                const unsigned char* data,
+                unsigned long        numberBlocks
+            );
+
+            /**
+             * Method you can use to determine if the processor supports a kernel.
+             *
+             * \param[in] kernel The kernel to check.
+             *
+             * \return Returns true if the kernel can be used.
+             */
+            static bool kernelSupported(Kernel kernel);
+
+            /**
+             * Method that stores a 32-bit word in big endian order, as SHA-256 lays out the length and digest.
+             *
+             * \param[in]  value The value to be stored.
+             *
+             * \param[out] data  Pointer to the 4 bytes to receive the value.
+             */
+            static inline void storeBigEndian(std::uint32_t value, unsigned char* data) {
+                data[0] = static_cast<unsigned char>(value >> 24);
+                data[1] = static_cast<unsigned char>(value >> 16);
+                data[2] = static_cast<unsigned char>(value >>  8);
+                data[3] = static_cast<unsigned char>(value      );
+            }
+
+        private:
+            /**
+             * The current hash state.
+             */
+            State currentState;
+
+            /**
+             * The total number of bytes added.
+             */
+            unsigned long long currentLength;
+
+            /**
+             * Data waiting for a complete block.
+             */
+            unsigned char pendingData[blockLength];
+
+            /**
+             * The number of bytes in \ref pendingData.
+             */
+            unsigned pendingLength;
+    };
+};
+
+#endif
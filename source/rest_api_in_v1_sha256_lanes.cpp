@@ -0,0 +1,106 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::Sha256Lanes class.
+***********************************************************************************************************************/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "rest_api_in_v1_sha256.h"
+#include "rest_api_in_v1_sha256_lanes.h"
+
+namespace RestApiInV1 {
+    Sha256Lanes::Sha256Lanes():currentNumberLanes(0),currentLength(0),pendingLength(0) {}
+
+
+    Sha256Lanes::Sha256Lanes(
+            const Sha256::State* midstates,
+            unsigned             numberLanes,
+            unsigned long long   bytesHashed
+        ):currentNumberLanes(
+            std::min(numberLanes, Sha256::maximumLanes)
+        ),currentLength(
+            bytesHashed
+        ),pendingLength(
+            0
+        ) {
+        std::copy(midstates, midstates + currentNumberLanes, laneStates);
+    }
+
+
+    void Sha256Lanes::addData(const char* data, unsigned long length) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        currentLength += length;
+
+        if (pendingLength > 0) {
+            unsigned long count = std::min(static_cast<unsigned long>(Sha256::blockLength - pendingLength), length);
+            std::memcpy(pendingData + pendingLength, bytes, count);
+
+            pendingLength += static_cast<unsigned>(count);
+            bytes         += count;
+            length        -= count;
+
+            if (pendingLength == Sha256::blockLength) {
+                Sha256::compressLanes(laneStates, currentNumberLanes, pendingData, 1);
+                pendingLength = 0;
+            }
+        }
+
+        unsigned long numberBlocks = length / Sha256::blockLength;
+        if (numberBlocks > 0) {
+            Sha256::compressLanes(laneStates, currentNumberLanes, bytes, numberBlocks);
+
+            bytes  += numberBlocks * Sha256::blockLength;
+            length -= numberBlocks * Sha256::blockLength;
+        }
+
+        if (length > 0) {
+            std::memcpy(pendingData, bytes, length);
+            pendingLength = static_cast<unsigned>(length);
+        }
+    }
+
+
+    void Sha256Lanes::result(unsigned char* digests) const {
+        Sha256::State      states[Sha256::maximumLanes];
+        unsigned char      padding[2 * Sha256::blockLength];
+        unsigned long long bitLength    = currentLength * 8;
+        unsigned           paddedLength = pendingLength + 1 + 8 <= Sha256::blockLength ? 1 : 2;
+
+        // Padding is common to every lane so the final blocks are hashed once for all of them.
+        paddedLength *= Sha256::blockLength;
+
+        std::memset(padding, 0, paddedLength);
+        std::memcpy(padding, pendingData, pendingLength);
+        padding[pendingLength] = 0x80;
+        Sha256::storeBigEndian(static_cast<std::uint32_t>(bitLength >> 32), padding + paddedLength - 8);
+        Sha256::storeBigEndian(static_cast<std::uint32_t>(bitLength),       padding + paddedLength - 4);
+
+        std::copy(laneStates, laneStates + currentNumberLanes, states);
+        Sha256::compressLanes(states, currentNumberLanes, padding, paddedLength / Sha256::blockLength);
+
+        for (unsigned lane=0 ; lane<currentNumberLanes ; ++lane) {
+            for (unsigned i=0 ; i<8 ; ++i) {
+                Sha256::storeBigEndian(states[lane].words[i], digests + lane * Sha256::digestLength + 4 * i);
+            }
+        }
+    }
+}
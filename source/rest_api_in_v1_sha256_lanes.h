@@ -0,0 +1,94 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::Sha256Lanes class.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_SHA256_LANES_H
+#define REST_API_IN_V1_SHA256_LANES_H
+
+#include "rest_api_in_v1_common.h"
+#include "rest_api_in_v1_sha256.h"
+
+namespace RestApiInV1 {
+    /**
+     * Class that hashes one message from several starting states at once.  Data is read once and every lane shares
+     * the message schedule, so checking an HMAC against several keys costs about one pass over the data.
+     */
+    class REST_API_V1_PUBLIC_API Sha256Lanes {
+        public:
+            Sha256Lanes();
+
+            /**
+             * Constructor
+             *
+             * \param[in] midstates   The starting state for each lane.
+             *
+             * \param[in] numberLanes The number of lanes, up to \ref Sha256::maximumLanes.
+             *
+             * \param[in] bytesHashed The number of bytes, a multiple of \ref Sha256::blockLength, that produced the
+             *                        starting states.
+             */
+            Sha256Lanes(const Sha256::State* midstates, unsigned numberLanes, unsigned long long bytesHashed);
+
+            /**
+             * Method you can use to add data to every lane.
+             *
+             * \param[in] data   Pointer to the data to be added.
+             *
+             * \param[in] length The number of bytes to be added.
+             */
+            void addData(const char* data, unsigned long length);
+
+            /**
+             * Method you can use to obtain the digest for every lane.  More data can be added afterwards.
+             *
+             * \param[out] digests Receives \ref Sha256::digestLength bytes for each lane, in lane order.
+             */
+            void result(unsigned char* digests) const;
+
+        private:
+            /**
+             * The current state for each lane.
+             */
+            Sha256::State laneStates[Sha256::maximumLanes];
+
+            /**
+             * The number of lanes in use.
+             */
+            unsigned currentNumberLanes;
+
+            /**
+             * The total number of bytes added.
+             */
+            unsigned long long currentLength;
+
+            /**
+             * Data waiting for a complete block.
+             */
+            unsigned char pendingData[Sha256::blockLength];
+
+            /**
+             * The number of bytes in \ref pendingData.
+             */
+            unsigned pendingLength;
+    };
+};
+
+#endif
@@ -0,0 +1,82 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::StreamingResponse class.
+***********************************************************************************************************************/
+
+#include <QByteArray>
+
+#include "rest_api_in_v1_session.h"
+#include "rest_api_in_v1_response.h"
+#include "rest_api_in_v1_streaming_response.h"
+
+namespace RestApiInV1 {
+    namespace {
+        /**
+         * Writer used to collect a generated body into memory.
+         */
+        class ByteArrayBodyWriter:public Session::BodyWriter {
+            public:
+                bool writeBodyData(const char* data, unsigned long length) override {
+                    body.append(data, static_cast<int>(length));
+                    return true;
+                }
+
+                using Session::BodyWriter::writeBodyData;
+
+                /**
+                 * The collected body.
+                 */
+                QByteArray body;
+        };
+    }
+
+
+    const QByteArray StreamingResponse::defaultContentType("application/octet-stream");
+
+    StreamingResponse::StreamingResponse(
+            StatusCode        statusCode,
+            const QByteArray& contentType
+        ):Response(
+            statusCode,
+            contentType
+        ) {}
+
+
+    StreamingResponse::~StreamingResponse() {}
+
+
+    bool StreamingResponse::isBinaryResponse() const {
+        return true;
+    }
+
+
+    bool StreamingResponse::isStreamingResponse() const {
+        return true;
+    }
+
+
+    QByteArray StreamingResponse::asByteArray() const {
+        ByteArrayBodyWriter writer;
+
+        // Generators are expected to keep state so generation is not a const operation.
+        bool success = const_cast<StreamingResponse*>(this)->generateBody(writer);
+        return success ? writer.body : QByteArray();
+    }
+}
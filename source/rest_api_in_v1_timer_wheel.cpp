@@ -0,0 +1,165 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::TimerWheel class.
+***********************************************************************************************************************/
+
+#include <QList>
+#include <QVector>
+
+#include "rest_api_in_v1_timer_wheel.h"
+
+namespace RestApiInV1 {
+    TimerWheel::Timer::Timer():currentWheel(
+            nullptr
+        ),currentDeadline(
+            0
+        ),currentSlot(
+            0
+        ),previous(
+            nullptr
+        ),next(
+            nullptr
+        ) {}
+
+
+    TimerWheel::Timer::~Timer() {
+        if (currentWheel != nullptr) {
+            currentWheel->cancel(this);
+        }
+    }
+
+
+    TimerWheel::TimerWheel(
+            long long now,
+            long long resolution,
+            unsigned  numberSlots
+        ):currentResolution(
+            resolution
+        ),slotMask(
+            numberSlots - 1
+        ),currentTick(
+            now / resolution
+        ),numberTimers(
+            0
+        ),slotHeads(
+            static_cast<int>(numberSlots),
+            nullptr
+        ) {}
+
+
+    TimerWheel::~TimerWheel() {
+        for (unsigned i=0 ; i<static_cast<unsigned>(slotHeads.size()) ; ++i) {
+            Timer* timer = slotHeads.at(i);
+            while (timer != nullptr) {
+                Timer* nextTimer = timer->next;
+
+                timer->currentWheel = nullptr;
+                timer->previous     = nullptr;
+                timer->next         = nullptr;
+
+                timer = nextTimer;
+            }
+        }
+    }
+
+
+    void TimerWheel::schedule(TimerWheel::Timer* timer, long long deadline) {
+        cancel(timer);
+
+        // Timers are placed in the first slot starting at or after their deadline so they are due when the slot is
+        // examined.  Timers already due are placed in the next slot to be examined so they are not missed.
+        long long tick = (deadline + currentResolution - 1) / currentResolution;
+        if (tick <= currentTick) {
+            tick = currentTick + 1;
+        }
+
+        unsigned slotIndex = static_cast<unsigned>(static_cast<unsigned long long>(tick) & slotMask);
+        Timer*&  head      = slotHeads[static_cast<int>(slotIndex)];
+
+        timer->currentWheel    = this;
+        timer->currentDeadline = deadline;
+        timer->currentSlot     = slotIndex;
+        timer->previous        = nullptr;
+        timer->next            = head;
+
+        if (head != nullptr) {
+            head->previous = timer;
+        }
+
+        head = timer;
+        ++numberTimers;
+    }
+
+
+    void TimerWheel::cancel(TimerWheel::Timer* timer) {
+        if (timer->currentWheel == this) {
+            if (timer->previous != nullptr) {
+                timer->previous->next = timer->next;
+            } else {
+                slotHeads[static_cast<int>(timer->currentSlot)] = timer->next;
+            }
+
+            if (timer->next != nullptr) {
+                timer->next->previous = timer->previous;
+            }
+
+            timer->currentWheel = nullptr;
+            timer->previous     = nullptr;
+            timer->next         = nullptr;
+
+            --numberTimers;
+        }
+    }
+
+
+    void TimerWheel::advance(long long now, QList<TimerWheel::Timer*>& expired) {
+        long long targetTick  = now / currentResolution;
+        long long numberTicks = targetTick - currentTick;
+
+        if (numberTicks > static_cast<long long>(slotMask)) {
+            // We fell more than a revolution behind.  Every slot is examined once.
+            for (unsigned i=0 ; i<=slotMask ; ++i) {
+                expireSlot(i, now, expired);
+            }
+        } else {
+            for (long long tick=currentTick + 1 ; tick<=targetTick ; ++tick) {
+                expireSlot(static_cast<unsigned>(static_cast<unsigned long long>(tick) & slotMask), now, expired);
+            }
+        }
+
+        if (targetTick > currentTick) {
+            currentTick = targetTick;
+        }
+    }
+
+
+    void TimerWheel::expireSlot(unsigned slotIndex, long long now, QList<TimerWheel::Timer*>& expired) {
+        Timer* timer = slotHeads.at(static_cast<int>(slotIndex));
+        while (timer != nullptr) {
+            Timer* nextTimer = timer->next;
+            if (timer->currentDeadline <= now) {
+                cancel(timer);
+                expired.append(timer);
+            }
+
+            timer = nextTimer;
+        }
+    }
+}
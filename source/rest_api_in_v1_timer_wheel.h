@@ -0,0 +1,211 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref RestApiInV1::TimerWheel class.
+***********************************************************************************************************************/
+
+#ifndef REST_API_IN_V1_TIMER_WHEEL_H
+#define REST_API_IN_V1_TIMER_WHEEL_H
+
+#include <QList>
+#include <QVector>
+
+#include "rest_api_in_v1_common.h"
+
+namespace RestApiInV1 {
+    /**
+     * Hashed timer wheel.  Timers are placed in the slot covering their deadline so scheduling, cancelling, and
+     * expiring a timer cost a constant amount of work regardless of the number of timers.  Deadlines more than one
+     * revolution away share slots with nearer deadlines and are skipped until their turn comes.
+     *
+     * Timers are intrusive; embed or derive from \ref TimerWheel::Timer.  The wheel is not thread safe and is intended
+     * to be owned by a single event loop.
+     */
+    class REST_API_V1_PUBLIC_API TimerWheel {
+        public:
+            /**
+             * Class holding the bookkeeping for a single timer.
+             */
+            class Timer {
+                friend class TimerWheel;
+
+                public:
+                    Timer();
+
+                    ~Timer();
+
+                    /**
+                     * Method you can use to determine if this timer is scheduled.
+                     *
+                     * \return Returns true if the timer is scheduled.  Returns false if the timer is not scheduled.
+                     */
+                    inline bool isScheduled() const {
+                        return currentWheel != nullptr;
+                    }
+
+                    /**
+                     * Method you can use to obtain the time this timer expires.
+                     *
+                     * \return Returns the deadline, in milliseconds.
+                     */
+                    inline long long deadline() const {
+                        return currentDeadline;
+                    }
+
+                private:
+                    /**
+                     * The wheel holding this timer.  A null pointer indicates the timer is not scheduled.
+                     */
+                    TimerWheel* currentWheel;
+
+                    /**
+                     * The time this timer expires, in milliseconds.
+                     */
+                    long long currentDeadline;
+
+                    /**
+                     * The slot holding this timer.
+                     */
+                    unsigned currentSlot;
+
+                    /**
+                     * The previous timer in the slot.
+                     */
+                    Timer* previous;
+
+                    /**
+                     * The next timer in the slot.
+                     */
+                    Timer* next;
+            };
+
+            /**
+             * Constructor
+             *
+             * \param[in] now         The current time, in milliseconds.
+             *
+             * \param[in] resolution  The time covered by each slot, in milliseconds.
+             *
+             * \param[in] numberSlots The number of slots.  Must be a power of two.
+             */
+            TimerWheel(
+                long long now,
+                long long resolution = defaultResolution,
+                unsigned  numberSlots = defaultNumberSlots
+            );
+
+            ~TimerWheel();
+
+            /**
+             * Method you can use to determine the time covered by each slot.
+             *
+             * \return Returns the slot resolution, in milliseconds.
+             */
+            inline long long resolution() const {
+                return currentResolution;
+            }
+
+            /**
+             * Method you can use to determine if any timers are scheduled.
+             *
+             * \return Returns true if the wheel holds no timers.  Returns false if timers are scheduled.
+             */
+            inline bool isEmpty() const {
+                return numberTimers == 0;
+            }
+
+            /**
+             * Method you can use to schedule or reschedule a timer.
+             *
+             * \param[in] timer    The timer to be scheduled.
+             *
+             * \param[in] deadline The time the timer expires, in milliseconds.
+             */
+            void schedule(Timer* timer, long long deadline);
+
+            /**
+             * Method you can use to cancel a timer.  Cancelling a timer that is not scheduled has no effect.
+             *
+             * \param[in] timer The timer to be cancelled.
+             */
+            void cancel(Timer* timer);
+
+            /**
+             * Method you can use to advance the wheel and collect every timer whose deadline has passed.  Collected
+             * timers are no longer scheduled.
+             *
+             * \param[in]  now     The current time, in milliseconds.
+             *
+             * \param[out] expired The list to receive the expired timers.
+             */
+            void advance(long long now, QList<Timer*>& expired);
+
+        private:
+            /**
+             * The default slot resolution, in milliseconds.
+             */
+            static constexpr long long defaultResolution = 100;
+
+            /**
+             * The default number of slots.  With the default resolution the wheel turns every 51.2 seconds.
+             */
+            static constexpr unsigned defaultNumberSlots = 512;
+
+            TimerWheel(const TimerWheel& other) = delete;
+            TimerWheel& operator=(const TimerWheel& other) = delete;
+
+            /**
+             * Method that expires the due timers in a single slot.
+             *
+             * \param[in]  slotIndex The slot to be examined.
+             *
+             * \param[in]  now       The current time, in milliseconds.
+             *
+             * \param[out] expired   The list to receive the expired timers.
+             */
+            void expireSlot(unsigned slotIndex, long long now, QList<Timer*>& expired);
+
+            /**
+             * The time covered by each slot, in milliseconds.
+             */
+            long long currentResolution;
+
+            /**
+             * Mask used to map a tick to a slot.
+             */
+            unsigned slotMask;
+
+            /**
+             * The last tick processed by \ref advance.
+             */
+            long long currentTick;
+
+            /**
+             * The number of scheduled timers.
+             */
+            unsigned long numberTimers;
+
+            /**
+             * The first timer in each slot.
+             */
+            QVector<Timer*> slotHeads;
+    };
+};
+
+#endif
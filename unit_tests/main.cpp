@@ -0,0 +1,43 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file is the main entry point for the inerest_api_in_v1 unit tests.
+***********************************************************************************************************************/
+
+#include <QCoreApplication>
+#include <QtTest/QtTest>
+
+#include "test_crypto.h"
+#include "test_protocol.h"
+
+int main(int argc, char* argv[]) {
+    QCoreApplication application(argc, argv);
+    int              status = 0;
+
+    TestCrypto testCrypto;
+    status |= QTest::qExec(&testCrypto, argc, argv);
+
+    TestProtocol testProtocolWorkers(0, 18401);
+    status |= QTest::qExec(&testProtocolWorkers, argc, argv);
+
+    TestProtocol testProtocolIoThreads(2, 18402);
+    status |= QTest::qExec(&testProtocolIoThreads, argc, argv);
+
+    return status;
+}
@@ -0,0 +1,204 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref TestClient class.
+***********************************************************************************************************************/
+
+#include <QByteArray>
+#include <QHash>
+#include <QHostAddress>
+#include <QTcpSocket>
+
+#include "test_client.h"
+
+TestClient::TestClient() {}
+
+
+TestClient::~TestClient() {
+    socket.abort();
+}
+
+
+bool TestClient::connectToServer(unsigned short port) {
+    socket.connectToHost(QHostAddress(QHostAddress::LocalHost), port);
+    return socket.waitForConnected(readTimeout);
+}
+
+
+bool TestClient::send(const QByteArray& data) {
+    bool success = (socket.write(data) == data.size());
+    while (success && socket.bytesToWrite() > 0) {
+        success = socket.waitForBytesWritten(readTimeout);
+    }
+
+    return success;
+}
+
+
+bool TestClient::readResponse(TestClient::Response& response, bool bodyExpected) {
+    response.statusCode = 0;
+    response.headers.clear();
+    response.body.clear();
+
+    QByteArray statusLine;
+    bool       success = readLine(statusLine);
+    if (success) {
+        QList<QByteArray> fields = statusLine.split(' ');
+        success = (fields.size() >= 2 && fields.at(0).startsWith("HTTP/1."));
+        if (success) {
+            response.statusCode = fields.at(1).toUInt(&success);
+        }
+    }
+
+    bool done = false;
+    while (success && !done) {
+        QByteArray line;
+        success = readLine(line);
+        if (success) {
+            if (line.isEmpty()) {
+                done = true;
+            } else {
+                int colonPosition = line.indexOf(':');
+                success = (colonPosition > 0);
+                if (success) {
+                    response.headers.insert(
+                        line.left(colonPosition).trimmed().toLower(),
+                        line.mid(colonPosition + 1).trimmed()
+                    );
+                }
+            }
+        }
+    }
+
+    bool bodyless = (
+           !bodyExpected
+        || response.statusCode < 200
+        || response.statusCode == 204
+        || response.statusCode == 304
+    );
+
+    if (success && !bodyless) {
+        if (response.headers.value("transfer-encoding").toLower() == "chunked") {
+            success = readChunkedBody(response.body);
+        } else if (response.headers.contains("content-length")) {
+            int contentLength = response.headers.value("content-length").toInt(&success);
+            if (success) {
+                success = readBytes(contentLength, response.body);
+            }
+        } else {
+            // The body runs until the server closes the connection.
+            while (fill()) {}
+            response.body = pending;
+            pending.clear();
+        }
+    }
+
+    return success;
+}
+
+
+bool TestClient::closedByServer() {
+    bool closed = pending.isEmpty();
+    if (closed && socket.state() == QAbstractSocket::ConnectedState) {
+        closed = !socket.waitForReadyRead(closeTimeout) && socket.state() != QAbstractSocket::ConnectedState;
+    }
+
+    return closed;
+}
+
+
+bool TestClient::fill() {
+    bool success = socket.bytesAvailable() > 0 || socket.waitForReadyRead(readTimeout);
+    if (success) {
+        QByteArray data = socket.readAll();
+        pending.append(data);
+        success = !data.isEmpty();
+    }
+
+    return success;
+}
+
+
+bool TestClient::readLine(QByteArray& line) {
+    bool success = true;
+    int  end     = pending.indexOf("\r\n");
+    while (success && end < 0) {
+        success = fill();
+        end     = pending.indexOf("\r\n");
+    }
+
+    if (success) {
+        line = pending.left(end);
+        pending.remove(0, end + 2);
+    }
+
+    return success;
+}
+
+
+bool TestClient::readBytes(int count, QByteArray& data) {
+    bool success = true;
+    while (success && pending.size() < count) {
+        success = fill();
+    }
+
+    if (success) {
+        data = pending.left(count);
+        pending.remove(0, count);
+    }
+
+    return success;
+}
+
+
+bool TestClient::readChunkedBody(QByteArray& body) {
+    bool success = true;
+    bool done    = false;
+
+    while (success && !done) {
+        QByteArray sizeLine;
+        success = readLine(sizeLine);
+        if (success) {
+            int extensionPosition = sizeLine.indexOf(';');
+            if (extensionPosition >= 0) {
+                sizeLine.truncate(extensionPosition);
+            }
+
+            int chunkSize = sizeLine.trimmed().toInt(&success, 16);
+            if (success && chunkSize > 0) {
+                QByteArray chunk;
+                QByteArray terminator;
+                success = readBytes(chunkSize, chunk) && readLine(terminator) && terminator.isEmpty();
+                body.append(chunk);
+            } else if (success) {
+                done = true;
+            }
+        }
+    }
+
+    // Trailers are read and dropped.
+    bool trailersDone = false;
+    while (success && !trailersDone) {
+        QByteArray line;
+        success      = readLine(line);
+        trailersDone = line.isEmpty();
+    }
+
+    return success;
+}
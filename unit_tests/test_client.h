@@ -0,0 +1,156 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This header defines the \ref TestClient class.
+***********************************************************************************************************************/
+
+#ifndef TEST_CLIENT_H
+#define TEST_CLIENT_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QTcpSocket>
+
+/**
+ * Minimal HTTP/1.1 client used to drive the server over a raw socket.  Requests are written exactly as given so the
+ * tests control the framing.  All calls block so no event loop is needed.
+ */
+class TestClient {
+    public:
+        /**
+         * Structure holding one parsed response.
+         */
+        struct Response {
+            /**
+             * The response status code.
+             */
+            unsigned statusCode;
+
+            /**
+             * The response headers.  Names are converted to lower case.
+             */
+            QHash<QByteArray, QByteArray> headers;
+
+            /**
+             * The response body with any chunked framing removed.
+             */
+            QByteArray body;
+        };
+
+        /**
+         * The time, in mSec, to wait for data from the server.
+         */
+        static constexpr int readTimeout = 5000;
+
+        /**
+         * The time, in mSec, to wait for the server to close an idle connection.
+         */
+        static constexpr int closeTimeout = 2000;
+
+        TestClient();
+
+        ~TestClient();
+
+        /**
+         * Method that connects to the server on the local host.
+         *
+         * \param[in] port The port the server is listening on.
+         *
+         * \return Returns true on success.  Returns false on error.
+         */
+        bool connectToServer(unsigned short port);
+
+        /**
+         * Method that sends raw request data.
+         *
+         * \param[in] data The data to be sent.
+         *
+         * \return Returns true on success.  Returns false on error.
+         */
+        bool send(const QByteArray& data);
+
+        /**
+         * Method that reads one response.
+         *
+         * \param[out] response     Receives the response.
+         *
+         * \param[in]  bodyExpected If false, the response is assumed to have no body whatever its headers say, as is
+         *                          the case for HEAD requests.
+         *
+         * \return Returns true on success.  Returns false if the response is malformed or incomplete.
+         */
+        bool readResponse(Response& response, bool bodyExpected = true);
+
+        /**
+         * Method that checks whether the server closed the connection.  Any data the server sends instead counts as
+         * the connection staying open.
+         *
+         * \return Returns true if the server closed the connection.
+         */
+        bool closedByServer();
+
+    private:
+        /**
+         * Method that waits for more data from the server.
+         *
+         * \return Returns true if data was received.  Returns false on timeout or if the connection closed.
+         */
+        bool fill();
+
+        /**
+         * Method that reads one CRLF terminated line.
+         *
+         * \param[out] line Receives the line without the line terminator.
+         *
+         * \return Returns true on success.  Returns false on error.
+         */
+        bool readLine(QByteArray& line);
+
+        /**
+         * Method that reads a fixed number of bytes.
+         *
+         * \param[in]  count The number of bytes to be read.
+         *
+         * \param[out] data  Receives the data.
+         *
+         * \return Returns true on success.  Returns false on error.
+         */
+        bool readBytes(int count, QByteArray& data);
+
+        /**
+         * Method that reads a chunked body, including any trailers.
+         *
+         * \param[out] body Receives the body.
+         *
+         * \return Returns true on success.  Returns false on error.
+         */
+        bool readChunkedBody(QByteArray& body);
+
+        /**
+         * The socket connected to the server.
+         */
+        QTcpSocket socket;
+
+        /**
+         * Data received but not yet consumed.
+         */
+        QByteArray pending;
+};
+
+#endif
@@ -0,0 +1,484 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref TestCrypto class.
+***********************************************************************************************************************/
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QCryptographicHash>
+#include <QMessageAuthenticationCode>
+#include <QtTest/QtTest>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+#include "rest_api_in_v1_sha256.h"
+#include "rest_api_in_v1_sha256_lanes.h"
+#include "rest_api_in_v1_blake2b.h"
+#include "rest_api_in_v1_base64.h"
+#include "rest_api_in_v1_authentication_helpers.h"
+
+#include "test_crypto.h"
+
+using RestApiInV1::Sha256;
+using RestApiInV1::Sha256Lanes;
+using RestApiInV1::Blake2b;
+using RestApiInV1::Base64Decoder;
+using RestApiInV1::MacAlgorithm;
+
+/**
+ * Generator used for the test data.  A fixed seed keeps failures repeatable.
+ */
+static std::mt19937 generator(0x5EED);
+
+/**
+ * Method that builds random data.
+ *
+ * \param[in] length The number of bytes to generate.
+ *
+ * \return Returns the random data.
+ */
+static QByteArray randomBytes(unsigned length) {
+    QByteArray result(static_cast<int>(length), '\0');
+    for (unsigned i=0 ; i<length ; ++i) {
+        result[static_cast<int>(i)] = static_cast<char>(generator() & 0xFF);
+    }
+
+    return result;
+}
+
+
+/**
+ * Method that builds the message authentication key for a time window the way clients do, the zero padded secret
+ * followed by the little-endian time index.
+ *
+ * \param[in] secret The secret.
+ *
+ * \param[in] window The time window.
+ *
+ * \return Returns the key.
+ */
+static QByteArray windowKey(const QByteArray& secret, unsigned long long window) {
+    QByteArray result = secret.left(static_cast<int>(RestApiInV1::inesonicSecretLength));
+    result.append(QByteArray(static_cast<int>(RestApiInV1::inesonicSecretLength) - result.size(), '\0'));
+
+    for (unsigned i=0 ; i<8 ; ++i) {
+        result.append(static_cast<char>((window >> (8 * i)) & 0xFF));
+    }
+
+    return result;
+}
+
+
+/**
+ * Method that calculates a keyed BLAKE2b digest.
+ *
+ * \param[in] key          The key.
+ *
+ * \param[in] data         The data to be hashed.
+ *
+ * \param[in] digestLength The digest length, in bytes.
+ *
+ * \return Returns the digest.
+ */
+static QByteArray blake2b(const QByteArray& key, const QByteArray& data, unsigned digestLength) {
+    Blake2b hash(
+        reinterpret_cast<const unsigned char*>(key.constData()),
+        static_cast<unsigned>(key.size()),
+        digestLength
+    );
+
+    hash.addData(data.constData(), static_cast<unsigned long>(data.size()));
+
+    QByteArray result(static_cast<int>(digestLength), '\0');
+    hash.result(reinterpret_cast<unsigned char*>(result.data()));
+
+    return result;
+}
+
+
+/**
+ * Method that compares a SHA-256 kernel against the portable kernel for every lane count.
+ *
+ * \param[in] kernel The kernel to be checked.
+ *
+ * \return Returns the number of mismatched results.
+ */
+static unsigned compareSha256Kernel(Sha256::Kernel kernel) {
+    unsigned mismatches = 0;
+
+    for (unsigned numberLanes=1 ; numberLanes<=Sha256::maximumLanes ; ++numberLanes) {
+        for (unsigned long numberBlocks=0 ; numberBlocks<=9 ; ++numberBlocks) {
+            QByteArray data = randomBytes(static_cast<unsigned>(numberBlocks * Sha256::blockLength));
+
+            Sha256::State expected[Sha256::maximumLanes];
+            Sha256::State measured[Sha256::maximumLanes];
+            for (unsigned lane=0 ; lane<Sha256::maximumLanes ; ++lane) {
+                for (unsigned i=0 ; i<8 ; ++i) {
+                    expected[lane].words[i] = static_cast<std::uint32_t>(generator());
+                }
+
+                measured[lane] = expected[lane];
+            }
+
+            const unsigned char* blocks = reinterpret_cast<const unsigned char*>(data.constData());
+            Sha256::compressLanes(Sha256::Kernel::PORTABLE, expected, numberLanes, blocks, numberBlocks);
+            Sha256::compressLanes(kernel, measured, numberLanes, blocks, numberBlocks);
+
+            // Lanes past the lane count must be left alone.
+            if (std::memcmp(expected, measured, sizeof(expected)) != 0) {
+                ++mismatches;
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+
+TestCrypto::TestCrypto(QObject* parent):QObject(parent) {}
+
+
+TestCrypto::~TestCrypto() {}
+
+
+void TestCrypto::testSha256Vectors() {
+    // FIPS 180-2 examples.
+    struct Vector {
+        QByteArray message;
+        QByteArray digest;
+    };
+
+    const Vector vectors[] = {
+        {
+            QByteArray(""),
+            QByteArray("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855")
+        },
+        {
+            QByteArray("abc"),
+            QByteArray("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad")
+        },
+        {
+            QByteArray("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+            QByteArray("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1")
+        },
+        {
+            QByteArray(1000000, 'a'),
+            QByteArray("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0")
+        }
+    };
+
+    for (const Vector& vector : vectors) {
+        Sha256 hash;
+        hash.addData(vector.message.constData(), static_cast<unsigned long>(vector.message.size()));
+        QCOMPARE(hash.result().toHex(), vector.digest);
+
+        // Data added in uneven pieces must give the same digest.
+        Sha256 piecewiseHash;
+        int    offset = 0;
+        int    step   = 1;
+        while (offset < vector.message.size()) {
+            int length = std::min(step, vector.message.size() - offset);
+            piecewiseHash.addData(vector.message.constData() + offset, static_cast<unsigned long>(length));
+
+            offset += length;
+            step    = (step * 7 + 3) % 200 + 1;
+        }
+
+        QCOMPARE(piecewiseHash.result().toHex(), vector.digest);
+    }
+
+    for (unsigned length=0 ; length<300 ; ++length) {
+        QByteArray data = randomBytes(length);
+
+        Sha256 hash;
+        hash.addData(data.constData(), length);
+        QCOMPARE(hash.result(), QCryptographicHash::hash(data, QCryptographicHash::Sha256));
+    }
+}
+
+
+void TestCrypto::testSha256Sse2Kernel() {
+    if (!Sha256::kernelSupported(Sha256::Kernel::SSE2)) {
+        QSKIP("SSE2 is not available on this processor.");
+    }
+
+    QCOMPARE(compareSha256Kernel(Sha256::Kernel::SSE2), 0U);
+}
+
+
+void TestCrypto::testSha256ShaExtensionsKernel() {
+    if (!Sha256::kernelSupported(Sha256::Kernel::SHA_EXTENSIONS)) {
+        QSKIP("The SHA extensions are not available on this processor.");
+    }
+
+    QCOMPARE(compareSha256Kernel(Sha256::Kernel::SHA_EXTENSIONS), 0U);
+}
+
+
+void TestCrypto::testSha256Lanes() {
+    for (unsigned numberLanes=1 ; numberLanes<=Sha256::maximumLanes ; ++numberLanes) {
+        for (unsigned length=0 ; length<300 ; length+=7) {
+            QByteArray    prefix = randomBytes(Sha256::blockLength);
+            QByteArray    data   = randomBytes(length);
+            Sha256::State midstates[Sha256::maximumLanes];
+
+            for (unsigned lane=0 ; lane<numberLanes ; ++lane) {
+                midstates[lane] = Sha256::initialState;
+                prefix[0]       = static_cast<char>(lane);
+
+                Sha256::compress(midstates[lane], reinterpret_cast<const unsigned char*>(prefix.constData()), 1);
+            }
+
+            Sha256Lanes lanes(midstates, numberLanes, Sha256::blockLength);
+            lanes.addData(data.constData(), length);
+
+            unsigned char digests[Sha256::maximumLanes * Sha256::digestLength];
+            lanes.result(digests);
+
+            for (unsigned lane=0 ; lane<numberLanes ; ++lane) {
+                prefix[0] = static_cast<char>(lane);
+
+                QByteArray expected = QCryptographicHash::hash(prefix + data, QCryptographicHash::Sha256);
+                QByteArray measured(
+                    reinterpret_cast<const char*>(digests + lane * Sha256::digestLength),
+                    static_cast<int>(Sha256::digestLength)
+                );
+
+                QCOMPARE(measured, expected);
+            }
+        }
+    }
+}
+
+
+void TestCrypto::testHmacSha256() {
+    const unsigned lengths[] = { 0, 1, 55, 56, 63, 64, 65, 1000, 10000 };
+
+    for (unsigned length : lengths) {
+        QByteArray data        = randomBytes(length);
+        QByteArray secret      = randomBytes(RestApiInV1::inesonicSecretLength);
+        QByteArray shortSecret = randomBytes(20);
+
+        // A window roll during the test moves the current window forward by one which is still accepted.
+        unsigned long long window = RestApiInV1::currentTimeWindow();
+
+        QByteArray mac = QMessageAuthenticationCode::hash(data, windowKey(secret, window), QCryptographicHash::Sha256);
+        QVERIFY(RestApiInV1::checkHash(data, mac, secret));
+        QVERIFY(RestApiInV1::checkHash(data, mac, secret, window));
+        QVERIFY(!RestApiInV1::checkHash(data, mac, secret, window + 1));
+
+        QByteArray nextMac = QMessageAuthenticationCode::hash(
+            data,
+            windowKey(secret, window + 1),
+            QCryptographicHash::Sha256
+        );
+        QVERIFY(RestApiInV1::checkHash(data, nextMac, secret));
+
+        QByteArray staleMac = QMessageAuthenticationCode::hash(
+            data,
+            windowKey(secret, window + 5),
+            QCryptographicHash::Sha256
+        );
+        QVERIFY(!RestApiInV1::checkHash(data, staleMac, secret));
+
+        QByteArray shortMac = QMessageAuthenticationCode::hash(
+            data,
+            windowKey(shortSecret, window),
+            QCryptographicHash::Sha256
+        );
+        QVERIFY(RestApiInV1::checkHash(data, shortMac, shortSecret));
+
+        int        tamperedIndex = static_cast<int>(length % RestApiInV1::inesonicHashLength);
+        QByteArray tamperedMac   = mac;
+        tamperedMac[tamperedIndex] = static_cast<char>(mac.at(tamperedIndex) ^ 0x01);
+        QVERIFY(!RestApiInV1::checkHash(data, tamperedMac, secret));
+        QVERIFY(!RestApiInV1::checkHash(data, mac.left(16), secret));
+    }
+}
+
+
+void TestCrypto::testBlake2bVectors() {
+    // RFC 7693 appendix A and the reference implementation's keyed known answer tests.
+    QCOMPARE(
+        blake2b(QByteArray(), QByteArray("abc"), 64).toHex(),
+        QByteArray(
+            "ba80a53f981c4d0d6a2797b69f12f6e94c212f14685ac4b74b12bb6fdbffa2d1"
+            "7d87c5392aab792dc252d5de4533cc9518d38aa8dbf1925ab92386edd4009923"
+        )
+    );
+
+    QCOMPARE(
+        blake2b(QByteArray(), QByteArray(), 64).toHex(),
+        QByteArray(
+            "786a02f742015903c6c6fd852552d272912f4740e15847618a86e217f71f5419"
+            "d25e1031afee585313896444934eb04b903a685b1448b755d56f701afe9be2ce"
+        )
+    );
+
+    QCOMPARE(
+        blake2b(QByteArray(), QByteArray("The quick brown fox jumps over the lazy dog"), 32).toHex(),
+        QByteArray("01718cec35cd3d796dd00020e0bfecb473ad23457d063b75eff29c0ffa2e58a9")
+    );
+
+    struct KeyedVector {
+        unsigned   length;
+        QByteArray digest;
+    };
+
+    const KeyedVector keyedVectors[] = {
+        {
+            0,
+            QByteArray(
+                "10ebb67700b1868efb4417987acf4690ae9d972fb7a590c2f02871799aaa4786"
+                "b5e996e8f0f4eb981fc214b005f42d2ff4233499391653df7aefcbc13fc51568"
+            )
+        },
+        {
+            1,
+            QByteArray(
+                "961f6dd1e4dd30f63901690c512e78e4b45e4742ed197c3c5e45c549fd25f2e4"
+                "187b0bc9fe30492b16b0d0bc4ef9b0f34c7003fac09a5ef1532e69430234cebd"
+            )
+        },
+        {
+            127,
+            QByteArray(
+                "76d2d819c92bce55fa8e092ab1bf9b9eab237a25267986cacf2b8ee14d214d73"
+                "0dc9a5aa2d7b596e86a1fd8fa0804c77402d2fcd45083688b218b1cdfa0dcbcb"
+            )
+        },
+        {
+            128,
+            QByteArray(
+                "72065ee4dd91c2d8509fa1fc28a37c7fc9fa7d5b3f8ad3d0d7a25626b57b1b44"
+                "788d4caf806290425f9890a3a2a35a905ab4b37acfd0da6e4517b2525c9651e4"
+            )
+        },
+        {
+            129,
+            QByteArray(
+                "64475dfe7600d7171bea0b394e27c9b00d8e74dd1e416a79473682ad3dfdbb70"
+                "6631558055cfc8a40e07bd015a4540dcdea15883cbbf31412df1de1cd4152b91"
+            )
+        },
+        {
+            255,
+            QByteArray(
+                "142709d62e28fcccd0af97fad0f8465b971e82201dc51070faa0372aa43e9248"
+                "4be1c1e73ba10906d5d1853db6a4106e0a7bf9800d373d6dee2d46d62ef2a461"
+            )
+        }
+    };
+
+    QByteArray key;
+    for (unsigned i=0 ; i<Blake2b::maximumKeyLength ; ++i) {
+        key.append(static_cast<char>(i));
+    }
+
+    for (const KeyedVector& vector : keyedVectors) {
+        QByteArray data;
+        for (unsigned i=0 ; i<vector.length ; ++i) {
+            data.append(static_cast<char>(i));
+        }
+
+        QCOMPARE(blake2b(key, data, 64).toHex(), vector.digest);
+    }
+}
+
+
+void TestCrypto::testBlake2bMac() {
+    const unsigned lengths[] = { 0, 1, 127, 128, 129, 1000, 10000 };
+
+    for (unsigned length : lengths) {
+        QByteArray         data   = randomBytes(length);
+        QByteArray         secret = randomBytes(RestApiInV1::inesonicSecretLength);
+        unsigned long long window = RestApiInV1::currentTimeWindow();
+
+        QByteArray mac = blake2b(windowKey(secret, window), data, RestApiInV1::inesonicHashLength);
+        QVERIFY(RestApiInV1::checkHash(data, mac, secret, MacAlgorithm::BLAKE2B_256));
+        QVERIFY(RestApiInV1::checkHash(data, mac, secret, window, MacAlgorithm::BLAKE2B_256));
+        QVERIFY(!RestApiInV1::checkHash(data, mac, secret, window + 1, MacAlgorithm::BLAKE2B_256));
+
+        // A MAC for one algorithm is never accepted for the other.
+        QVERIFY(!RestApiInV1::checkHash(data, mac, secret, MacAlgorithm::HMAC_SHA256));
+
+        QByteArray staleMac = blake2b(windowKey(secret, window + 5), data, RestApiInV1::inesonicHashLength);
+        QVERIFY(!RestApiInV1::checkHash(data, staleMac, secret, MacAlgorithm::BLAKE2B_256));
+    }
+}
+
+
+void TestCrypto::testBase64() {
+    for (unsigned length=0 ; length<200 ; ++length) {
+        QByteArray data    = randomBytes(length);
+        QString    encoded = QString::fromLatin1(data.toBase64());
+
+        QByteArray decoded;
+        QVERIFY(RestApiInV1::decodeBase64(encoded, decoded));
+        QCOMPARE(decoded, data);
+
+        // Unpadded input is accepted, as it is by Qt.
+        QVERIFY(RestApiInV1::decodeBase64(QString::fromLatin1(data.toBase64(QByteArray::OmitTrailingEquals)), decoded));
+        QCOMPARE(decoded, data);
+    }
+
+    const char* invalidInputs[] = { "A===", "AB=C", "ABC=D", "AB CD", "AB\nCD", "AB-_" };
+    for (const char* invalidInput : invalidInputs) {
+        QByteArray decoded;
+        QVERIFY(!RestApiInV1::decodeBase64(QString::fromLatin1(invalidInput), decoded));
+        QVERIFY(decoded.isEmpty());
+    }
+}
+
+
+void TestCrypto::testBase64Avx2() {
+    if (!RestApiInV1::base64DecoderSupported(Base64Decoder::AVX2)) {
+        QSKIP("AVX2 is not available on this processor.");
+    }
+
+    for (unsigned length=0 ; length<400 ; ++length) {
+        QByteArray data    = randomBytes(length);
+        QString    encoded = QString::fromLatin1(data.toBase64());
+
+        QByteArray expected;
+        QByteArray measured;
+        QVERIFY(RestApiInV1::decodeBase64(encoded, expected, Base64Decoder::PORTABLE));
+        QVERIFY(RestApiInV1::decodeBase64(encoded, measured, Base64Decoder::AVX2));
+        QCOMPARE(measured, expected);
+        QCOMPARE(measured, data);
+
+        // An invalid character anywhere, inside or after the vector groups, must be caught.
+        if (!encoded.isEmpty()) {
+            QString invalid = encoded;
+            int     position = static_cast<int>(generator() % static_cast<unsigned>(encoded.size()));
+            invalid[position] = (length % 2) == 0 ? QChar('.') : QChar(0x0141);
+
+            bool portableSuccess = RestApiInV1::decodeBase64(invalid, expected, Base64Decoder::PORTABLE);
+            bool avx2Success     = RestApiInV1::decodeBase64(invalid, measured, Base64Decoder::AVX2);
+
+            QCOMPARE(avx2Success, portableSuccess);
+            QVERIFY(!avx2Success);
+        }
+    }
+}
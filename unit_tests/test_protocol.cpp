@@ -0,0 +1,652 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref TestProtocol class.
+***********************************************************************************************************************/
+
+#include <QObject>
+#include <QByteArray>
+#include <QHostAddress>
+#include <QtTest/QtTest>
+
+#include <zlib.h>
+
+#include <rest_api_in_v1_server.h>
+#include <rest_api_in_v1_handler.h>
+#include <rest_api_in_v1_session.h>
+
+#include "test_client.h"
+#include "test_protocol.h"
+
+/**
+ * The body returned by \ref HelloHandler.
+ */
+static const QByteArray helloBody("Hello world");
+
+/**
+ * Handler returning a short fixed body.
+ */
+class HelloHandler:public RestApiInV1::Handler {
+    public:
+        HelloHandler() {}
+
+        ~HelloHandler() override {}
+
+        void session(RestApiInV1::Session& session) override {
+            Headers headers;
+            headers.insert(contentTypeString, textPlainString);
+
+            session.sendResponse(StatusCode::OK, headers, helloBody);
+        }
+};
+
+/**
+ * Handler echoing the request body followed by the value of any "X-Trailer" field.  Only plain text bodies are
+ * accepted so the tests can have a request refused before its body is sent.
+ */
+class EchoHandler:public RestApiInV1::Handler {
+    public:
+        EchoHandler() {}
+
+        ~EchoHandler() override {}
+
+        StatusCode checkRequestHead(const RestApiInV1::Session& session) const override {
+            StatusCode result = StatusCode::OK;
+            if (!session.header(contentTypeString).startsWith(textPlainString)) {
+                result = StatusCode::PRECONDITION_FAILED;
+            }
+
+            return result;
+        }
+
+        void session(RestApiInV1::Session& session) override {
+            QByteArray body;
+            if (session.readBody(body)) {
+                QByteArray trailer = session.header("x-trailer");
+                if (!trailer.isEmpty()) {
+                    body.append('|');
+                    body.append(trailer);
+                }
+
+                Headers headers;
+                headers.insert(contentTypeString, textPlainString);
+
+                session.sendResponse(StatusCode::OK, headers, body);
+            }
+        }
+};
+
+/**
+ * Handler returning a body large and repetitive enough to be compressed.
+ */
+class TextHandler:public RestApiInV1::Handler {
+    public:
+        TextHandler() {}
+
+        ~TextHandler() override {}
+
+        static QByteArray textBody() {
+            QByteArray result;
+            for (unsigned i=0 ; i<64 ; ++i) {
+                result.append("The quick brown fox jumps over the lazy dog ");
+                result.append(QByteArray::number(i));
+                result.append('\n');
+            }
+
+            return result;
+        }
+
+        bool compressResponses() const override {
+            return true;
+        }
+
+        void session(RestApiInV1::Session& session) override {
+            Headers headers;
+            headers.insert(contentTypeString, textPlainString);
+
+            session.sendResponse(StatusCode::OK, headers, textBody());
+        }
+};
+
+/**
+ * Method that inflates a zlib or gzip body.
+ *
+ * \param[in] encoded    The encoded body.
+ *
+ * \param[in] windowBits The zlib window bits selecting the format.
+ *
+ * \return Returns the decoded body.  An empty array is returned on error.
+ */
+static QByteArray inflateBody(const QByteArray& encoded, int windowBits) {
+    QByteArray result;
+    z_stream   stream = {};
+
+    if (inflateInit2(&stream, windowBits) == Z_OK) {
+        char buffer[4096];
+        int  status = Z_OK;
+
+        stream.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(encoded.constData()));
+        stream.avail_in = static_cast<uInt>(encoded.size());
+
+        while (status == Z_OK) {
+            stream.next_out  = reinterpret_cast<Bytef*>(buffer);
+            stream.avail_out = sizeof(buffer);
+
+            status = inflate(&stream, Z_NO_FLUSH);
+            result.append(buffer, static_cast<int>(sizeof(buffer) - stream.avail_out));
+        }
+
+        if (status != Z_STREAM_END) {
+            result.clear();
+        }
+
+        inflateEnd(&stream);
+    }
+
+    return result;
+}
+
+
+TestProtocol::TestProtocol(
+        unsigned       numberIoThreads,
+        unsigned short port,
+        QObject*       parent
+    ):QObject(
+        parent
+    ),currentNumberIoThreads(
+        numberIoThreads
+    ),currentPort(
+        port
+    ),server(
+        nullptr
+    ),helloHandler(
+        nullptr
+    ),echoHandler(
+        nullptr
+    ),textHandler(
+        nullptr
+    ) {}
+
+
+TestProtocol::~TestProtocol() {}
+
+
+void TestProtocol::initTestCase() {
+#if (!defined(Q_OS_LINUX))
+    QSKIP("The tests block the calling thread so they need the listener threads only available on Linux.");
+#endif
+
+    helloHandler = new HelloHandler;
+    echoHandler  = new EchoHandler;
+    textHandler  = new TextHandler;
+
+    server = new RestApiInV1::Server(8);
+    server->setNumberListenerThreads(1);
+    server->setNumberIoThreads(currentNumberIoThreads);
+    server->setKeepAliveTimeout(30000);
+
+    server->registerHandler(helloHandler, RestApiInV1::Handler::Method::GET, "/hello");
+    server->registerHandler(helloHandler, RestApiInV1::Handler::Method::HEAD, "/hello");
+    server->registerHandler(echoHandler, RestApiInV1::Handler::Method::POST, "/echo");
+    server->registerHandler(textHandler, RestApiInV1::Handler::Method::GET, "/text");
+
+    QVERIFY(server->reconfigure(QHostAddress(QHostAddress::LocalHost), currentPort));
+}
+
+
+void TestProtocol::cleanupTestCase() {
+    delete server;
+    delete helloHandler;
+    delete echoHandler;
+    delete textHandler;
+
+    server       = nullptr;
+    helloHandler = nullptr;
+    echoHandler  = nullptr;
+    textHandler  = nullptr;
+}
+
+
+void TestProtocol::testKeepAlive() {
+    TestClient client;
+    QVERIFY(client.connectToServer(currentPort));
+
+    for (unsigned i=0 ; i<3 ; ++i) {
+        TestClient::Response response;
+        QVERIFY(client.send("GET /hello HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+        QVERIFY(client.readResponse(response));
+
+        QCOMPARE(response.statusCode, 200U);
+        QCOMPARE(response.headers.value("connection"), QByteArray("keep-alive"));
+        QCOMPARE(response.headers.value("content-length"), QByteArray::number(helloBody.size()));
+        QCOMPARE(response.body, helloBody);
+    }
+
+    // Pipelined requests are answered in order.
+    QVERIFY(
+        client.send(
+            "GET /hello HTTP/1.1\r\nHost: localhost\r\n\r\n"
+            "GET /missing HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        )
+    );
+
+    TestClient::Response first;
+    TestClient::Response second;
+    QVERIFY(client.readResponse(first));
+    QVERIFY(client.readResponse(second));
+
+    QCOMPARE(first.statusCode, 200U);
+    QCOMPARE(first.body, helloBody);
+    QCOMPARE(second.statusCode, 404U);
+    QCOMPARE(second.headers.value("connection"), QByteArray("keep-alive"));
+
+    QVERIFY(!client.closedByServer());
+}
+
+
+void TestProtocol::testHeadKeepAlive() {
+    TestClient           client;
+    TestClient::Response response;
+
+    QVERIFY(client.connectToServer(currentPort));
+
+    // Any body bytes sent after the head would be read as the start of the next response.
+    QVERIFY(client.send("HEAD /hello HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+    QVERIFY(client.readResponse(response, false));
+
+    QCOMPARE(response.statusCode, 200U);
+    QCOMPARE(response.headers.value("connection"), QByteArray("keep-alive"));
+    QCOMPARE(response.headers.value("content-length"), QByteArray::number(helloBody.size()));
+
+    QVERIFY(client.send("HEAD /missing HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+    QVERIFY(client.readResponse(response, false));
+
+    QCOMPARE(response.statusCode, 404U);
+    QCOMPARE(response.headers.value("connection"), QByteArray("keep-alive"));
+    QVERIFY(response.headers.value("content-length").toInt() > 0);
+
+    QVERIFY(client.send("GET /hello HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 200U);
+    QCOMPARE(response.body, helloBody);
+    QVERIFY(!client.closedByServer());
+}
+
+
+void TestProtocol::testConnectionClose() {
+    TestClient           client;
+    TestClient::Response response;
+
+    QVERIFY(client.connectToServer(currentPort));
+    QVERIFY(client.send("GET /hello HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n"));
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 200U);
+    QCOMPARE(response.headers.value("connection"), QByteArray("close"));
+    QCOMPARE(response.body, helloBody);
+    QVERIFY(client.closedByServer());
+
+    // The token is found anywhere in the list, in any case.
+    TestClient listClient;
+    QVERIFY(listClient.connectToServer(currentPort));
+    QVERIFY(listClient.send("GET /hello HTTP/1.1\r\nHost: localhost\r\nConnection: TE,\tClose \r\n\r\n"));
+    QVERIFY(listClient.readResponse(response));
+
+    QCOMPARE(response.statusCode, 200U);
+    QCOMPARE(response.headers.value("connection"), QByteArray("close"));
+    QVERIFY(listClient.closedByServer());
+}
+
+
+void TestProtocol::testHttp10() {
+    TestClient           client;
+    TestClient::Response response;
+
+    QVERIFY(client.connectToServer(currentPort));
+    QVERIFY(client.send("GET /hello HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n"));
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 200U);
+    QCOMPARE(response.headers.value("connection"), QByteArray("keep-alive"));
+    QCOMPARE(response.body, helloBody);
+
+    QVERIFY(client.send("GET /hello HTTP/1.0\r\n\r\n"));
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 200U);
+    QCOMPARE(response.headers.value("connection"), QByteArray("close"));
+    QCOMPARE(response.body, helloBody);
+    QVERIFY(client.closedByServer());
+}
+
+
+void TestProtocol::testChunkedRequest() {
+    TestClient           client;
+    TestClient::Response response;
+
+    QVERIFY(client.connectToServer(currentPort));
+    QVERIFY(
+        client.send(
+            "POST /echo HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "Content-Type: text/plain\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "\r\n"
+            "5;name=value\r\n"
+            "Hello\r\n"
+            "6\r\n"
+            " world\r\n"
+            "0\r\n"
+            "X-Trailer: done\r\n"
+            "\r\n"
+        )
+    );
+
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 200U);
+    QCOMPARE(response.body, QByteArray("Hello world|done"));
+    QCOMPARE(response.headers.value("connection"), QByteArray("keep-alive"));
+
+    // The chunk framing must leave the connection positioned at the next request.
+    QVERIFY(client.send("GET /hello HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 200U);
+    QCOMPARE(response.body, helloBody);
+
+    QVERIFY(
+        client.send(
+            "POST /echo HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "Content-Type: text/plain\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "\r\n"
+            "zz\r\n"
+        )
+    );
+
+    QVERIFY(client.readResponse(response));
+    QCOMPARE(response.statusCode, 400U);
+    QVERIFY(client.closedByServer());
+}
+
+
+void TestProtocol::testAmbiguousFraming() {
+    const char* requests[] = {
+        "POST /echo HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Content-Type: text/plain\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "Content-Length: 5\r\n"
+        "\r\n"
+        "0\r\n\r\n",
+
+        "POST /echo HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Content-Type: text/plain\r\n"
+        "Transfer-Encoding: chunked, gzip\r\n"
+        "\r\n"
+        "0\r\n\r\n",
+
+        "POST /echo HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Content-Type: text/plain\r\n"
+        "Transfer-Encoding: gzip\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "Transfer-Encoding: identity\r\n"
+        "\r\n"
+        "0\r\n\r\n",
+
+        "POST /echo HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Length: 5\r\n"
+        "Content-Length: 5\r\n"
+        "\r\n"
+        "Hello",
+
+        "POST /echo HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Length: 5\r\n"
+        "Content-Length: 6\r\n"
+        "\r\n"
+        "Hello!",
+
+        "POST /echo HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Length: 5, 5\r\n"
+        "\r\n"
+        "Hello"
+    };
+
+    for (const char* request : requests) {
+        TestClient           client;
+        TestClient::Response response;
+
+        QVERIFY(client.connectToServer(currentPort));
+        QVERIFY(client.send(request));
+        QVERIFY(client.readResponse(response));
+
+        QCOMPARE(response.statusCode, 400U);
+        QCOMPARE(response.headers.value("connection"), QByteArray("close"));
+        QVERIFY(client.closedByServer());
+    }
+
+    // Coding names are case insensitive and may be padded.
+    TestClient           client;
+    TestClient::Response response;
+
+    QVERIFY(client.connectToServer(currentPort));
+    QVERIFY(
+        client.send(
+            "POST /echo HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "Content-Type: text/plain\r\n"
+            "Transfer-Encoding:  Chunked \r\n"
+            "\r\n"
+            "5\r\nHello\r\n0\r\n\r\n"
+        )
+    );
+
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 200U);
+    QCOMPARE(response.body, QByteArray("Hello"));
+    QCOMPARE(response.headers.value("connection"), QByteArray("keep-alive"));
+}
+
+
+void TestProtocol::testContinue() {
+    TestClient           client;
+    TestClient::Response response;
+
+    QVERIFY(client.connectToServer(currentPort));
+    QVERIFY(
+        client.send(
+            "POST /echo HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Length: 11\r\n"
+            "Expect: 100-continue\r\n"
+            "\r\n"
+        )
+    );
+
+    QVERIFY(client.readResponse(response));
+    QCOMPARE(response.statusCode, 100U);
+
+    QVERIFY(client.send(helloBody));
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 200U);
+    QCOMPARE(response.body, helloBody);
+    QCOMPARE(response.headers.value("connection"), QByteArray("keep-alive"));
+}
+
+
+void TestProtocol::testContinueRejected() {
+    TestClient           client;
+    TestClient::Response response;
+
+    QVERIFY(client.connectToServer(currentPort));
+    QVERIFY(
+        client.send(
+            "POST /echo HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "Content-Type: application/json\r\n"
+            "Content-Length: 11\r\n"
+            "Expect: 100-continue\r\n"
+            "\r\n"
+        )
+    );
+
+    // The final status comes without the interim response and the body is never read.
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 412U);
+    QCOMPARE(response.headers.value("connection"), QByteArray("close"));
+    QVERIFY(client.closedByServer());
+}
+
+
+void TestProtocol::testCompression() {
+    QByteArray expected = TextHandler::textBody();
+
+    TestClient           client;
+    TestClient::Response response;
+    QVERIFY(client.connectToServer(currentPort));
+
+    QVERIFY(client.send("GET /text HTTP/1.1\r\nHost: localhost\r\nAccept-Encoding: gzip\r\n\r\n"));
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 200U);
+    QCOMPARE(response.headers.value("content-encoding"), QByteArray("gzip"));
+    QCOMPARE(response.headers.value("vary"), QByteArray("accept-encoding"));
+    QVERIFY(response.body.size() < expected.size());
+    QCOMPARE(inflateBody(response.body, MAX_WBITS + 16), expected);
+
+    QVERIFY(client.send("GET /text HTTP/1.1\r\nHost: localhost\r\nAccept-Encoding: gzip;q=0.5, deflate\r\n\r\n"));
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 200U);
+    QCOMPARE(response.headers.value("content-encoding"), QByteArray("deflate"));
+    QCOMPARE(inflateBody(response.body, MAX_WBITS), expected);
+
+    QVERIFY(client.send("GET /text HTTP/1.1\r\nHost: localhost\r\nAccept-Encoding: gzip;q=0, deflate;q=0\r\n\r\n"));
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 200U);
+    QVERIFY(!response.headers.contains("content-encoding"));
+    QCOMPARE(response.body, expected);
+
+    QVERIFY(client.send("GET /text HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 200U);
+    QVERIFY(!response.headers.contains("content-encoding"));
+    QCOMPARE(response.body, expected);
+
+    // Handlers that do not ask for compression are never compressed.
+    QVERIFY(client.send("GET /hello HTTP/1.1\r\nHost: localhost\r\nAccept-Encoding: gzip\r\n\r\n"));
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 200U);
+    QVERIFY(!response.headers.contains("content-encoding"));
+    QCOMPARE(response.body, helloBody);
+}
+
+
+void TestProtocol::testRanges() {
+    TestClient           client;
+    TestClient::Response response;
+    QVERIFY(client.connectToServer(currentPort));
+
+    // Ranges are advertised without the handler asking for them.
+    QVERIFY(client.send("GET /hello HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 200U);
+    QCOMPARE(response.headers.value("accept-ranges"), QByteArray("bytes"));
+    QCOMPARE(response.body, helloBody);
+
+    QVERIFY(client.send("GET /hello HTTP/1.1\r\nHost: localhost\r\nRange: bytes=0-4\r\n\r\n"));
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 206U);
+    QCOMPARE(response.headers.value("content-range"), QByteArray("bytes 0-4/11"));
+    QCOMPARE(response.headers.value("content-length"), QByteArray("5"));
+    QCOMPARE(response.body, QByteArray("Hello"));
+
+    QVERIFY(client.send("GET /hello HTTP/1.1\r\nHost: localhost\r\nRange: bytes=0-4,-5\r\n\r\n"));
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 206U);
+
+    QByteArray boundaryPrefix("multipart/byteranges; boundary=");
+    QByteArray contentType = response.headers.value("content-type");
+    QVERIFY(contentType.startsWith(boundaryPrefix));
+
+    QByteArray boundary = contentType.mid(boundaryPrefix.size());
+    QVERIFY(!boundary.isEmpty());
+
+    QByteArray expected = (
+          "\r\n--" + boundary + "\r\n"
+        + "content-type:text/plain\r\n"
+        + "content-range:bytes 0-4/11\r\n"
+        + "\r\n"
+        + "Hello"
+        + "\r\n--" + boundary + "\r\n"
+        + "content-type:text/plain\r\n"
+        + "content-range:bytes 6-10/11\r\n"
+        + "\r\n"
+        + "world"
+        + "\r\n--" + boundary + "--\r\n"
+    );
+    QCOMPARE(response.body, expected);
+
+    QVERIFY(client.send("GET /hello HTTP/1.1\r\nHost: localhost\r\nRange: bytes=20-30\r\n\r\n"));
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 416U);
+    QCOMPARE(response.headers.value("content-range"), QByteArray("bytes */11"));
+    QCOMPARE(response.headers.value("connection"), QByteArray("keep-alive"));
+
+    // Ranges are only honored for GET, though HEAD still advertises them.
+    QVERIFY(client.send("HEAD /hello HTTP/1.1\r\nHost: localhost\r\nRange: bytes=0-4\r\n\r\n"));
+    QVERIFY(client.readResponse(response, false));
+
+    QCOMPARE(response.statusCode, 200U);
+    QCOMPARE(response.headers.value("accept-ranges"), QByteArray("bytes"));
+    QCOMPARE(response.headers.value("content-length"), QByteArray::number(helloBody.size()));
+
+    // Compressed responses neither advertise nor honor ranges.
+    QVERIFY(client.send("GET /text HTTP/1.1\r\nHost: localhost\r\nAccept-Encoding: gzip\r\nRange: bytes=0-4\r\n\r\n"));
+    QVERIFY(client.readResponse(response));
+
+    QCOMPARE(response.statusCode, 200U);
+    QCOMPARE(response.headers.value("content-encoding"), QByteArray("gzip"));
+    QVERIFY(!response.headers.contains("accept-ranges"));
+    QCOMPARE(inflateBody(response.body, MAX_WBITS + 16), TextHandler::textBody());
+
+    QVERIFY(!client.closedByServer());
+}
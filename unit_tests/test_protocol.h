@@ -0,0 +1,102 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This header defines the \ref TestProtocol class.
+***********************************************************************************************************************/
+
+#ifndef TEST_PROTOCOL_H
+#define TEST_PROTOCOL_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+namespace RestApiInV1 {
+    class Server;
+    class Handler;
+}
+
+/**
+ * Class that exercises the HTTP/1.1 protocol handling of a running server over raw sockets.
+ */
+class TestProtocol:public QObject {
+    Q_OBJECT
+
+    public:
+        /**
+         * Constructor
+         *
+         * \param[in] numberIoThreads The number of I/O threads to give the server.  Zero leaves idle keep-alive
+         *                            connections with the workers.
+         *
+         * \param[in] port            The local port the server listens on.
+         *
+         * \param[in] parent          The parent object.
+         */
+        TestProtocol(unsigned numberIoThreads, unsigned short port, QObject* parent = nullptr);
+
+        ~TestProtocol() override;
+
+    private slots:
+        void initTestCase();
+        void cleanupTestCase();
+
+        void testKeepAlive();
+        void testHeadKeepAlive();
+        void testConnectionClose();
+        void testHttp10();
+        void testChunkedRequest();
+        void testAmbiguousFraming();
+        void testContinue();
+        void testContinueRejected();
+        void testCompression();
+        void testRanges();
+
+    private:
+        /**
+         * The number of I/O threads to give the server.
+         */
+        unsigned currentNumberIoThreads;
+
+        /**
+         * The port the server listens on.
+         */
+        unsigned short currentPort;
+
+        /**
+         * The server under test.
+         */
+        RestApiInV1::Server* server;
+
+        /**
+         * Handler returning a short fixed body.
+         */
+        RestApiInV1::Handler* helloHandler;
+
+        /**
+         * Handler echoing the request body.
+         */
+        RestApiInV1::Handler* echoHandler;
+
+        /**
+         * Handler returning a compressible body.
+         */
+        RestApiInV1::Handler* textHandler;
+};
+
+#endif
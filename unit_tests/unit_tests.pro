@@ -0,0 +1,77 @@
+##-*-makefile-*-########################################################################################################
+# Copyright 2022 Inesonic, LLC.
+#
+# MIT License:
+#   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+#   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+#   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+#   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+#   
+#   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+#   Software.
+#   
+#   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+#   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+#   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+#   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+########################################################################################################################
+
+########################################################################################################################
+# Basic build characteristics
+#
+
+TEMPLATE = app
+
+QT += core network testlib
+QT -= gui
+
+CONFIG += console c++14
+CONFIG -= app_bundle
+
+########################################################################################################################
+# Headers and sources:
+#
+
+INCLUDEPATH += ../include ../source
+
+HEADERS = test_client.h \
+          test_crypto.h \
+          test_protocol.h \
+
+SOURCES = main.cpp \
+          test_client.cpp \
+          test_crypto.cpp \
+          test_protocol.cpp \
+
+########################################################################################################################
+# Libraries
+#
+
+CONFIG(debug, debug|release) {
+    unix:LIBS += -L../build/debug
+    win32:LIBS += -L../build/Debug
+} else {
+    unix:LIBS += -L../build/release
+    win32:LIBS += -L../build/Release
+}
+
+LIBS += -linerest_api_in_v1 -lz
+
+########################################################################################################################
+# Locate build intermediate and output products
+#
+
+TARGET = unit_tests
+
+CONFIG(debug, debug|release) {
+    unix:DESTDIR = build/debug
+    win32:DESTDIR = build/Debug
+} else {
+    unix:DESTDIR = build/release
+    win32:DESTDIR = build/Release
+}
+
+OBJECTS_DIR = $${DESTDIR}/objects
+MOC_DIR = $${DESTDIR}/moc
+RCC_DIR = $${DESTDIR}/rcc
+UI_DIR = $${DESTDIR}/ui